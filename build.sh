@@ -3,5 +3,32 @@
 mkdir -p build
 
 #gcc -Wall -Wextra -o pdp8 ../src/pdp8.c
-g++ -o ./build/pdp8 ./src/main.cpp ./src/pdp8.c -lX11 -lGL -lpthread -lpng -lstdc++fs -std=c++17
+g++ -o ./build/pdp8 ./src/main.cpp ./src/emulator.c ./src/lamps.c ./src/breakpoint.c ./src/watchpoint.c ./src/history.c ./src/replay.c ./src/pdp8.c ./src/loader.c ./src/symbols.c ./src/assembler.c ./src/instruction.c ./src/disassembler.c ./src/trace.c ./src/tracefile.c ./src/profile.c ./src/stats.c -lX11 -lGL -lpthread -lpng -lz -lstdc++fs -std=c++17
 
+g++ -o ./build/pdp8-tracediff ./src/tracediff_main.c ./src/tracediff.c ./src/pdp8.c ./src/loader.c ./src/symbols.c ./src/assembler.c ./src/instruction.c ./src/disassembler.c ./src/trace.c ./src/tracefile.c ./src/profile.c ./src/stats.c -lpthread -lz
+g++ -o ./build/pdp8-profile ./src/profile_main.c ./src/profile.c ./src/stats.c ./src/pdp8.c ./src/loader.c ./src/symbols.c ./src/assembler.c ./src/instruction.c ./src/disassembler.c -lpthread
+g++ -O2 -o ./build/pdp8-bench ./src/bench.c ./src/perfcount.c ./src/lamps.c ./src/engine.c ./src/pdp8.c ./src/loader.c ./src/symbols.c ./src/assembler.c ./src/instruction.c ./src/disassembler.c ./src/profile.c ./src/stats.c ./src/trace.c -lpthread -lm
+g++ -O2 -o ./build/pdp8-run ./src/run_main.c ./src/breakpoint.c ./src/watchpoint.c ./src/history.c ./src/replay.c ./src/pdp8.c ./src/loader.c ./src/symbols.c ./src/assembler.c ./src/instruction.c ./src/disassembler.c -lpthread
+g++ -O2 -o ./build/pdp8-lockstep ./src/lockstep_main.c ./src/lockstep.c ./src/engine.c ./src/tracediff.c ./src/pdp8.c ./src/loader.c ./src/symbols.c ./src/assembler.c ./src/instruction.c ./src/disassembler.c ./src/trace.c ./src/tracefile.c -lpthread -lz
+g++ -O2 -o ./build/pdp8-gdb ./src/gdb_main.c ./src/gdbstub.c ./src/breakpoint.c ./src/watchpoint.c ./src/pdp8.c ./src/loader.c ./src/symbols.c ./src/assembler.c ./src/instruction.c ./src/disassembler.c -lpthread
+
+g++ -I./src -o ./build/test-pdp8 ./test/pdp8_test.c ./src/pdp8.c ./src/instruction.c
+g++ -I./src -o ./build/test-loader ./test/loader_test.c ./src/pdp8.c ./src/loader.c ./src/symbols.c ./src/assembler.c ./src/instruction.c
+g++ -I./src -o ./build/test-assembler ./test/assembler_test.c ./src/pdp8.c ./src/loader.c ./src/symbols.c ./src/assembler.c ./src/instruction.c
+g++ -I./src -o ./build/test-disassembler ./test/disassembler_test.c ./src/instruction.c ./src/disassembler.c -lpthread
+g++ -I./src -o ./build/test-trace ./test/trace_test.c ./src/pdp8.c ./src/loader.c ./src/symbols.c ./src/assembler.c ./src/instruction.c ./src/trace.c -lpthread
+g++ -I./src -o ./build/test-tracefile ./test/tracefile_test.c ./src/pdp8.c ./src/loader.c ./src/symbols.c ./src/assembler.c ./src/instruction.c ./src/trace.c ./src/tracefile.c -lpthread -lz
+g++ -I./src -o ./build/test-tracediff ./test/tracediff_test.c ./src/tracediff.c ./src/pdp8.c ./src/loader.c ./src/symbols.c ./src/assembler.c ./src/instruction.c ./src/disassembler.c ./src/trace.c ./src/tracefile.c -lpthread -lz
+g++ -I./src -o ./build/test-profile ./test/profile_test.c ./src/profile.c ./src/pdp8.c ./src/loader.c ./src/symbols.c ./src/assembler.c ./src/instruction.c ./src/disassembler.c -lpthread
+g++ -I./src -o ./build/test-stats ./test/stats_test.c ./src/stats.c ./src/pdp8.c ./src/loader.c ./src/symbols.c ./src/assembler.c ./src/instruction.c ./src/disassembler.c -lpthread
+g++ -I./src -o ./build/test-corpus ./test/corpus_test.c ./src/pdp8.c ./src/loader.c ./src/symbols.c ./src/assembler.c ./src/instruction.c
+g++ -I./src -o ./build/test-perfcount ./test/perfcount_test.c ./src/perfcount.c ./src/pdp8.c ./src/instruction.c
+g++ -I./src -o ./build/test-run ./test/run_test.c
+g++ -I./src -o ./build/test-lockstep ./test/lockstep_test.c ./src/lockstep.c ./src/engine.c ./src/tracediff.c ./src/pdp8.c ./src/loader.c ./src/symbols.c ./src/assembler.c ./src/instruction.c ./src/disassembler.c ./src/trace.c ./src/tracefile.c -lpthread -lz
+g++ -I./src -o ./build/test-replay ./test/replay_test.c ./src/replay.c ./src/pdp8.c ./src/loader.c ./src/symbols.c ./src/assembler.c ./src/instruction.c -lpthread
+g++ -I./src -o ./build/test-history ./test/history_test.c ./src/history.c ./src/replay.c ./src/pdp8.c ./src/loader.c ./src/symbols.c ./src/assembler.c ./src/instruction.c -lpthread
+g++ -I./src -o ./build/test-breakpoint ./test/breakpoint_test.c ./src/breakpoint.c ./src/pdp8.c ./src/instruction.c
+g++ -I./src -o ./build/test-watchpoint ./test/watchpoint_test.c ./src/watchpoint.c ./src/breakpoint.c ./src/pdp8.c ./src/instruction.c
+g++ -I./src -o ./build/test-gdbstub ./test/gdbstub_test.c ./src/gdbstub.c ./src/breakpoint.c ./src/watchpoint.c ./src/pdp8.c ./src/instruction.c -lpthread
+g++ -I./src -o ./build/test-emulator ./test/emulator_test.c ./src/emulator.c ./src/lamps.c ./src/history.c ./src/replay.c ./src/breakpoint.c ./src/trace.c ./src/pdp8.c ./src/loader.c ./src/symbols.c ./src/assembler.c ./src/instruction.c -lpthread
+g++ -I./src -o ./build/test-lamps ./test/lamps_test.c ./src/lamps.c ./src/pdp8.c ./src/loader.c ./src/symbols.c ./src/assembler.c ./src/instruction.c
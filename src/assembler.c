@@ -0,0 +1,540 @@
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "assembler.h"
+#include "instruction.h"
+
+#define DEFAULT_ORIGIN 00200
+#define PAGE_SIZE      00200
+#define PAGE_MASK      07600
+#define OFFSET_MASK    00177
+#define PAGE_COUNT     (PDP8_MEMORY_SIZE / PAGE_SIZE)
+
+#define MRI_INDIRECT   INDIRECT_BIT
+#define MRI_PAGE       PAGE_BIT
+
+enum PSEUDO_OP {
+  PSEUDO_PAGE,
+  PSEUDO_DECIMAL,
+  PSEUDO_OCTAL,
+  PSEUDO_ZBLOCK,
+  PSEUDO_TEXT,
+  PSEUDO_FIELD,
+  PSEUDO_EJECT,
+  PSEUDO_XLIST,
+};
+
+static const struct PDP8_Mnemonic pseudo_ops[] = {
+  { "PAGE",    PSEUDO_PAGE,    PDP8_SYMBOL_PSEUDO },
+  { "DECIMAL", PSEUDO_DECIMAL, PDP8_SYMBOL_PSEUDO },
+  { "OCTAL",   PSEUDO_OCTAL,   PDP8_SYMBOL_PSEUDO },
+  { "ZBLOCK",  PSEUDO_ZBLOCK,  PDP8_SYMBOL_PSEUDO },
+  { "TEXT",    PSEUDO_TEXT,    PDP8_SYMBOL_PSEUDO },
+  { "FIELD",   PSEUDO_FIELD,   PDP8_SYMBOL_PSEUDO },
+  { "EJECT",   PSEUDO_EJECT,   PDP8_SYMBOL_PSEUDO },
+  { "XLIST",   PSEUDO_XLIST,   PDP8_SYMBOL_PSEUDO },
+};
+
+struct assembler {
+  const char *p;                       // cursor
+  const char *end;                     // end of source
+  uint line;
+  int pass;                            // 1 or 2
+
+  uint location;                       // .
+  bool decimal;                        // radix for numbers
+  bool ended;                          // $ seen
+  bool undefined;                      // last expression used an undefined symbol
+
+  bool failed;
+  int status;
+  struct PDP8_AssemblerError *error;
+
+  struct PDP8_Symbols *symbols;
+  struct PDP8_Image *image;
+
+  uint literal_count[PAGE_COUNT];
+  uint literals[PAGE_COUNT][PAGE_SIZE]; // literals[page][i] lives at page offset 0177 - i
+  uint8_t used[PDP8_MEMORY_SIZE];       // locations holding code
+};
+
+static uint instruction(struct assembler *as);
+
+static void fail(struct assembler *as, const char *format, ...) {
+  if (as->failed) return;
+  as->failed = true;
+  as->status = PDP8_ERROR_ASSEMBLY;
+
+  if (as->error) {
+    as->error->line = as->line;
+    va_list args;
+    va_start(args, format);
+    vsnprintf(as->error->message, sizeof(as->error->message), format, args);
+    va_end(args);
+  }
+}
+
+static void fail_status(struct assembler *as, int status) {
+  fail(as, "%s", PDP8_StatusString(status));
+  as->status = status;
+}
+
+static bool is_alpha(char c) { return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z'); }
+static bool is_digit(char c) { return c >= '0' && c <= '9'; }
+static bool is_alnum(char c) { return is_alpha(c) || is_digit(c); }
+
+// Current character, 0 at the end of the line.
+static char peek(struct assembler *as) {
+  return (as->p < as->end && *as->p != '\n') ? *as->p : 0;
+}
+
+static void skip_blanks(struct assembler *as) {
+  for (char c = peek(as); c == ' ' || c == '\t' || c == '\r' || c == '\f'; c = peek(as)) {
+    as->p++;
+  }
+}
+
+static bool at_end_of_statement(struct assembler *as) {
+  char c = peek(as);
+  return !c || c == '/' || c == ';';
+}
+
+static uint read_symbol(struct assembler *as, const char **name) {
+  *name = as->p;
+  while (is_alnum(peek(as))) as->p++;
+  return as->p - *name;
+}
+
+static void emit(struct assembler *as, uint word) {
+  if (as->pass == 2) {
+    int status = PDP8_ImageAppend(as->image, as->location, word);
+    if (status != PDP8_OK) fail_status(as, status);
+    as->used[as->location] = 1;
+  }
+  as->location = (as->location + 1) & PDP8_WORD_MASK;
+}
+
+// Returns the address of a literal in the current page or page zero pool.
+static uint literal(struct assembler *as, uint value, bool page_zero) {
+  uint page = page_zero ? 0 : as->location / PAGE_SIZE;
+  if (as->pass == 1) {
+    return page * PAGE_SIZE + OFFSET_MASK;
+  }
+
+  uint *pool = as->literals[page];
+  uint count = as->literal_count[page];
+  for (uint i = 0; i < count; ++i) {
+    if (pool[i] == value) return page * PAGE_SIZE + OFFSET_MASK - i;
+  }
+
+  if (count == PAGE_SIZE) {
+    fail(as, "literal pool overflow on page %o", page);
+    return 0;
+  }
+  pool[count] = value;
+  as->literal_count[page]++;
+  return page * PAGE_SIZE + OFFSET_MASK - count;
+}
+
+static uint term(struct assembler *as) {
+  skip_blanks(as);
+  char c = peek(as);
+
+  if (is_digit(c)) {
+    uint radix = as->decimal ? 10 : 8;
+    uint value = 0;
+    while (is_digit(peek(as))) {
+      uint digit = *as->p++ - '0';
+      if (digit >= radix) fail(as, "digit %u in octal number", digit);
+      value = value * radix + digit;
+    }
+    return value & PDP8_WORD_MASK;
+  }
+
+  if (is_alpha(c)) {
+    const char *name;
+    uint length = read_symbol(as, &name);
+    struct PDP8_Symbol *symbol = PDP8_SymbolsLookup(as->symbols, name, length);
+    if (!symbol) {
+      if (as->pass == 2) fail(as, "undefined symbol %.*s", (int)length, name);
+      as->undefined = true;
+      return 0;
+    }
+    if (symbol->type == PDP8_SYMBOL_PSEUDO) {
+      fail(as, "misplaced pseudo-op %.*s", (int)length, name);
+      return 0;
+    }
+    return symbol->value;
+  }
+
+  as->p++;
+  switch (c) {
+    case '.': {
+      return as->location;
+    }
+    case '"': {
+      char ch = peek(as);
+      if (!ch) break;
+      as->p++;
+      return (ch | 0200) & 0377;
+    }
+    case '(':
+    case '[': {
+      uint value = instruction(as);
+      skip_blanks(as);
+      if (peek(as) == (c == '(' ? ')' : ']')) as->p++;
+      return literal(as, value, c == '[');
+    }
+    case '-': {
+      return -term(as) & PDP8_WORD_MASK;
+    }
+    case '+': {
+      return term(as);
+    }
+  }
+
+  as->p--;
+  fail(as, c ? "unexpected '%c'" : "missing operand", c);
+  return 0;
+}
+
+static bool starts_term(char c) {
+  return is_alnum(c) || c == '.' || c == '"' || c == '(' || c == '[';
+}
+
+// Evaluated strictly left to right; a blank between terms means inclusive or.
+static uint expression(struct assembler *as) {
+  uint value = term(as);
+  while (!as->failed) {
+    skip_blanks(as);
+    char c = peek(as);
+    if (c == '+' || c == '-' || c == '!' || c == '&') {
+      as->p++;
+      uint operand = term(as);
+      switch (c) {
+        case '+': value += operand; break;
+        case '-': value -= operand; break;
+        case '!': value |= operand; break;
+        case '&': value &= operand; break;
+      }
+    } else if (starts_term(c)) {
+      value |= term(as);
+    } else {
+      break;
+    }
+  }
+  return value & PDP8_WORD_MASK;
+}
+
+static bool is_modifier(const char *name, uint length, char modifier) {
+  return length == 1 && (name[0] | 040) == (modifier | 040);
+}
+
+static uint memory_reference(struct assembler *as, uint word) {
+  for (;;) {
+    skip_blanks(as);
+    const char *save = as->p;
+    const char *name;
+    uint length = read_symbol(as, &name);
+    if (is_modifier(name, length, 'I')) {
+      word |= MRI_INDIRECT;
+    } else if (!is_modifier(name, length, 'Z')) {
+      as->p = save;
+      break;
+    }
+  }
+
+  if (at_end_of_statement(as)) {
+    fail(as, "missing address");
+    return word;
+  }
+  uint address = expression(as);
+  if (as->pass == 1) {
+    return word;
+  }
+
+  if ((address & PAGE_MASK) == 0) {
+    return word | (address & OFFSET_MASK);
+  }
+  if ((address & PAGE_MASK) == (as->location & PAGE_MASK)) {
+    return word | MRI_PAGE | (address & OFFSET_MASK);
+  }
+  if (word & MRI_INDIRECT) {
+    fail(as, "indirect reference to %04o is off page", address);
+    return word;
+  }
+
+  // off page: indirect through a link in the current page literal pool
+  uint link = literal(as, address, false);
+  return word | MRI_INDIRECT | MRI_PAGE | (link & OFFSET_MASK);
+}
+
+static uint instruction(struct assembler *as) {
+  skip_blanks(as);
+  if (is_alpha(peek(as))) {
+    const char *save = as->p;
+    const char *name;
+    uint length = read_symbol(as, &name);
+    struct PDP8_Symbol *symbol = PDP8_SymbolsLookup(as->symbols, name, length);
+    if (symbol && symbol->type == PDP8_SYMBOL_MRI) {
+      return memory_reference(as, symbol->value);
+    }
+    as->p = save;
+  }
+  return expression(as);
+}
+
+static void define(struct assembler *as, const char *name, uint length, uint value, uint type) {
+  struct PDP8_Symbol *symbol = PDP8_SymbolsLookup(as->symbols, name, length);
+  if (symbol) {
+    if (symbol->type == PDP8_SYMBOL_PSEUDO || (type == PDP8_SYMBOL_LABEL && symbol->type != PDP8_SYMBOL_LABEL)) {
+      fail(as, "cannot redefine %.*s", (int)length, name);
+      return;
+    }
+    if (type == PDP8_SYMBOL_LABEL && symbol->value != value) {
+      fail(as, as->pass == 1 ? "duplicate label %.*s" : "phase error at %.*s", (int)length, name);
+      return;
+    }
+  }
+
+  int status = PDP8_SymbolsDefine(as->symbols, name, length, value, type);
+  if (status != PDP8_OK) fail_status(as, status);
+}
+
+static void text(struct assembler *as) {
+  skip_blanks(as);
+  char delimiter = peek(as);
+  if (!delimiter) {
+    fail(as, "missing TEXT delimiter");
+    return;
+  }
+  as->p++;
+
+  uint count = 0;
+  uint word = 0;
+  for (char c = peek(as); c != delimiter; c = peek(as)) {
+    if (!c) {
+      fail(as, "unterminated TEXT");
+      return;
+    }
+    as->p++;
+    word = (word << 6) | (c & 077);
+    if (++count % 2 == 0) {
+      emit(as, word);
+      word = 0;
+    }
+  }
+  as->p++;
+
+  // always terminated by a zero character
+  emit(as, (count % 2) ? word << 6 : 0);
+}
+
+static void pseudo_op(struct assembler *as, uint op) {
+  switch (op) {
+    case PSEUDO_PAGE: {
+      if (at_end_of_statement(as)) {
+        as->location = (as->location + OFFSET_MASK) & PAGE_MASK;
+      } else {
+        as->undefined = false;
+        uint page = expression(as);
+        if (as->undefined) fail(as, "undefined page number");
+        as->location = (page * PAGE_SIZE) & PDP8_WORD_MASK;
+      }
+    } break;
+    case PSEUDO_DECIMAL: {
+      as->decimal = true;
+    } break;
+    case PSEUDO_OCTAL: {
+      as->decimal = false;
+    } break;
+    case PSEUDO_ZBLOCK: {
+      as->undefined = false;
+      uint count = expression(as);
+      if (as->undefined) fail(as, "undefined ZBLOCK size");
+      for (uint i = 0; i < count && !as->failed; ++i) {
+        emit(as, 0);
+      }
+    } break;
+    case PSEUDO_TEXT: {
+      text(as);
+    } break;
+    case PSEUDO_FIELD: {
+      if (expression(as) != 0) fail(as, "only field 0 is supported");
+    } break;
+    case PSEUDO_EJECT:
+    case PSEUDO_XLIST: {
+      while (peek(as)) as->p++;
+    } break;
+  }
+}
+
+static void statements(struct assembler *as) {
+  while (!as->failed) {
+    skip_blanks(as);
+    char c = peek(as);
+    if (!c || c == '/') return;
+
+    if (c == ';') {
+      as->p++;
+      continue;
+    }
+
+    if (c == '*') {
+      as->p++;
+      as->undefined = false;
+      uint origin = expression(as);
+      if (as->undefined) fail(as, "undefined origin");
+      as->location = origin;
+      continue;
+    }
+
+    if (c == '$') {
+      as->p++;
+      skip_blanks(as);
+      if (!at_end_of_statement(as)) {
+        uint start = expression(as);
+        if (as->pass == 2) as->image->start = start;
+      }
+      as->ended = true;
+      return;
+    }
+
+    if (is_alpha(c)) {
+      const char *save = as->p;
+      const char *name;
+      uint length = read_symbol(as, &name);
+      skip_blanks(as);
+
+      if (peek(as) == ',') {
+        as->p++;
+        define(as, name, length, as->location, PDP8_SYMBOL_LABEL);
+        continue;
+      }
+      if (peek(as) == '=') {
+        as->p++;
+        define(as, name, length, expression(as), PDP8_SYMBOL_EQUATE);
+        continue;
+      }
+
+      struct PDP8_Symbol *symbol = PDP8_SymbolsLookup(as->symbols, name, length);
+      if (symbol && symbol->type == PDP8_SYMBOL_PSEUDO) {
+        pseudo_op(as, symbol->value);
+        continue;
+      }
+      as->p = save;
+    }
+
+    emit(as, instruction(as));
+
+    skip_blanks(as);
+    if (!at_end_of_statement(as)) {
+      fail(as, "unexpected '%c'", peek(as));
+    }
+  }
+}
+
+static void assemble_pass(struct assembler *as, const char *source, size_t length, int pass) {
+  as->p = source;
+  as->end = source + length;
+  as->line = 1;
+  as->pass = pass;
+  as->location = DEFAULT_ORIGIN;
+  as->decimal = false;
+  as->ended = false;
+
+  while (as->p < as->end && !as->ended && !as->failed) {
+    statements(as);
+    while (as->p < as->end && *as->p != '\n') as->p++;
+    if (as->p < as->end) {
+      as->p++;
+      as->line++;
+    }
+  }
+}
+
+static void emit_literals(struct assembler *as) {
+  for (uint page = 0; page < PAGE_COUNT && !as->failed; ++page) {
+    for (uint i = as->literal_count[page]; i-- > 0;) {
+      as->location = page * PAGE_SIZE + OFFSET_MASK - i;
+      if (as->used[as->location]) {
+        fail(as, "literals overlap code on page %o", page);
+        return;
+      }
+      emit(as, as->literals[page][i]);
+    }
+  }
+}
+
+int PDP8_SymbolsDefinePermanent(struct PDP8_Symbols *symbols) {
+  for (uint i = 0; i < PDP8_MnemonicCount; ++i) {
+    const struct PDP8_Mnemonic *symbol = &PDP8_Mnemonics[i];
+    int status = PDP8_SymbolsDefine(symbols, symbol->name, strlen(symbol->name), symbol->value, symbol->type);
+    if (status != PDP8_OK) return status;
+  }
+
+  uint count = sizeof(pseudo_ops) / sizeof(pseudo_ops[0]);
+  for (uint i = 0; i < count; ++i) {
+    const struct PDP8_Mnemonic *symbol = &pseudo_ops[i];
+    int status = PDP8_SymbolsDefine(symbols, symbol->name, strlen(symbol->name), symbol->value, symbol->type);
+    if (status != PDP8_OK) return status;
+  }
+  return PDP8_OK;
+}
+
+int PDP8_Assemble(struct PDP8_Image *image, struct PDP8_Symbols *symbols,
+                  const char *source, size_t length, struct PDP8_AssemblerError *error) {
+  struct PDP8_Symbols local_symbols;
+  if (!symbols) symbols = &local_symbols;
+
+  PDP8_ImageInit(image);
+  PDP8_SymbolsInit(symbols);
+
+  struct assembler *as = (struct assembler *)calloc(1, sizeof(struct assembler));
+  int status = as ? PDP8_SymbolsDefinePermanent(symbols) : PDP8_ERROR_MEMORY;
+
+  if (status == PDP8_OK) {
+    as->status = PDP8_OK;
+    as->error = error;
+    as->symbols = symbols;
+    as->image = image;
+
+    assemble_pass(as, source, length, 1);
+    if (!as->failed) assemble_pass(as, source, length, 2);
+    if (!as->failed) emit_literals(as);
+
+    status = as->status;
+  }
+
+  if (status != PDP8_OK) {
+    PDP8_ImageFree(image);
+  }
+  if (symbols == &local_symbols) {
+    PDP8_SymbolsFree(symbols);
+  }
+  free(as);
+
+  return status;
+}
+
+int PDP8_AssembleFile(struct PDP8_Image *image, struct PDP8_Symbols *symbols,
+                      const char *file_name, struct PDP8_AssemblerError *error) {
+  unsigned char *source;
+  size_t length;
+
+  int status = PDP8_ReadFile(file_name, &source, &length);
+  if (status != PDP8_OK) {
+    PDP8_ImageInit(image);
+    if (symbols) PDP8_SymbolsInit(symbols);
+    return status;
+  }
+
+  status = PDP8_Assemble(image, symbols, (const char *)source, length, error);
+  free(source);
+
+  return status;
+}
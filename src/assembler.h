@@ -0,0 +1,38 @@
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+#ifndef PDP8_ASSEMBLER_H
+#define PDP8_ASSEMBLER_H
+
+#include <stddef.h>
+
+#include "pdp8.h"
+#include "loader.h"
+#include "symbols.h"
+
+  struct PDP8_AssemblerError {
+    uint line;                         //  1-based source line
+    char message[80];
+  };
+
+  // Two pass PAL-III/PAL8 subset assembler. Supports origins (*nnnn), labels,
+  // equates, `.`, `I`/`Z` modifiers, combined OPR/IOT microinstructions,
+  // current page (`(`) and page zero (`[`) literals, automatic links for
+  // off-page references, `$start` and the PAGE, DECIMAL, OCTAL, ZBLOCK,
+  // TEXT, FIELD 0, EJECT and XLIST pseudo-ops.
+  //
+  // symbols and error may be NULL. When given, symbols receives the
+  // permanent and user symbols and must be freed with PDP8_SymbolsFree.
+  extern int PDP8_Assemble(struct PDP8_Image *image, struct PDP8_Symbols *symbols,
+                           const char *source, size_t length, struct PDP8_AssemblerError *error);
+  extern int PDP8_AssembleFile(struct PDP8_Image *image, struct PDP8_Symbols *symbols,
+                               const char *file_name, struct PDP8_AssemblerError *error);
+
+  extern int PDP8_SymbolsDefinePermanent(struct PDP8_Symbols *symbols);
+
+#endif //PDP8_ASSEMBLER_H
+
+#if defined (__cplusplus)
+}
+#endif
@@ -0,0 +1,311 @@
+#include <errno.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "pdp8.h"
+#include "loader.h"
+#include "perfcount.h"
+#include "profile.h"
+#include "stats.h"
+#include "lamps.h"
+#include "trace.h"
+#include "engine.h"
+#include "corpus.h"
+
+#define DEFAULT_INSTRUCTIONS 20000000
+#define DEFAULT_WARMUP       1
+#define DEFAULT_TRIALS       5
+#define MAX_TRIALS           1000
+
+// PDP-8 core memory cycle time
+#define CYCLE_NS 1500.0
+
+struct bench {
+  struct PDP8 pdp8;
+  const struct PDP8_Image *image;
+  struct PDP8_Profile profile;
+  struct PDP8_Stats stats;
+  struct PDP8_Lamps lamps;
+  struct PDP8_Trace trace;
+  struct PDP8_PerfCounters perf;
+  bool counting;                       //  any hardware counter available
+};
+
+// Every registered engine is measured as is; the reference is also
+// measured with instrumentation attached to show what leaving it on costs.
+struct engine {
+  const char *name;
+  const struct PDP8_Engine *core;
+  int  (*open)(struct bench *bench);
+  void (*attach)(struct bench *bench);
+  int  (*run)(struct bench *bench, const struct engine *engine, uint64_t budget, uint64_t *executed);
+  int  (*close)(struct bench *bench);
+};
+
+static int nothing(struct bench *bench) {
+  (void)bench;
+  return PDP8_OK;
+}
+
+static void attach_nothing(struct bench *bench) {
+  (void)bench;
+}
+
+static int run_core(struct bench *bench, const struct engine *engine, uint64_t budget, uint64_t *executed) {
+  return engine->core->run(&bench->pdp8, budget, executed);
+}
+
+static void attach_profile(struct bench *bench) {
+  PDP8_ProfileAttach(&bench->pdp8, &bench->profile);
+}
+
+static void attach_stats(struct bench *bench) {
+  PDP8_StatsAttach(&bench->pdp8, &bench->stats);
+}
+
+static void attach_lamps(struct bench *bench) {
+  PDP8_LampsAttach(&bench->pdp8, &bench->lamps);
+}
+
+static int open_trace(struct bench *bench) {
+  return PDP8_TraceOpenFile(&bench->trace, "/dev/null");
+}
+
+static int run_trace(struct bench *bench, const struct engine *engine, uint64_t budget, uint64_t *executed) {
+  (void)engine;
+  return PDP8_TraceRun(&bench->trace, &bench->pdp8, budget, executed);
+}
+
+static int close_trace(struct bench *bench) {
+  return PDP8_TraceClose(&bench->trace);
+}
+
+static const struct engine instrumented[] = {
+  { "profile", NULL, nothing, attach_profile, run_core,  nothing     },
+  { "stats",   NULL, nothing, attach_stats,   run_core,  nothing     },
+  { "lamps",   NULL, nothing, attach_lamps,   run_core,  nothing     },
+  { "trace",   NULL, open_trace, attach_nothing, run_trace, close_trace },
+};
+
+#define INSTRUMENTED_COUNT (sizeof(instrumented) / sizeof(instrumented[0]))
+#define MAX_ENGINES        16
+
+static struct engine engines[MAX_ENGINES];
+static uint engine_count;
+
+static void register_engines(void) {
+  const struct PDP8_Engine *reference = PDP8_FindEngine("reference");
+  for (uint i = 0; i < PDP8_EngineCount && engine_count < MAX_ENGINES; ++i) {
+    if (PDP8_Engines[i].faulty) continue;
+    struct engine engine = { PDP8_Engines[i].name, &PDP8_Engines[i], nothing, attach_nothing, run_core, nothing };
+    engines[engine_count++] = engine;
+  }
+  for (uint i = 0; i < INSTRUMENTED_COUNT && engine_count < MAX_ENGINES; ++i) {
+    engines[engine_count] = instrumented[i];
+    engines[engine_count++].core = reference;
+  }
+}
+
+struct trial {
+  double seconds;
+  uint64_t instructions;
+  uint64_t cycles;
+};
+
+static double now(void) {
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+static void reload(struct bench *bench, const struct engine *engine) {
+  PDP8_Reset(&bench->pdp8);
+  PDP8_MemoryReset(&bench->pdp8);
+  PDP8_LoadImage(&bench->pdp8, bench->image);
+  PDP8_StartImage(&bench->pdp8, bench->image);
+  engine->attach(bench);
+}
+
+// Runs exactly instructions instructions, restarting the workload each
+// time it halts; the restarts are timed too.
+static int run_trial(struct bench *bench, const struct engine *engine, uint64_t instructions, struct trial *trial) {
+  trial->instructions = 0;
+  trial->cycles = 0;
+
+  int status = engine->open(bench);
+  if (status != PDP8_OK) return status;
+
+  if (bench->counting) PDP8_PerfStart(&bench->perf);
+  double start = now();
+  reload(bench, engine);
+  while (trial->instructions < instructions) {
+    if (!bench->pdp8.run) {
+      trial->cycles += bench->pdp8.cycles;
+      reload(bench, engine);
+    }
+    uint64_t executed;
+    engine->run(bench, engine, instructions - trial->instructions, &executed);
+    trial->instructions += executed;
+  }
+  trial->cycles += bench->pdp8.cycles;
+
+  // include draining whatever the engine buffered
+  status = engine->close(bench);
+  trial->seconds = now() - start;
+  if (bench->counting) PDP8_PerfStop(&bench->perf);
+  return status;
+}
+
+static int compare_doubles(const void *left, const void *right) {
+  double a = *(const double *)left, b = *(const double *)right;
+  return (a > b) - (a < b);
+}
+
+static int benchmark(struct bench *bench, const struct engine *engine, const char *workload,
+                     uint64_t instructions, uint warmup, uint trials) {
+  struct trial trial;
+  double ns[MAX_TRIALS];
+  double ratio = 0;
+
+  for (uint i = 0; i < warmup + trials; ++i) {
+    if (i == warmup) PDP8_PerfReset(&bench->perf);
+    int status = run_trial(bench, engine, instructions, &trial);
+    if (status != PDP8_OK) return status;
+    if (i < warmup) continue;
+
+    ns[i - warmup] = trial.seconds * 1e9 / trial.instructions;
+    ratio += trial.cycles * CYCLE_NS * 1e-9 / trial.seconds;
+  }
+
+  double mean = 0, variance = 0;
+  for (uint i = 0; i < trials; ++i) mean += ns[i];
+  mean /= trials;
+  for (uint i = 0; i < trials; ++i) variance += (ns[i] - mean) * (ns[i] - mean);
+  double deviation = trials > 1 ? sqrt(variance / (trials - 1)) : 0;
+
+  qsort(ns, trials, sizeof(ns[0]), compare_doubles);
+  double median = trials & 1 ? ns[trials / 2] : (ns[trials / 2 - 1] + ns[trials / 2]) / 2;
+
+  printf("%-16s %-10s %9.2f %9.2f %9.2f %9.2f %8.2f %10.1f", workload, engine->name,
+         1e3 / median, median, mean, deviation, ns[0], ratio / trials);
+
+  // host events per emulated instruction
+  for (uint i = 0; bench->counting && i < PDP8_PERF_COUNT; ++i) {
+    if (PDP8_PerfAvailable(&bench->perf, i)) {
+      printf(" %13.3f", (double)bench->perf.values[i] / (instructions * trials));
+    } else {
+      printf(" %13s", "-");
+    }
+  }
+  printf("\n");
+  fflush(stdout);
+  return PDP8_OK;
+}
+
+static int usage(const char *name) {
+  fprintf(stderr, "usage: %s [-n instructions] [-w warmup] [-r trials] [-e engine]... [-c corpus] [workload]...\n", name);
+  fprintf(stderr, "  runs each workload (default: the corpus in %s) for the given number of\n", PDP8_CORPUS_DIRECTORY);
+  fprintf(stderr, "  instructions per trial, restarting it when it halts; engines:");
+  for (uint i = 0; i < engine_count; ++i) fprintf(stderr, " %s", engines[i].name);
+  fprintf(stderr, "\n");
+  return 1;
+}
+
+int main(int argc, char **argv) {
+  uint64_t instructions = DEFAULT_INSTRUCTIONS;
+  uint warmup = DEFAULT_WARMUP;
+  uint trials = DEFAULT_TRIALS;
+  const char *directory = PDP8_CORPUS_DIRECTORY;
+  bool selected[MAX_ENGINES] = { false };
+  bool any_selected = false;
+  const char **workloads = (const char **)calloc(argc, sizeof(const char *));
+  uint workload_count = 0;
+  register_engines();
+
+  for (int i = 1; i < argc; ++i) {
+    const char *arg = argv[i];
+    if (arg[0] != '-') {
+      workloads[workload_count++] = arg;
+    } else if (i + 1 >= argc) {
+      return usage(argv[0]);
+    } else if (!strcmp(arg, "-n")) {
+      instructions = strtoull(argv[++i], NULL, 10);
+    } else if (!strcmp(arg, "-w")) {
+      warmup = strtoul(argv[++i], NULL, 10);
+    } else if (!strcmp(arg, "-r")) {
+      trials = strtoul(argv[++i], NULL, 10);
+    } else if (!strcmp(arg, "-c")) {
+      directory = argv[++i];
+    } else if (!strcmp(arg, "-e")) {
+      const char *name = argv[++i];
+      uint e = 0;
+      while (e < engine_count && strcmp(engines[e].name, name)) e++;
+      if (e == engine_count) return usage(argv[0]);
+      selected[e] = any_selected = true;
+    } else {
+      return usage(argv[0]);
+    }
+  }
+  if (instructions == 0 || trials == 0 || trials > MAX_TRIALS) return usage(argv[0]);
+
+  struct bench *bench = (struct bench *)calloc(1, sizeof(struct bench));
+  if (!bench) return 1;
+
+  printf("%llu instructions per trial, %u warmup, %u trials; ns/instruction,\n"
+         "emulated/real time at %.1f us per memory cycle and host events per instruction\n\n",
+         (unsigned long long)instructions, warmup, trials, CYCLE_NS / 1000);
+  bench->counting = PDP8_PerfOpen(&bench->perf);
+  if (!bench->counting) {
+    printf("hardware counters unavailable (%s), wall clock only\n\n", strerror(bench->perf.error));
+  } else if (bench->perf.error) {
+    printf("some hardware counters unavailable (%s)\n\n", strerror(bench->perf.error));
+  }
+
+  printf("%-16s %-10s %9s %9s %9s %9s %8s %10s", "workload", "engine", "MIPS", "median", "mean", "stddev", "min",
+         "x realtime");
+  for (uint i = 0; bench->counting && i < PDP8_PERF_COUNT; ++i) {
+    printf(" %13s", PDP8_PerfCounterNames[i]);
+  }
+  printf("\n");
+
+  int result = 0;
+  uint count = workload_count ? workload_count : PDP8_CORPUS_COUNT;
+  for (uint w = 0; w < count; ++w) {
+    char path[4096];
+    const char *file_name = workloads[w];
+    if (!workload_count) {
+      snprintf(path, sizeof(path), "%s/%s", directory, PDP8_Corpus[w]);
+      file_name = path;
+    }
+
+    struct PDP8_Image image;
+    int status = PDP8_ImageFromFile(&image, file_name);
+    if (status != PDP8_OK) {
+      fprintf(stderr, "%s: %s\n", file_name, PDP8_StatusString(status));
+      result = 1;
+      continue;
+    }
+    bench->image = &image;
+
+    const char *workload = strrchr(file_name, '/') ? strrchr(file_name, '/') + 1 : file_name;
+    for (uint e = 0; e < engine_count; ++e) {
+      if (any_selected && !selected[e]) continue;
+      status = benchmark(bench, &engines[e], workload, instructions, warmup, trials);
+      if (status != PDP8_OK) {
+        fprintf(stderr, "%s: %s: %s\n", workload, engines[e].name, PDP8_StatusString(status));
+        result = 1;
+      }
+    }
+    PDP8_ImageFree(&image);
+  }
+
+  PDP8_PerfClose(&bench->perf);
+  free(bench);
+  free(workloads);
+  return result;
+}
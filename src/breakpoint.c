@@ -0,0 +1,100 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "breakpoint.h"
+#include "watchpoint.h"
+
+void PDP8_BreakpointsInit(struct PDP8_Breakpoints *breakpoints) {
+  memset(breakpoints, 0, sizeof(*breakpoints));
+}
+
+void PDP8_BreakpointInit(struct PDP8_Breakpoint *breakpoint, uint address) {
+  memset(breakpoint, 0, sizeof(*breakpoint));
+  breakpoint->address = address & PDP8_WORD_MASK;
+  breakpoint->link = -1;
+}
+
+static struct PDP8_Breakpoint *get(struct PDP8_Breakpoints *breakpoints, uint id) {
+  return &breakpoints->breakpoints[id - 1];
+}
+
+uint PDP8_BreakpointSet(struct PDP8_Breakpoints *breakpoints, const struct PDP8_Breakpoint *breakpoint) {
+  uint id = 1;
+  while (id <= PDP8_MAX_BREAKPOINTS && get(breakpoints, id)->used) id++;
+  if (id > PDP8_MAX_BREAKPOINTS) return 0;
+
+  // appended, so breakpoints at one address are checked in the order set
+  struct PDP8_Breakpoint *slot = get(breakpoints, id);
+  *slot = *breakpoint;
+  slot->address &= PDP8_WORD_MASK;
+  slot->hits = 0;
+  slot->next = 0;
+  slot->used = true;
+
+  uint16_t *link = &breakpoints->trap[slot->address];
+  while (*link) link = &get(breakpoints, *link)->next;
+  *link = id;
+  breakpoints->count++;
+  return id;
+}
+
+bool PDP8_BreakpointClear(struct PDP8_Breakpoints *breakpoints, uint id) {
+  if (id == 0 || id > PDP8_MAX_BREAKPOINTS || !get(breakpoints, id)->used) return false;
+
+  struct PDP8_Breakpoint *breakpoint = get(breakpoints, id);
+  uint previous = 0;
+  for (uint i = breakpoints->trap[breakpoint->address]; i != id; i = get(breakpoints, i)->next) {
+    previous = i;
+  }
+  if (previous) get(breakpoints, previous)->next = breakpoint->next;
+  else breakpoints->trap[breakpoint->address] = breakpoint->next;
+
+  breakpoint->used = false;
+  breakpoints->count--;
+  return true;
+}
+
+uint PDP8_BreakpointFind(const struct PDP8_Breakpoints *breakpoints, uint address) {
+  return breakpoints->trap[address & PDP8_WORD_MASK];
+}
+
+uint PDP8_BreakpointCheck(struct PDP8_Breakpoints *breakpoints, const struct PDP8 *pdp8) {
+  uint stop = 0;
+  for (uint id = breakpoints->trap[pdp8->pc]; id; id = get(breakpoints, id)->next) {
+    struct PDP8_Breakpoint *breakpoint = get(breakpoints, id);
+    if ((pdp8->ac & breakpoint->ac_mask) != breakpoint->ac_value) continue;
+    if (breakpoint->link >= 0 && (uint)breakpoint->link != pdp8->link) continue;
+    if (++breakpoint->hits > breakpoint->ignore && !stop) stop = id;
+  }
+  return stop;
+}
+
+int PDP8_BreakpointRun(struct PDP8 *pdp8, struct PDP8_Breakpoints *breakpoints, uint64_t budget,
+                       bool resuming, uint64_t *executed, uint *hit) {
+  uint64_t count = 0;
+  int stop = PDP8_STOP_BUDGET;
+  *hit = 0;
+  if (pdp8->watchpoints) pdp8->watchpoints->hit = false;
+
+  while (count < budget) {
+    if (!pdp8->run) {
+      stop = PDP8_STOP_HALT;
+      break;
+    }
+    if ((count || !resuming) && breakpoints && breakpoints->trap[pdp8->pc] && (*hit = PDP8_BreakpointCheck(breakpoints, pdp8))) {
+      stop = PDP8_STOP_BREAKPOINT;
+      break;
+    }
+    PDP8_Step(pdp8);
+    count++;
+    if (pdp8->watch_pages && pdp8->watchpoints->hit) {
+      stop = PDP8_STOP_WATCHPOINT;
+      break;
+    }
+  }
+  if (stop == PDP8_STOP_BUDGET && !pdp8->run) stop = PDP8_STOP_HALT;
+
+  if (executed) *executed = count;
+  return stop;
+}
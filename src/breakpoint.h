@@ -0,0 +1,59 @@
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+#ifndef PDP8_BREAKPOINT_H
+#define PDP8_BREAKPOINT_H
+
+#include "pdp8.h"
+
+#define PDP8_MAX_BREAKPOINTS 1024
+
+  // Stops before the instruction at address is fetched when its conditions
+  // hold and it has been passed over ignore times.
+  struct PDP8_Breakpoint {
+    uint address;
+    uint ac_mask;                      //  stop only if (AC & ac_mask) == ac_value
+    uint ac_value;
+    int  link;                         //  stop only if L equals it, or -1
+    uint64_t ignore;                   //  hits to pass over before stopping
+    uint64_t hits;                     //  times the conditions held
+    uint16_t next;                     //  id of the next one at address, 0 for none
+    bool used;
+  };
+
+  // Breakpoints are found through a per-address trap table, so checking an
+  // address costs one load however many are set. Ids start at 1.
+  struct PDP8_Breakpoints {
+    uint16_t trap[PDP8_MEMORY_SIZE];   //  id of the first at each address, 0 for none
+    uint count;                        //  in use
+    struct PDP8_Breakpoint breakpoints[PDP8_MAX_BREAKPOINTS];
+  };
+
+  extern void PDP8_BreakpointsInit(struct PDP8_Breakpoints *breakpoints);
+
+  // Unconditional breakpoint at address, to be refined before setting it.
+  extern void PDP8_BreakpointInit(struct PDP8_Breakpoint *breakpoint, uint address);
+
+  // Returns the new id, or 0 when the table is full.
+  extern uint PDP8_BreakpointSet(struct PDP8_Breakpoints *breakpoints, const struct PDP8_Breakpoint *breakpoint);
+  extern bool PDP8_BreakpointClear(struct PDP8_Breakpoints *breakpoints, uint id);
+  extern uint PDP8_BreakpointFind(const struct PDP8_Breakpoints *breakpoints, uint address);
+
+  // Counts hits of the breakpoints at PC and returns the id of the first
+  // that stops, or 0.
+  extern uint PDP8_BreakpointCheck(struct PDP8_Breakpoints *breakpoints, const struct PDP8 *pdp8);
+
+  // PDP8_RunFor consulting the trap table before every fetch. resuming
+  // skips the check before the first one, to continue from the breakpoint
+  // that stopped the machine. Returns PDP8_STOP_BREAKPOINT with its id in
+  // *hit, or PDP8_STOP_WATCHPOINT after an instruction hit an attached
+  // watchpoint. breakpoints may be NULL.
+  extern int PDP8_BreakpointRun(struct PDP8 *pdp8, struct PDP8_Breakpoints *breakpoints, uint64_t budget,
+                                bool resuming, uint64_t *executed, uint *hit);
+
+#endif //PDP8_BREAKPOINT_H
+
+#if defined (__cplusplus)
+}
+#endif
@@ -0,0 +1,14 @@
+#ifndef PDP8_CORPUS_H
+#define PDP8_CORPUS_H
+
+// Workloads in program/ used to benchmark and validate engines; the tools
+// run from build/ like the GUI.
+#define PDP8_CORPUS_DIRECTORY "../program"
+
+static const char *const PDP8_Corpus[] = {
+  "compare.pal", "hello_world.pal", "sieve.pal", "multiply.pal", "memcpy.pal", "interrupt.pal",
+};
+
+#define PDP8_CORPUS_COUNT (sizeof(PDP8_Corpus) / sizeof(PDP8_Corpus[0]))
+
+#endif //PDP8_CORPUS_H
@@ -1,4 +1,170 @@
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
 
-struct PDP8_Instruction {
-  
-};
+#include "disassembler.h"
+#include "instruction.h"
+#include "symbols.h"
+
+#define MNEMONIC_LENGTH 32
+
+// Text for every possible instruction word. Memory reference entries end
+// with a blank and only need their operand appended.
+static char mnemonics[PDP8_MEMORY_SIZE][MNEMONIC_LENGTH];
+static uint8_t mnemonic_lengths[PDP8_MEMORY_SIZE];
+static pthread_once_t mnemonics_once = PTHREAD_ONCE_INIT;
+
+static const char octal_digits[] = "01234567";
+
+static uint put_octal(char *text, uint value) {
+  text[0] = octal_digits[(value >> 9) & 7];
+  text[1] = octal_digits[(value >> 6) & 7];
+  text[2] = octal_digits[(value >> 3) & 7];
+  text[3] = octal_digits[value & 7];
+  return 4;
+}
+
+static void append(char *text, const char *name) {
+  if (text[0]) strcat(text, " ");
+  strcat(text, name);
+}
+
+static void group1(char *text, uint ir) {
+  bool cla = ir & OPR_CLA, cll = ir & OPR_CLL, cma = ir & OPR_CMA, cml = ir & OPR_CML, iac = ir & OPR_IAC;
+  bool rar = ir & OPR_RAR, ral = ir & OPR_RAL, rt = ir & OPR_RT;
+
+  if (cla && cma) { append(text, "STA"); cla = cma = false; }
+  if (cla)        { append(text, "CLA"); }
+  if (cll && cml) { append(text, "STL"); cll = cml = false; }
+  if (cll)        { append(text, "CLL"); }
+  if (cma && iac) { append(text, "CIA"); iac = false; }
+  else if (cma)   { append(text, "CMA"); }
+  if (cml)        { append(text, "CML"); }
+  if (iac)        { append(text, "IAC"); }
+  if (rar)        { append(text, rt ? "RTR" : "RAR"); }
+  if (ral)        { append(text, rt ? "RTL" : "RAL"); }
+  if (rt && !rar && !ral) { append(text, "BSW"); }
+
+  if (!text[0]) append(text, "NOP");
+}
+
+static void group2(char *text, uint ir) {
+  if (ir & OPR_IS) {
+    if (ir & OPR_SPA) append(text, "SPA");
+    if (ir & OPR_SNA) append(text, "SNA");
+    if (ir & OPR_SZL) append(text, "SZL");
+    if (!(ir & (OPR_SPA | OPR_SNA | OPR_SZL))) append(text, "SKP");
+  } else {
+    if (ir & OPR_SMA) append(text, "SMA");
+    if (ir & OPR_SZA) append(text, "SZA");
+    if (ir & OPR_SNL) append(text, "SNL");
+  }
+
+  if ((ir & OPR_CLA) && (ir & OPR_OSR)) {
+    append(text, "LAS");
+  } else {
+    if (ir & OPR_CLA) append(text, "CLA");
+    if (ir & OPR_OSR) append(text, "OSR");
+  }
+  if (ir & OPR_HLT) append(text, "HLT");
+
+  if (!text[0]) append(text, "NOP");
+}
+
+static void group3(char *text, uint ir) {
+  if (ir & OPR_EAE) {
+    put_octal(text, ir);
+    text[4] = 0;
+    return;
+  }
+
+  bool cla = ir & OPR_CLA, mqa = ir & OPR_MQA, mql = ir & OPR_MQL;
+  if (mqa && mql)      { append(text, cla ? "CLA SWP" : "SWP"); }
+  else if (cla && mql) { append(text, "CAM"); }
+  else if (cla && mqa) { append(text, "ACL"); }
+  else {
+    if (cla) append(text, "CLA");
+    if (mqa) append(text, "MQA");
+    if (mql) append(text, "MQL");
+  }
+
+  if (!text[0]) append(text, "NOP");
+}
+
+static void build_mnemonics(void) {
+  const char *mri[6] = { 0 };
+  for (uint i = 0; i < PDP8_MnemonicCount; ++i) {
+    const struct PDP8_Mnemonic *m = &PDP8_Mnemonics[i];
+    if (m->type == PDP8_SYMBOL_MRI) {
+      mri[m->value >> 9] = m->name;
+    } else if (m->type == PDP8_SYMBOL_PERMANENT && (m->value & OPCODE) == (PDP8_IOT << 9)) {
+      strcpy(mnemonics[m->value], m->name);   // later entries win, so SKON beats IOT
+    }
+  }
+
+  for (uint ir = 0; ir < PDP8_MEMORY_SIZE; ++ir) {
+    char *text = mnemonics[ir];
+    struct PDP8_Instruction i = PDP8_Decode(ir);
+
+    switch (i.opcode) {
+      case PDP8_IOT: {
+        if (!text[0]) {
+          put_octal(text, ir);
+          text[4] = 0;
+        }
+      } break;
+      case PDP8_OPR: {
+        if (!(ir & OPR_GROUP))  group1(text, ir);
+        else if (ir & OPR_GROUP3) group3(text, ir);
+        else                    group2(text, ir);
+      } break;
+      default: {
+        strcpy(text, mri[i.opcode]);
+        strcat(text, i.indirect ? " I " : " ");
+      } break;
+    }
+
+    mnemonic_lengths[ir] = strlen(text);
+  }
+}
+
+const char *PDP8_MnemonicText(uint word) {
+  pthread_once(&mnemonics_once, build_mnemonics);
+  return mnemonics[word & PDP8_WORD_MASK];
+}
+
+static uint disassemble(uint word, uint address, const char *const *names, char *text) {
+  word &= PDP8_WORD_MASK;
+  uint length = mnemonic_lengths[word];
+  memcpy(text, mnemonics[word], length);
+
+  if ((word & OPCODE) < (PDP8_IOT << 9)) {
+    uint target = PDP8_DirectAddress(word, address);
+    const char *name = names ? names[target] : NULL;
+    if (name) {
+      uint n = strlen(name);
+      memcpy(text + length, name, n);
+      length += n;
+    } else {
+      length += put_octal(text + length, target);
+    }
+  }
+
+  text[length] = 0;
+  return length;
+}
+
+uint PDP8_Disassemble(uint word, uint address, const char *const *names, char *text) {
+  pthread_once(&mnemonics_once, build_mnemonics);
+  return disassemble(word, address, names, text);
+}
+
+void PDP8_DisassembleRange(const uint *memory, uint first, uint count, const char *const *names,
+                           char (*lines)[PDP8_DISASSEMBLY_LENGTH]) {
+  pthread_once(&mnemonics_once, build_mnemonics);
+  for (uint i = 0; i < count; ++i) {
+    uint address = (first + i) & PDP8_WORD_MASK;
+    disassemble(memory[address], address, names, lines[i]);
+  }
+}
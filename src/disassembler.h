@@ -0,0 +1,26 @@
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+#ifndef PDP8_DISASSEMBLER_H
+#define PDP8_DISASSEMBLER_H
+
+#include "pdp8.h"
+
+  enum PDP8_DisassemblerConstants {
+    PDP8_DISASSEMBLY_LENGTH = 48,      // line buffer size including the NUL
+  };
+
+  // names is an optional PDP8_MEMORY_SIZE table of label names indexed by
+  // address (see PDP8_SymbolsByAddress); memory reference operands with a
+  // name are printed symbolically, the others as four octal digits.
+  extern const char *PDP8_MnemonicText(uint word);
+  extern uint PDP8_Disassemble(uint word, uint address, const char *const *names, char *text);
+  extern void PDP8_DisassembleRange(const uint *memory, uint first, uint count, const char *const *names,
+                                    char (*lines)[PDP8_DISASSEMBLY_LENGTH]);
+
+#endif //PDP8_DISASSEMBLER_H
+
+#if defined (__cplusplus)
+}
+#endif
@@ -0,0 +1,351 @@
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "emulator.h"
+
+#define MIN_SLICE 1024
+#define MAX_SLICE (1 << 26)
+
+static uint64_t now(void) {
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return (uint64_t)time.tv_sec * 1000000000 + time.tv_nsec;
+}
+
+// Starts the history over from the current state.
+static void restart(struct PDP8_Emulator *emulator) {
+  PDP8_HistoryFree(&emulator->history);
+  int status = PDP8_HistoryInit(&emulator->history, &emulator->pdp8);
+  if (status != PDP8_OK) fprintf(stderr, "history: %s\n", PDP8_StatusString(status));
+}
+
+static void reload(struct PDP8_Emulator *emulator) {
+  struct PDP8 *pdp8 = &emulator->pdp8;
+  PDP8_Reset(pdp8);
+  PDP8_MemoryReset(pdp8);
+  PDP8_LoadImage(pdp8, emulator->image);
+  PDP8_StartImage(pdp8, emulator->image);
+  pdp8->switches = emulator->switches;
+  pdp8->print = emulator->print;
+  pdp8->print_context = emulator->print_context;
+  if (emulator->panel) PDP8_LampsAttach(pdp8, &emulator->lamps);
+  restart(emulator);
+}
+
+static void publish(struct PDP8_Emulator *emulator) {
+  if (emulator->panel) PDP8_LampsFlush(&emulator->lamps);
+
+  uint64_t sequence = emulator->sequence;
+  __atomic_store_n(&emulator->sequence, sequence + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+
+  struct PDP8_EmulatorView *view = &emulator->view;
+  view->pdp8 = emulator->pdp8;
+  view->commands = emulator->command_tail;
+  view->instructions = emulator->history.instructions;
+  view->breakpoints = emulator->breakpoints.count;
+  view->running = emulator->running;
+  view->tracing = emulator->tracing;
+  view->throttle = emulator->throttle;
+  view->rate = emulator->rate;
+  view->mips = emulator->mips;
+  view->panel = emulator->panel;
+  if (emulator->panel) {
+    view->lamp_instructions = emulator->lamps.instructions;
+    memcpy(view->lamps, emulator->lamps.totals, sizeof(view->lamps));
+  }
+
+  __atomic_store_n(&emulator->sequence, sequence + 2, __ATOMIC_RELEASE);
+}
+
+static void step(struct PDP8_Emulator *emulator) {
+  if (emulator->tracing) {
+    PDP8_TraceStep(&emulator->trace, &emulator->pdp8);
+    PDP8_HistoryAdvance(&emulator->history, &emulator->pdp8, 1);
+  } else {
+    uint64_t executed;
+    PDP8_HistoryRun(&emulator->history, &emulator->pdp8, 1, &executed);
+  }
+}
+
+static bool at_address(const struct PDP8 *pdp8, void *context) {
+  return pdp8->pc == *(const uint *)context;
+}
+
+// Runs up to budget instructions, stopping at a halt or at a breakpoint
+// other than the one just resumed from, and returns the count. Without
+// breakpoints or tracing the history runs the whole slice itself.
+static uint64_t run_slice(struct PDP8_Emulator *emulator, uint64_t budget) {
+  struct PDP8 *pdp8 = &emulator->pdp8;
+  struct PDP8_Breakpoints *breakpoints = &emulator->breakpoints;
+  uint64_t count = 0;
+
+  while (count < budget) {
+    if (!pdp8->run) {
+      emulator->running = false;
+      break;
+    }
+
+    uint64_t ran;
+    if (emulator->tracing) {
+      if (!emulator->resuming && breakpoints->trap[pdp8->pc] && PDP8_BreakpointCheck(breakpoints, pdp8)) {
+        emulator->running = false;
+        break;
+      }
+      step(emulator);
+      ran = 1;
+    } else if (!breakpoints->count) {
+      PDP8_HistoryRun(&emulator->history, pdp8, budget - count, &ran);
+    } else {
+      uint hit;
+      int stop = PDP8_BreakpointRun(pdp8, breakpoints, budget - count, emulator->resuming, &ran, &hit);
+      PDP8_HistoryAdvance(&emulator->history, pdp8, ran);
+      if (stop == PDP8_STOP_BREAKPOINT) {
+        count += ran;
+        emulator->running = false;
+        break;
+      }
+    }
+    emulator->resuming = false;
+    count += ran;
+  }
+
+  return count;
+}
+
+static uint64_t position(const struct PDP8_Emulator *emulator) {
+  return emulator->throttle == PDP8_THROTTLE_CYCLES ? emulator->pdp8.cycles : emulator->executed;
+}
+
+static void rebase(struct PDP8_Emulator *emulator) {
+  emulator->throttle_start = now();
+  emulator->throttle_base = position(emulator);
+}
+
+// Instructions the next slice may run: what a throttled run is behind the
+// clock by, in cycles as an upper bound on instructions when the machine's
+// own speed is wanted. A run that falls more than a tenth of a second
+// behind, because the host can't keep up, starts counting afresh rather
+// than racing to catch up.
+static uint64_t slice_budget(struct PDP8_Emulator *emulator) {
+  if (emulator->throttle == PDP8_THROTTLE_NONE) return emulator->slice;
+
+  uint64_t due = (uint64_t)((double)emulator->rate * (now() - emulator->throttle_start) / 1e9);
+  uint64_t done = position(emulator) - emulator->throttle_base;
+  if (done >= due) return 0;
+
+  uint64_t behind = due - done;
+  if (behind > emulator->rate / 10 + 1) {
+    rebase(emulator);
+    return emulator->slice;
+  }
+  return behind < emulator->slice ? behind : emulator->slice;
+}
+
+static void run_budget(struct PDP8_Emulator *emulator, uint64_t budget) {
+  uint64_t start = now();
+  uint64_t ran = run_slice(emulator, budget);
+  uint64_t end = now();
+  emulator->executed += ran;
+
+  // size unthrottled slices to take PDP8_EMULATOR_SLICE_NS
+  if (emulator->throttle == PDP8_THROTTLE_NONE && ran == budget && end > start) {
+    uint64_t slice = emulator->slice * PDP8_EMULATOR_SLICE_NS / (end - start);
+    emulator->slice = slice < MIN_SLICE ? MIN_SLICE : slice > MAX_SLICE ? MAX_SLICE : slice;
+  }
+
+  if (end - emulator->mips_start >= PDP8_EMULATOR_MIPS_NS) {
+    emulator->mips = (emulator->executed - emulator->mips_base) * 1000.0 / (end - emulator->mips_start);
+    emulator->mips_start = end;
+    emulator->mips_base = emulator->executed;
+  }
+}
+
+static void toggle_trace(struct PDP8_Emulator *emulator) {
+  if (emulator->tracing) {
+    int status = PDP8_TraceClose(&emulator->trace);
+    if (status != PDP8_OK) fprintf(stderr, "pdp8.trace: %s\n", PDP8_StatusString(status));
+    emulator->tracing = false;
+  } else {
+    int status = PDP8_TraceOpenFile(&emulator->trace, "pdp8.trace");
+    if (status != PDP8_OK) fprintf(stderr, "pdp8.trace: %s\n", PDP8_StatusString(status));
+    emulator->tracing = status == PDP8_OK;
+  }
+}
+
+static void execute(struct PDP8_Emulator *emulator, const struct PDP8_EmulatorCommand *command) {
+  struct PDP8 *pdp8 = &emulator->pdp8;
+  switch (command->kind) {
+    case PDP8_COMMAND_STEP:
+      emulator->running = false;
+      step(emulator);
+      break;
+    case PDP8_COMMAND_RUN:
+      if (!emulator->running) {
+        emulator->resuming = true;
+        emulator->mips_start = now();
+        emulator->mips_base = emulator->executed;
+        rebase(emulator);
+      }
+      emulator->running = true;
+      break;
+    case PDP8_COMMAND_STOP:
+      emulator->running = false;
+      break;
+    case PDP8_COMMAND_BACK:
+      emulator->running = false;
+      PDP8_HistoryBack(&emulator->history, pdp8, 1);
+      break;
+    case PDP8_COMMAND_REVERSE: {
+      emulator->running = false;
+      uint address = pdp8->pc;
+      PDP8_HistoryReverse(&emulator->history, pdp8, at_address, &address);
+      break;
+    }
+    case PDP8_COMMAND_BREAKPOINT: {
+      uint id = PDP8_BreakpointFind(&emulator->breakpoints, pdp8->pc);
+      if (id) {
+        PDP8_BreakpointClear(&emulator->breakpoints, id);
+      } else {
+        struct PDP8_Breakpoint breakpoint;
+        PDP8_BreakpointInit(&breakpoint, pdp8->pc);
+        PDP8_BreakpointSet(&emulator->breakpoints, &breakpoint);
+      }
+      break;
+    }
+    case PDP8_COMMAND_TRACE:
+      toggle_trace(emulator);
+      break;
+    case PDP8_COMMAND_RESET:
+      emulator->running = false;
+      reload(emulator);
+      break;
+    case PDP8_COMMAND_CLEAR:
+      PDP8_MemoryReset(pdp8);
+      restart(emulator);
+      break;
+    case PDP8_COMMAND_SPEED:
+      emulator->throttle = command->argument ? PDP8_THROTTLE_INSTRUCTIONS : PDP8_THROTTLE_NONE;
+      emulator->rate = command->argument;
+      rebase(emulator);
+      break;
+    case PDP8_COMMAND_REAL_TIME:
+      emulator->throttle = PDP8_THROTTLE_CYCLES;
+      emulator->rate = 1000000000 / PDP8_EMULATOR_CYCLE_NS;
+      rebase(emulator);
+      break;
+    case PDP8_COMMAND_PANEL:
+      emulator->panel = !emulator->panel;
+      PDP8_LampsAttach(pdp8, emulator->panel ? &emulator->lamps : NULL);
+      break;
+    case PDP8_COMMAND_SEEK: {
+      emulator->running = false;
+      uint64_t from = emulator->history.instructions;
+      uint64_t to = PDP8_HistorySeek(&emulator->history, pdp8, command->argument);
+      if (to > from) emulator->executed += to - from;
+      break;
+    }
+  }
+}
+
+// Executes the queued commands; false if there were none.
+static bool drain(struct PDP8_Emulator *emulator) {
+  uint64_t tail = emulator->command_tail;
+  uint64_t head = __atomic_load_n(&emulator->command_head, __ATOMIC_ACQUIRE);
+  if (head == tail) return false;
+
+  for (; tail != head; ++tail) {
+    execute(emulator, &emulator->commands[tail & (PDP8_EMULATOR_COMMANDS - 1)]);
+  }
+  __atomic_store_n(&emulator->command_tail, tail, __ATOMIC_RELEASE);
+  return true;
+}
+
+static void *emulate(void *argument) {
+  struct PDP8_Emulator *emulator = (struct PDP8_Emulator *)argument;
+
+  while (!__atomic_load_n(&emulator->stop, __ATOMIC_ACQUIRE)) {
+    bool changed = drain(emulator);
+    uint64_t budget = emulator->running ? slice_budget(emulator) : 0;
+    if (budget) {
+      run_budget(emulator, budget);
+      changed = true;
+    }
+    if (!emulator->running) emulator->mips = 0;
+    if (changed) {
+      publish(emulator);
+    } else {
+      struct timespec idle = { 0, PDP8_EMULATOR_IDLE_NS };
+      nanosleep(&idle, NULL);
+    }
+  }
+
+  return NULL;
+}
+
+void PDP8_EmulatorInit(struct PDP8_Emulator *emulator, const struct PDP8_Image *image, uint switches) {
+  memset(emulator, 0, sizeof(*emulator));
+  emulator->image = image;
+  emulator->switches = switches;
+  emulator->slice = PDP8_EMULATOR_SLICE;
+  emulator->panel = true;
+  PDP8_BreakpointsInit(&emulator->breakpoints);
+}
+
+int PDP8_EmulatorStart(struct PDP8_Emulator *emulator) {
+  reload(emulator);
+  publish(emulator);
+  if (pthread_create(&emulator->thread, NULL, emulate, emulator) != 0) {
+    PDP8_HistoryFree(&emulator->history);
+    return PDP8_ERROR_MEMORY;
+  }
+  return PDP8_OK;
+}
+
+void PDP8_EmulatorStop(struct PDP8_Emulator *emulator) {
+  __atomic_store_n(&emulator->stop, 1, __ATOMIC_RELEASE);
+  pthread_join(emulator->thread, NULL);
+
+  if (emulator->tracing) {
+    PDP8_TraceClose(&emulator->trace);
+    emulator->tracing = false;
+  }
+  PDP8_HistoryFree(&emulator->history);
+}
+
+bool PDP8_EmulatorCommand(struct PDP8_Emulator *emulator, uint kind, uint64_t argument) {
+  uint64_t head = emulator->command_head;
+  if (head - __atomic_load_n(&emulator->command_tail, __ATOMIC_ACQUIRE) >= PDP8_EMULATOR_COMMANDS) return false;
+
+  struct PDP8_EmulatorCommand *command = &emulator->commands[head & (PDP8_EMULATOR_COMMANDS - 1)];
+  command->kind = kind;
+  command->argument = argument;
+  __atomic_store_n(&emulator->command_head, head + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+void PDP8_EmulatorRead(struct PDP8_Emulator *emulator, struct PDP8_EmulatorView *view) {
+  for (;;) {
+    uint64_t sequence = __atomic_load_n(&emulator->sequence, __ATOMIC_ACQUIRE);
+    if (sequence & 1) continue;
+
+    *view = emulator->view;
+
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&emulator->sequence, __ATOMIC_RELAXED) == sequence) return;
+  }
+}
+
+void PDP8_EmulatorWait(struct PDP8_Emulator *emulator, struct PDP8_EmulatorView *view) {
+  for (;;) {
+    PDP8_EmulatorRead(emulator, view);
+    if (view->commands == emulator->command_head) return;
+
+    struct timespec idle = { 0, PDP8_EMULATOR_IDLE_NS };
+    nanosleep(&idle, NULL);
+  }
+}
@@ -0,0 +1,133 @@
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+#ifndef PDP8_EMULATOR_H
+#define PDP8_EMULATOR_H
+
+#include <pthread.h>
+
+#include "pdp8.h"
+#include "loader.h"
+#include "trace.h"
+#include "history.h"
+#include "breakpoint.h"
+#include "lamps.h"
+
+#define PDP8_EMULATOR_COMMANDS 64      // queue capacity, a power of two
+#define PDP8_EMULATOR_SLICE    65536   // first slice of a run, in instructions
+#define PDP8_EMULATOR_SLICE_NS 1000000 // time a slice aims for, between command checks
+#define PDP8_EMULATOR_IDLE_NS  1000000 // poll interval while stopped or ahead of time
+#define PDP8_EMULATOR_MIPS_NS  250000000 // MIPS measurement period
+#define PDP8_EMULATOR_CYCLE_NS 1500    // memory cycle of a real PDP-8
+
+  enum PDP8_EmulatorCommandKind {
+    PDP8_COMMAND_STEP,                 // stop, then execute one instruction
+    PDP8_COMMAND_RUN,                  // run until stopped, a halt or a breakpoint
+    PDP8_COMMAND_STOP,
+    PDP8_COMMAND_BACK,                 // stop and step back one instruction
+    PDP8_COMMAND_REVERSE,              // stop and go back to the last time PC ran
+    PDP8_COMMAND_BREAKPOINT,           // toggle a breakpoint at PC
+    PDP8_COMMAND_TRACE,                // toggle tracing to pdp8.trace
+    PDP8_COMMAND_RESET,                // stop and reload the image
+    PDP8_COMMAND_CLEAR,                // clear memory
+    PDP8_COMMAND_SPEED,                // argument instructions per second, 0 for unlimited
+    PDP8_COMMAND_REAL_TIME,            // run at the speed of a real PDP-8
+    PDP8_COMMAND_PANEL,                // toggle counting front panel lamps
+    PDP8_COMMAND_SEEK,                 // stop and move to history position argument
+  };
+
+  enum PDP8_EmulatorThrottle {
+    PDP8_THROTTLE_NONE,
+    PDP8_THROTTLE_INSTRUCTIONS,        // rate is instructions per second
+    PDP8_THROTTLE_CYCLES,              // rate is memory cycles per second
+  };
+
+  struct PDP8_EmulatorCommand {
+    uint kind;
+    uint64_t argument;
+  };
+
+  // What the user interface sees, copied out whole after each command and
+  // each slice of a run.
+  struct PDP8_EmulatorView {
+    struct PDP8 pdp8;                  //  instrumentation pointers not to be followed
+    uint64_t commands;                 //  commands executed
+    uint64_t instructions;             //  history position
+    uint breakpoints;
+    bool running;
+    bool tracing;
+    uint throttle;
+    uint64_t rate;
+    double mips;                       //  over the last PDP8_EMULATOR_MIPS_NS, 0 when stopped
+    bool panel;
+    uint64_t lamp_instructions;        //  running totals: average over a frame by
+    uint64_t lamps[PDP8_LAMP_COUNT];   //  differencing successive views
+  };
+
+  // Runs a machine on its own thread. The user interface thread sends
+  // commands through a single producer, single consumer ring and reads the
+  // state through a seqlock, so neither ever waits on the other: the
+  // emulator only checks for commands between slices of a run, and a
+  // reader that overlaps a publish copies the view again.
+  struct PDP8_Emulator {
+    // emulation thread owned
+    struct PDP8 pdp8;
+    struct PDP8_History history;
+    struct PDP8_Breakpoints breakpoints;
+    struct PDP8_Trace trace;
+    bool tracing;
+    bool running;
+    bool resuming;                     //  don't stop at the breakpoint at PC
+    uint64_t executed;                 //  instructions run forward, ever
+    bool panel;
+    struct PDP8_Lamps lamps;           //  attached while panel is set
+
+    // A throttled run keeps its instruction or cycle count in step with
+    // the clock since it started; an unthrottled one sizes its slices to
+    // take about PDP8_EMULATOR_SLICE_NS.
+    uint throttle;
+    uint64_t rate;
+    uint64_t throttle_start;           //  clock, ns
+    uint64_t throttle_base;            //  instructions or cycles at throttle_start
+    uint64_t slice;
+    uint64_t mips_start;               //  clock, ns
+    uint64_t mips_base;                //  executed at mips_start
+    double mips;
+
+    // set up before PDP8_EmulatorStart
+    const struct PDP8_Image *image;
+    uint switches;
+    void (*print)(void *context, uint c);
+    void *print_context;
+
+    struct PDP8_EmulatorCommand commands[PDP8_EMULATOR_COMMANDS];
+    uint64_t command_head;             //  next command to write, user interface owned
+    uint64_t command_tail;             //  next command to take, emulator owned
+
+    uint64_t sequence;                 //  odd while the view is being written
+    struct PDP8_EmulatorView view;
+
+    int stop;
+    pthread_t thread;
+  };
+
+  // The image must outlive the emulator. Lamps are counted from the start.
+  extern void PDP8_EmulatorInit(struct PDP8_Emulator *emulator, const struct PDP8_Image *image, uint switches);
+  extern int  PDP8_EmulatorStart(struct PDP8_Emulator *emulator);
+  extern void PDP8_EmulatorStop(struct PDP8_Emulator *emulator);
+
+  // Called from the user interface thread. A command is dropped, returning
+  // false, when the queue is full.
+  extern bool PDP8_EmulatorCommand(struct PDP8_Emulator *emulator, uint kind, uint64_t argument);
+  extern void PDP8_EmulatorRead(struct PDP8_Emulator *emulator, struct PDP8_EmulatorView *view);
+
+  // Reads the view once every command sent so far has been executed, for
+  // callers that script the machine rather than watch it.
+  extern void PDP8_EmulatorWait(struct PDP8_Emulator *emulator, struct PDP8_EmulatorView *view);
+
+#endif //PDP8_EMULATOR_H
+
+#if defined (__cplusplus)
+}
+#endif
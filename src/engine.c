@@ -0,0 +1,47 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "engine.h"
+#include "instruction.h"
+
+// One PDP8_Step call per instruction, as the GUI and the tracer run.
+static int run_steps(struct PDP8 *pdp8, uint64_t budget, uint64_t *executed) {
+  uint64_t count = 0;
+  while (pdp8->run && count < budget) {
+    PDP8_Step(pdp8);
+    count++;
+  }
+
+  if (executed) *executed = count;
+  return pdp8->run ? PDP8_STOP_BUDGET : PDP8_STOP_HALT;
+}
+
+// PDP8_Step, except that a TAD that carries leaves the link alone.
+static int run_faulty_tad(struct PDP8 *pdp8, uint64_t budget, uint64_t *executed) {
+  uint64_t count = 0;
+  while (pdp8->run && count < budget) {
+    uint link = pdp8->link;
+    PDP8_Step(pdp8);
+    if ((pdp8->ir >> 9) == PDP8_TAD) pdp8->link = link;
+    count++;
+  }
+
+  if (executed) *executed = count;
+  return pdp8->run ? PDP8_STOP_BUDGET : PDP8_STOP_HALT;
+}
+
+const struct PDP8_Engine PDP8_Engines[] = {
+  { "reference",  "PDP8_RunFor, the switch interpreter in pdp8.c", PDP8_RunFor,    false },
+  { "step",       "PDP8_Step called once per instruction",         run_steps,      false },
+  { "faulty-tad", "PDP8_Step with the link kept on a TAD carry",   run_faulty_tad, true },
+};
+
+const uint PDP8_EngineCount = sizeof(PDP8_Engines) / sizeof(PDP8_Engines[0]);
+
+const struct PDP8_Engine *PDP8_FindEngine(const char *name) {
+  for (uint i = 0; i < PDP8_EngineCount; ++i) {
+    if (!strcmp(PDP8_Engines[i].name, name)) return &PDP8_Engines[i];
+  }
+  return NULL;
+}
@@ -0,0 +1,30 @@
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+#ifndef PDP8_ENGINE_H
+#define PDP8_ENGINE_H
+
+#include "pdp8.h"
+
+  // An execution engine runs a machine for up to budget instructions with
+  // the semantics of PDP8_Step and returns a PDP8_StopReason. Engines must
+  // honour a budget of one so they can be checked instruction by
+  // instruction against the reference.
+  struct PDP8_Engine {
+    const char *name;
+    const char *description;
+    int (*run)(struct PDP8 *pdp8, uint64_t budget, uint64_t *executed);
+    bool faulty;                       //  broken on purpose to test the checker; only run when named
+  };
+
+  extern const struct PDP8_Engine PDP8_Engines[];
+  extern const uint PDP8_EngineCount;
+
+  extern const struct PDP8_Engine *PDP8_FindEngine(const char *name);
+
+#endif //PDP8_ENGINE_H
+
+#if defined (__cplusplus)
+}
+#endif
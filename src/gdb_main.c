@@ -0,0 +1,119 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include "pdp8.h"
+#include "loader.h"
+#include "gdbstub.h"
+
+static void print_character(void *context, uint c) {
+  FILE *file = (FILE *)context;
+  fputc(c & 0177, file);
+  fflush(file);
+}
+
+static int usage(const char *name) {
+  fprintf(stderr, "usage: %s image (-u socket | -p port) [-g start] [-s switches] [-d address=value]...\n", name);
+  fprintf(stderr, "       [-o output]\n");
+  fprintf(stderr, "  serves the remote serial protocol on a Unix-domain socket or a localhost\n");
+  fprintf(stderr, "  TCP port until the debugger kills the target; printer output goes to\n");
+  fprintf(stderr, "  stdout or -o output; numbers are octal except the port\n");
+  return 1;
+}
+
+int main(int argc, char **argv) {
+  const char *file_name = NULL;
+  const char *socket_name = NULL;
+  const char *output_name = NULL;
+  uint port = 0;
+  int start = PDP8_NO_START;
+  uint switches = 0;
+  struct PDP8_Image deposits;
+  PDP8_ImageInit(&deposits);
+
+  for (int i = 1; i < argc; ++i) {
+    const char *arg = argv[i];
+    uint address, value;
+    if (arg[0] != '-') {
+      if (file_name) return usage(argv[0]);
+      file_name = arg;
+    } else if (i + 1 >= argc) {
+      return usage(argv[0]);
+    } else if (!strcmp(arg, "-u")) {
+      socket_name = argv[++i];
+    } else if (!strcmp(arg, "-p")) {
+      port = strtoul(argv[++i], NULL, 10);
+    } else if (!strcmp(arg, "-o")) {
+      output_name = argv[++i];
+    } else if (!strcmp(arg, "-g") && PDP8_ParseOctal(argv[++i], &address)) {
+      start = address;
+    } else if (!strcmp(arg, "-s") && PDP8_ParseOctal(argv[++i], &value)) {
+      switches = value;
+    } else if (!strcmp(arg, "-d") && PDP8_ParseDeposit(argv[++i], &address, &value)) {
+      PDP8_ImageDeposit(&deposits, address, value);
+    } else {
+      return usage(argv[0]);
+    }
+  }
+  if (!file_name || !socket_name == !port || port > 65535) return usage(argv[0]);
+
+  struct PDP8_Image image;
+  int status = PDP8_ImageFromFile(&image, file_name);
+  if (status != PDP8_OK) {
+    fprintf(stderr, "%s: %s\n", file_name, PDP8_StatusString(status));
+    return 1;
+  }
+  for (uint i = 0; i < deposits.deposit_count; ++i) {
+    PDP8_ImageDeposit(&image, deposits.deposits[i].address, deposits.deposits[i].value);
+  }
+  PDP8_ImageFree(&deposits);
+  if (start != PDP8_NO_START) image.start = start;
+
+  FILE *output = stdout;
+  if (output_name && !(output = fopen(output_name, "wb"))) {
+    perror(output_name);
+    return 1;
+  }
+
+  struct PDP8 *pdp8 = (struct PDP8 *)malloc(sizeof(struct PDP8));
+  struct PDP8_GdbStub *stub = (struct PDP8_GdbStub *)malloc(sizeof(struct PDP8_GdbStub));
+  if (!pdp8 || !stub) return 1;
+  PDP8_Reset(pdp8);
+  PDP8_MemoryReset(pdp8);
+  PDP8_LoadImage(pdp8, &image);
+  PDP8_StartImage(pdp8, &image);
+  pdp8->switches = switches;
+  pdp8->print = print_character;
+  pdp8->print_context = output;
+  PDP8_ImageFree(&image);
+  PDP8_GdbInit(stub, pdp8);
+
+  int listener = socket_name ? PDP8_GdbListenUnix(socket_name) : PDP8_GdbListenTcp(port);
+  if (listener < 0) {
+    perror(socket_name ? socket_name : "listen");
+    return 1;
+  }
+  if (socket_name) fprintf(stderr, "listening on %s\n", socket_name);
+  else fprintf(stderr, "listening on localhost:%u\n", port);
+
+  // one debugger at a time, until one kills the target
+  int end = PDP8_GDB_DETACHED;
+  while (end != PDP8_GDB_KILLED) {
+    int fd = accept(listener, NULL, NULL);
+    if (fd < 0) {
+      perror("accept");
+      break;
+    }
+    end = PDP8_GdbServe(stub, fd);
+    if (end == PDP8_GDB_ERROR) fprintf(stderr, "connection lost\n");
+  }
+
+  close(listener);
+  if (socket_name) unlink(socket_name);
+  if (output != stdout) fclose(output);
+  free(stub);
+  free(pdp8);
+  return end == PDP8_GDB_KILLED ? 0 : 1;
+}
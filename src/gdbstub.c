@@ -0,0 +1,546 @@
+#include <errno.h>
+#include <poll.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "gdbstub.h"
+
+#define SESSION_OPEN -1                // process() result while the connection lasts
+#define MAX_REPLY    (PDP8_GDB_PACKET_SIZE - 16)
+
+static const char target_xml[] =
+  "<?xml version=\"1.0\"?>\n"
+  "<!DOCTYPE target SYSTEM \"gdb-target.dtd\">\n"
+  "<target version=\"1.0\">\n"
+  "  <feature name=\"org.pdp8.core\">\n"
+  "    <reg name=\"pc\" bitsize=\"16\" type=\"uint16\" regnum=\"0\"/>\n"
+  "    <reg name=\"ac\" bitsize=\"16\" type=\"uint16\"/>\n"
+  "    <reg name=\"l\" bitsize=\"16\" type=\"uint16\"/>\n"
+  "    <reg name=\"mq\" bitsize=\"16\" type=\"uint16\"/>\n"
+  "    <reg name=\"ma\" bitsize=\"16\" type=\"uint16\"/>\n"
+  "    <reg name=\"mb\" bitsize=\"16\" type=\"uint16\"/>\n"
+  "    <reg name=\"ir\" bitsize=\"16\" type=\"uint16\"/>\n"
+  "    <reg name=\"sr\" bitsize=\"16\" type=\"uint16\"/>\n"
+  "    <reg name=\"if\" bitsize=\"16\" type=\"uint16\"/>\n"
+  "    <reg name=\"df\" bitsize=\"16\" type=\"uint16\"/>\n"
+  "  </feature>\n"
+  "</target>\n";
+
+static int listen_on(int fd, const struct sockaddr *address, socklen_t length) {
+  if (bind(fd, address, length) < 0 || listen(fd, 1) < 0) {
+    int error = errno;
+    close(fd);
+    errno = error;
+    return -1;
+  }
+  return fd;
+}
+
+int PDP8_GdbListenUnix(const char *path) {
+  struct sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  if (strlen(path) >= sizeof(address.sun_path)) {
+    errno = ENAMETOOLONG;
+    return -1;
+  }
+  address.sun_family = AF_UNIX;
+  strcpy(address.sun_path, path);
+
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) return -1;
+  unlink(path);
+  return listen_on(fd, (const struct sockaddr *)&address, sizeof(address));
+}
+
+int PDP8_GdbListenTcp(uint port) {
+  struct sockaddr_in address;
+  memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_port = htons(port);
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) return -1;
+  int on = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+  return listen_on(fd, (const struct sockaddr *)&address, sizeof(address));
+}
+
+void PDP8_GdbInit(struct PDP8_GdbStub *stub, struct PDP8 *pdp8) {
+  memset(stub, 0, sizeof(*stub));
+  stub->pdp8 = pdp8;
+  stub->fd = -1;
+  stub->breakpoint_pc = PDP8_MEMORY_SIZE;
+  PDP8_BreakpointsInit(&stub->breakpoints);
+  PDP8_WatchpointsInit(&stub->watchpoints);
+}
+
+// Output: replies are framed in place and all go out in one write.
+
+static bool flush(struct PDP8_GdbStub *stub) {
+  size_t sent = 0;
+  while (sent < stub->output_length) {
+    ssize_t n = send(stub->fd, stub->output + sent, stub->output_length - sent, MSG_NOSIGNAL);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) return false;
+    sent += n;
+  }
+  stub->output_length = 0;
+  return true;
+}
+
+static void put(struct PDP8_GdbStub *stub, const char *data, size_t length) {
+  memcpy(stub->output + stub->output_length, data, length);
+  stub->output_length += length;
+}
+
+// Keeps room in output for the longest reply or a resend of it. Output
+// that cannot be sent is dropped; the session ends at the next flush.
+static void make_room(struct PDP8_GdbStub *stub) {
+  if (stub->output_length > sizeof(stub->output) - sizeof(stub->last) - 8 && !flush(stub)) stub->output_length = 0;
+}
+
+static void reply_begin(struct PDP8_GdbStub *stub) {
+  make_room(stub);
+  stub->reply_start = stub->output_length;
+  put(stub, "$", 1);
+}
+
+static void reply_text(struct PDP8_GdbStub *stub, const char *text) {
+  put(stub, text, strlen(text));
+}
+
+static void reply_hex(struct PDP8_GdbStub *stub, uint value, uint bytes) {
+  static const char digits[] = "0123456789abcdef";
+  char text[8];
+  for (uint i = 0; i < bytes; ++i, value >>= 8) {
+    text[2 * i] = digits[(value >> 4) & 0xF];
+    text[2 * i + 1] = digits[value & 0xF];
+  }
+  put(stub, text, 2 * bytes);
+}
+
+static void reply_end(struct PDP8_GdbStub *stub) {
+  uint8_t checksum = 0;
+  for (size_t i = stub->reply_start + 1; i < stub->output_length; ++i) checksum += stub->output[i];
+  put(stub, "#", 1);
+  reply_hex(stub, checksum, 1);
+
+  stub->last_length = stub->output_length - stub->reply_start;
+  memcpy(stub->last, stub->output + stub->reply_start, stub->last_length);
+}
+
+static void reply(struct PDP8_GdbStub *stub, const char *text) {
+  reply_begin(stub);
+  reply_text(stub, text);
+  reply_end(stub);
+}
+
+// Parsing
+
+static int hex_digit(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+static bool parse_hex(const char **text, uint64_t *value) {
+  const char *start = *text;
+  *value = 0;
+  for (int digit; (digit = hex_digit(**text)) >= 0; ++*text) *value = (*value << 4) | digit;
+  return *text != start;
+}
+
+static bool expect(const char **text, char c) {
+  if (**text != c) return false;
+  ++*text;
+  return true;
+}
+
+// Little endian value of bytes bytes of hex text.
+static bool parse_bytes(const char **text, uint bytes, uint *value) {
+  *value = 0;
+  for (uint i = 0; i < bytes; ++i) {
+    int high = hex_digit((*text)[0]), low = high < 0 ? -1 : hex_digit((*text)[1]);
+    if (low < 0) return false;
+    *value |= (uint)(high << 4 | low) << (8 * i);
+    *text += 2;
+  }
+  return true;
+}
+
+// Registers and memory
+
+static uint get_register(const struct PDP8 *pdp8, uint n) {
+  switch (n) {
+    case PDP8_GDB_PC: return pdp8->pc;
+    case PDP8_GDB_AC: return pdp8->ac;
+    case PDP8_GDB_L:  return pdp8->link;
+    case PDP8_GDB_MQ: return pdp8->mq;
+    case PDP8_GDB_MA: return pdp8->ma;
+    case PDP8_GDB_MB: return pdp8->mb;
+    case PDP8_GDB_IR: return pdp8->ir;
+    case PDP8_GDB_SR: return pdp8->switches;
+  }
+  return 0;
+}
+
+static void set_register(struct PDP8 *pdp8, uint n, uint value) {
+  switch (n) {
+    case PDP8_GDB_PC: pdp8->pc = value; break;
+    case PDP8_GDB_AC: pdp8->ac = value; break;
+    case PDP8_GDB_L:  pdp8->link = value; break;
+    case PDP8_GDB_MQ: pdp8->mq = value; break;
+    case PDP8_GDB_MA: pdp8->ma = value; break;
+    case PDP8_GDB_MB: pdp8->mb = value; break;
+    case PDP8_GDB_IR: pdp8->ir = value; break;
+    case PDP8_GDB_SR: pdp8->switches = value; break;
+  }
+}
+
+static void read_registers(struct PDP8_GdbStub *stub) {
+  reply_begin(stub);
+  for (uint n = 0; n < PDP8_GDB_REGISTER_COUNT; ++n) reply_hex(stub, get_register(stub->pdp8, n), 2);
+  reply_end(stub);
+}
+
+static void write_registers(struct PDP8_GdbStub *stub, const char *text) {
+  uint values[PDP8_GDB_REGISTER_COUNT];
+  for (uint n = 0; n < PDP8_GDB_REGISTER_COUNT; ++n) {
+    if (!parse_bytes(&text, 2, &values[n])) {
+      reply(stub, "E01");
+      return;
+    }
+  }
+  for (uint n = 0; n < PDP8_GDB_REGISTER_COUNT; ++n) set_register(stub->pdp8, n, values[n]);
+  reply(stub, "OK");
+}
+
+static void read_register(struct PDP8_GdbStub *stub, const char *text) {
+  uint64_t n;
+  if (!parse_hex(&text, &n) || n >= PDP8_GDB_REGISTER_COUNT) {
+    reply(stub, "E01");
+    return;
+  }
+  reply_begin(stub);
+  reply_hex(stub, get_register(stub->pdp8, n), 2);
+  reply_end(stub);
+}
+
+static void write_register(struct PDP8_GdbStub *stub, const char *text) {
+  uint64_t n;
+  uint value;
+  if (!parse_hex(&text, &n) || n >= PDP8_GDB_REGISTER_COUNT || !expect(&text, '=') ||
+      !parse_bytes(&text, 2, &value)) {
+    reply(stub, "E01");
+    return;
+  }
+  set_register(stub->pdp8, n, value);
+  reply(stub, "OK");
+}
+
+// Byte range of whole words inside the one field there is.
+static bool parse_range(const char **text, uint *first, uint *count) {
+  uint64_t address, length;
+  if (!parse_hex(text, &address) || !expect(text, ',') || !parse_hex(text, &length)) return false;
+  if ((address | length) & 1 || address + length > 2 * PDP8_MEMORY_SIZE) return false;
+  *first = address / 2;
+  *count = length / 2;
+  return true;
+}
+
+static void read_memory(struct PDP8_GdbStub *stub, const char *text) {
+  uint first, count;
+  if (!parse_range(&text, &first, &count)) {
+    reply(stub, "E01");
+    return;
+  }
+  if (4 * count > MAX_REPLY) count = MAX_REPLY / 4;
+
+  reply_begin(stub);
+  for (uint i = 0; i < count; ++i) reply_hex(stub, stub->pdp8->memory[first + i], 2);
+  reply_end(stub);
+}
+
+static void write_memory(struct PDP8_GdbStub *stub, const char *text) {
+  uint first, count;
+  if (!parse_range(&text, &first, &count) || !expect(&text, ':')) {
+    reply(stub, "E01");
+    return;
+  }
+
+  uint values[PDP8_MEMORY_SIZE];
+  for (uint i = 0; i < count; ++i) {
+    if (!parse_bytes(&text, 2, &values[i])) {
+      reply(stub, "E01");
+      return;
+    }
+  }
+  for (uint i = 0; i < count; ++i) stub->pdp8->memory[first + i] = values[i] & PDP8_WORD_MASK;
+  reply(stub, "OK");
+}
+
+// Z0/Z1 breakpoints and Z2-Z4 write, read and access watchpoints.
+static void change_point(struct PDP8_GdbStub *stub, const char *text, bool insert) {
+  static const uint access[] = { 0, 0, PDP8_WATCH_WRITE, PDP8_WATCH_READ, PDP8_WATCH_ACCESS };
+  uint64_t type, address, length;
+  if (!parse_hex(&text, &type) || type > 4 || !expect(&text, ',') || !parse_hex(&text, &address) ||
+      !expect(&text, ',') || !parse_hex(&text, &length) || address >= 2 * PDP8_MEMORY_SIZE) {
+    reply(stub, "E01");
+    return;
+  }
+
+  uint word = address / 2;
+  if (type <= 1) {
+    if (insert) {
+      struct PDP8_Breakpoint breakpoint;
+      PDP8_BreakpointInit(&breakpoint, word);
+      if (!PDP8_BreakpointSet(&stub->breakpoints, &breakpoint)) {
+        reply(stub, "E02");
+        return;
+      }
+    } else if (!PDP8_BreakpointClear(&stub->breakpoints, PDP8_BreakpointFind(&stub->breakpoints, word))) {
+      reply(stub, "E01");
+      return;
+    }
+    reply(stub, "OK");
+    return;
+  }
+
+  uint last = length ? (address + length - 1) / 2 : word;
+  for (uint i = word; i <= last && i < PDP8_MEMORY_SIZE; ++i) {
+    if (insert) PDP8_WatchpointSet(&stub->watchpoints, i, access[type]);
+    else PDP8_WatchpointClear(&stub->watchpoints, i, access[type]);
+  }
+  PDP8_WatchpointsAttach(stub->pdp8, &stub->watchpoints);
+  reply(stub, "OK");
+}
+
+// Running
+
+static void stop_reply(struct PDP8_GdbStub *stub, int stop) {
+  const struct PDP8_Watchpoints *watchpoints = &stub->watchpoints;
+  if (stub->interrupted) {
+    reply(stub, "T02");
+    return;
+  }
+  if (stop == PDP8_STOP_BREAKPOINT) {
+    reply(stub, "T05swbreak:;");
+    return;
+  }
+  if (stop != PDP8_STOP_WATCHPOINT) {
+    reply(stub, "T05");
+    return;
+  }
+
+  const char *kind = "watch";
+  if (watchpoints->watch[watchpoints->address] == PDP8_WATCH_ACCESS) kind = "awatch";
+  else if (watchpoints->access == PDP8_WATCH_READ) kind = "rwatch";
+
+  char text[32];
+  snprintf(text, sizeof(text), "T05%s:%x;", kind, 2 * watchpoints->address);
+  reply(stub, text);
+}
+
+// Takes in whatever the debugger sent while the machine runs; the only
+// thing it may send then is an interrupt.
+static bool poll_interrupt(struct PDP8_GdbStub *stub) {
+  struct pollfd poll_fd = { stub->fd, POLLIN, 0 };
+  if (poll(&poll_fd, 1, 0) <= 0) return true;
+
+  char data[256];
+  ssize_t n = recv(stub->fd, data, sizeof(data), 0);
+  if (n <= 0) return n < 0 && errno == EINTR;
+  for (ssize_t i = 0; i < n; ++i) {
+    if (data[i] == 0x03) stub->interrupted = true;
+    else if (stub->input_length < sizeof(stub->input)) stub->input[stub->input_length++] = data[i];
+  }
+  return true;
+}
+
+// Continue or step, as the front panel CONT key would: a halted machine
+// resumes after its HLT.
+static int resume(struct PDP8_GdbStub *stub, const char *text, bool step) {
+  struct PDP8 *pdp8 = stub->pdp8;
+  uint64_t address;
+  if (parse_hex(&text, &address)) pdp8->pc = (address / 2) & PDP8_WORD_MASK;
+  if (!flush(stub)) return PDP8_GDB_ERROR;
+
+  pdp8->run = true;
+  stub->interrupted = false;
+  uint64_t executed;
+  uint hit;
+  int stop;
+  if (step) {
+    stop = PDP8_BreakpointRun(pdp8, NULL, 1, false, &executed, &hit);
+  } else {
+    // only the breakpoint the machine stopped at is passed over
+    bool resuming = pdp8->pc == stub->breakpoint_pc;
+    for (;;) {
+      stop = PDP8_BreakpointRun(pdp8, &stub->breakpoints, PDP8_GDB_RUN_CHUNK, resuming, &executed, &hit);
+      if (stop != PDP8_STOP_BUDGET) break;
+      if (!poll_interrupt(stub)) return PDP8_GDB_DETACHED;
+      if (stub->interrupted) break;
+      resuming = false;
+    }
+  }
+  stub->breakpoint_pc = PDP8_MEMORY_SIZE;
+  if (stop == PDP8_STOP_BREAKPOINT && !stub->interrupted) stub->breakpoint_pc = pdp8->pc;
+  stop_reply(stub, stop);
+  return SESSION_OPEN;
+}
+
+static void query(struct PDP8_GdbStub *stub, const char *text) {
+  static const char features[] = "qXfer:features:read:target.xml:";
+  if (!strncmp(text, "qSupported", 10)) {
+    char supported[128];
+    snprintf(supported, sizeof(supported), "PacketSize=%x;qXfer:features:read+;QStartNoAckMode+;swbreak+;hwbreak+",
+             PDP8_GDB_PACKET_SIZE);
+    reply(stub, supported);
+  } else if (!strcmp(text, "qAttached")) {
+    reply(stub, "1");
+  } else if (!strcmp(text, "qC")) {
+    reply(stub, "QC1");
+  } else if (!strcmp(text, "qfThreadInfo")) {
+    reply(stub, "m1");
+  } else if (!strcmp(text, "qsThreadInfo")) {
+    reply(stub, "l");
+  } else if (!strncmp(text, features, sizeof(features) - 1)) {
+    uint64_t offset, length;
+    text += sizeof(features) - 1;
+    if (!parse_hex(&text, &offset) || !expect(&text, ',') || !parse_hex(&text, &length)) {
+      reply(stub, "E01");
+      return;
+    }
+
+    size_t size = sizeof(target_xml) - 1;
+    if (offset > size) offset = size;
+    if (length > MAX_REPLY) length = MAX_REPLY;
+    if (length > size - offset) length = size - offset;
+    reply_begin(stub);
+    put(stub, offset + length < size ? "m" : "l", 1);
+    put(stub, target_xml + offset, length);
+    reply_end(stub);
+  } else {
+    reply(stub, "");
+  }
+}
+
+// Handles one packet; text is its NUL-terminated payload.
+static int packet(struct PDP8_GdbStub *stub, const char *text) {
+  switch (text[0]) {
+    case '?': reply(stub, "S05"); break;
+    case 'g': read_registers(stub); break;
+    case 'G': write_registers(stub, text + 1); break;
+    case 'p': read_register(stub, text + 1); break;
+    case 'P': write_register(stub, text + 1); break;
+    case 'm': read_memory(stub, text + 1); break;
+    case 'M': write_memory(stub, text + 1); break;
+    case 'Z': change_point(stub, text + 1, true); break;
+    case 'z': change_point(stub, text + 1, false); break;
+    case 'c': return resume(stub, text + 1, false);
+    case 's': return resume(stub, text + 1, true);
+    case 'H': reply(stub, "OK"); break;
+    case 'T': reply(stub, "OK"); break;
+    case 'q': query(stub, text); break;
+    case 'k': return PDP8_GDB_KILLED;
+    case 'D':
+      reply(stub, "OK");
+      return PDP8_GDB_DETACHED;
+    case 'Q':
+      if (!strcmp(text, "QStartNoAckMode")) {
+        reply(stub, "OK");
+        stub->no_ack = true;
+      } else {
+        reply(stub, "");
+      }
+      break;
+    case 'v':
+      if (!strcmp(text, "vKill;1")) {
+        reply(stub, "OK");
+        return PDP8_GDB_KILLED;
+      }
+      reply(stub, "");
+      break;
+    default: reply(stub, ""); break;
+  }
+  return SESSION_OPEN;
+}
+
+// Handles every complete packet in the input buffer.
+static int process(struct PDP8_GdbStub *stub) {
+  size_t i = 0;
+  int end = SESSION_OPEN;
+  while (end == SESSION_OPEN && i < stub->input_length) {
+    char c = stub->input[i];
+    make_room(stub);
+    if (c == '-' && stub->last_length) put(stub, stub->last, stub->last_length);
+    if (c != '$') {
+      i++;
+      continue;
+    }
+
+    char *hash = (char *)memchr(stub->input + i, '#', stub->input_length - i);
+    if (!hash || hash + 2 >= stub->input + stub->input_length) break;
+
+    uint8_t sum = 0;
+    for (char *p = stub->input + i + 1; p < hash; ++p) sum += *p;
+    const char *checksum = hash + 1;
+    uint expected;
+    size_t next = hash + 3 - stub->input;
+    if (!parse_bytes(&checksum, 1, &expected) || expected != sum) {
+      if (!stub->no_ack) put(stub, "-", 1);
+      i = next;
+      continue;
+    }
+
+    if (!stub->no_ack) put(stub, "+", 1);
+    *hash = 0;
+    end = packet(stub, stub->input + i + 1);
+    i = next;
+  }
+
+  memmove(stub->input, stub->input + i, stub->input_length - i);
+  stub->input_length -= i;
+
+  // a packet longer than the buffer can never complete
+  if (stub->input_length == sizeof(stub->input)) {
+    stub->input_length = 0;
+    if (!stub->no_ack) put(stub, "-", 1);
+  }
+  return end;
+}
+
+int PDP8_GdbServe(struct PDP8_GdbStub *stub, int fd) {
+  stub->fd = fd;
+  stub->no_ack = false;
+  stub->input_length = 0;
+  stub->output_length = 0;
+  stub->last_length = 0;
+  PDP8_WatchpointsAttach(stub->pdp8, &stub->watchpoints);
+
+  int end = SESSION_OPEN;
+  while (end == SESSION_OPEN) {
+    end = process(stub);
+    if (!flush(stub)) end = PDP8_GDB_ERROR;
+    if (end != SESSION_OPEN) break;
+
+    ssize_t n = recv(fd, stub->input + stub->input_length, sizeof(stub->input) - stub->input_length, 0);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) end = n == 0 ? PDP8_GDB_DETACHED : PDP8_GDB_ERROR;
+    else stub->input_length += n;
+  }
+
+  close(fd);
+  stub->fd = -1;
+  return end;
+}
@@ -0,0 +1,71 @@
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+#ifndef PDP8_GDBSTUB_H
+#define PDP8_GDBSTUB_H
+
+#include <stddef.h>
+
+#include "pdp8.h"
+#include "breakpoint.h"
+#include "watchpoint.h"
+
+#define PDP8_GDB_PACKET_SIZE 0x8000    // largest packet accepted, advertised to the debugger
+#define PDP8_GDB_RUN_CHUNK   1000000   // instructions between checks for an interrupt
+
+  // Registers as the debugger numbers them, each 16 bits little endian.
+  // There is a single memory field, so IF and DF read as 0.
+  enum PDP8_GdbRegister {
+    PDP8_GDB_PC, PDP8_GDB_AC, PDP8_GDB_L, PDP8_GDB_MQ,
+    PDP8_GDB_MA, PDP8_GDB_MB, PDP8_GDB_IR, PDP8_GDB_SR,
+    PDP8_GDB_IF, PDP8_GDB_DF,
+    PDP8_GDB_REGISTER_COUNT,
+  };
+
+  enum PDP8_GdbEnd {
+    PDP8_GDB_DETACHED,                 // debugger detached or hung up
+    PDP8_GDB_KILLED,                   // debugger asked to end the emulator
+    PDP8_GDB_ERROR,                    // connection failed
+  };
+
+  // Remote serial protocol server for one machine. Memory is addressed in
+  // bytes, two per 12 bit word, little endian: word w of field f is at
+  // byte 2 * (f * 4096 + w). Every complete packet already received is
+  // answered before the replies go out in a single write, so a debugger
+  // pipelining requests, or dumping a field in PDP8_GDB_PACKET_SIZE
+  // chunks, does not pay a round trip per word.
+  struct PDP8_GdbStub {
+    struct PDP8 *pdp8;
+    struct PDP8_Breakpoints breakpoints;
+    struct PDP8_Watchpoints watchpoints;
+
+    int fd;
+    bool no_ack;
+    bool interrupted;                  //  Ctrl-C seen while running
+    uint breakpoint_pc;                //  PC of the last breakpoint stop, else PDP8_MEMORY_SIZE
+    size_t input_length;
+    size_t output_length;
+    size_t reply_start;                //  of the reply being built in output
+    size_t last_length;
+    char input[2 * PDP8_GDB_PACKET_SIZE];
+    char output[4 * PDP8_GDB_PACKET_SIZE];
+    char last[PDP8_GDB_PACKET_SIZE + 4]; //  last reply, resent on a NAK
+  };
+
+  // Listening sockets: a Unix-domain socket at path, or TCP on localhost.
+  // Return -1 with errno set on failure.
+  extern int PDP8_GdbListenUnix(const char *path);
+  extern int PDP8_GdbListenTcp(uint port);
+
+  // The stub keeps its breakpoints and watchpoints across connections.
+  extern void PDP8_GdbInit(struct PDP8_GdbStub *stub, struct PDP8 *pdp8);
+
+  // Serves one connection until it ends; returns a PDP8_GdbEnd.
+  extern int PDP8_GdbServe(struct PDP8_GdbStub *stub, int fd);
+
+#endif //PDP8_GDBSTUB_H
+
+#if defined (__cplusplus)
+}
+#endif
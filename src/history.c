@@ -0,0 +1,254 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "history.h"
+#include "loader.h"
+
+// Instrumentation and host hooks are not part of the machine state; they
+// stay with the live machine and are detached while re-executing.
+struct hooks {
+  struct PDP8_Profile *profile;
+  struct PDP8_Stats *stats;
+  struct PDP8_Lamps *lamps;
+  struct PDP8_Watchpoints *watchpoints;
+  uint32_t watch_pages;
+  void (*print)(void *context, uint c);
+  void *print_context;
+};
+
+static struct hooks detach(struct PDP8 *pdp8) {
+  struct hooks hooks = { pdp8->profile, pdp8->stats, pdp8->lamps, pdp8->watchpoints, pdp8->watch_pages,
+                         pdp8->print, pdp8->print_context };
+  pdp8->profile = NULL;
+  pdp8->stats = NULL;
+  pdp8->lamps = NULL;
+  pdp8->watchpoints = NULL;
+  pdp8->watch_pages = 0;
+  pdp8->print = NULL;
+  pdp8->print_context = NULL;
+  return hooks;
+}
+
+static void attach(struct PDP8 *pdp8, struct hooks hooks) {
+  pdp8->profile = hooks.profile;
+  pdp8->stats = hooks.stats;
+  pdp8->lamps = hooks.lamps;
+  pdp8->watchpoints = hooks.watchpoints;
+  pdp8->watch_pages = hooks.watch_pages;
+  pdp8->print = hooks.print;
+  pdp8->print_context = hooks.print_context;
+}
+
+static void capture(struct PDP8_Snapshot *snapshot, const struct PDP8_History *history, const struct PDP8 *pdp8) {
+  snapshot->instructions = history->instructions;
+  snapshot->event = history->next;
+  snapshot->state = *pdp8;
+  detach(&snapshot->state);
+}
+
+static struct PDP8_Snapshot *recent(const struct PDP8_History *history, uint i) {
+  return &history->recent[(history->recent_first + i) % PDP8_HISTORY_RECENT];
+}
+
+static const struct PDP8_Snapshot *newest(const struct PDP8_History *history) {
+  if (history->recent_count) return recent(history, history->recent_count - 1);
+  return &history->archive[history->archive_count - 1];
+}
+
+static uint64_t newest_archived(const struct PDP8_History *history) {
+  return history->archive[history->archive_count - 1].instructions;
+}
+
+// Keeps a snapshot leaving the recent ring if it is far enough from the
+// newest archived one; a full archive drops every other snapshot but the
+// first.
+static void archive(struct PDP8_History *history, const struct PDP8_Snapshot *snapshot) {
+  if (snapshot->instructions < newest_archived(history) + history->archive_interval) return;
+
+  if (history->archive_count == PDP8_HISTORY_ARCHIVE) {
+    uint kept = 1;
+    for (uint i = 2; i < history->archive_count; i += 2) {
+      history->archive[kept++] = history->archive[i];
+    }
+    history->archive_count = kept;
+    history->archive_interval *= 2;
+    if (snapshot->instructions < newest_archived(history) + history->archive_interval) return;
+  }
+  history->archive[history->archive_count++] = *snapshot;
+}
+
+static void take_snapshot(struct PDP8_History *history, const struct PDP8 *pdp8) {
+  if (history->recent_count == PDP8_HISTORY_RECENT) {
+    archive(history, recent(history, 0));
+    history->recent_first = (history->recent_first + 1) % PDP8_HISTORY_RECENT;
+    history->recent_count--;
+  }
+  capture(recent(history, history->recent_count++), history, pdp8);
+}
+
+int PDP8_HistoryInit(struct PDP8_History *history, const struct PDP8 *pdp8) {
+  memset(history, 0, sizeof(*history));
+  history->recent = (struct PDP8_Snapshot *)malloc(PDP8_HISTORY_RECENT * sizeof(struct PDP8_Snapshot));
+  history->archive = (struct PDP8_Snapshot *)malloc(PDP8_HISTORY_ARCHIVE * sizeof(struct PDP8_Snapshot));
+  if (!history->recent || !history->archive) {
+    PDP8_HistoryFree(history);
+    return PDP8_ERROR_MEMORY;
+  }
+
+  PDP8_InputLogInit(&history->log, pdp8);
+  history->archive_interval = PDP8_HISTORY_INTERVAL;
+  capture(&history->archive[history->archive_count++], history, pdp8);
+  return PDP8_OK;
+}
+
+void PDP8_HistoryFree(struct PDP8_History *history) {
+  PDP8_InputLogFree(&history->log);
+  free(history->recent);
+  free(history->archive);
+  memset(history, 0, sizeof(*history));
+}
+
+// The replayable future ends here.
+static void diverge(struct PDP8_History *history) {
+  history->log.count = history->next;
+}
+
+// Forward execution without snapshots beyond the caller's, replaying any
+// logged input still ahead; a recording's end marker is passed over.
+static int replay(struct PDP8_History *history, struct PDP8 *pdp8, uint64_t budget, uint64_t *executed) {
+  if (history->next == history->log.count) return PDP8_RunFor(pdp8, budget, executed);
+
+  struct PDP8_Replay replay = { &history->log, history->next };
+  uint64_t count = 0;
+  int stop;
+  do {
+    uint64_t ran;
+    stop = PDP8_ReplayRun(pdp8, &replay, budget - count, &ran);
+    count += ran;
+  } while (stop == PDP8_STOP_END);
+  history->next = replay.next;
+
+  *executed = count;
+  return stop;
+}
+
+int PDP8_HistoryRun(struct PDP8_History *history, struct PDP8 *pdp8, uint64_t budget, uint64_t *executed) {
+  uint64_t count = 0;
+  int stop = PDP8_STOP_BUDGET;
+
+  while (count < budget) {
+    uint64_t limit = budget - count;
+    uint64_t due = newest(history)->instructions + PDP8_HISTORY_INTERVAL - history->instructions;
+    if (due < limit) limit = due;
+
+    uint64_t ran;
+    stop = replay(history, pdp8, limit, &ran);
+    count += ran;
+    history->instructions += ran;
+    if (ran == due) take_snapshot(history, pdp8);
+    if (stop == PDP8_STOP_HALT) break;
+  }
+
+  *executed = count;
+  return stop;
+}
+
+int PDP8_HistoryInput(struct PDP8_History *history, struct PDP8 *pdp8, uint kind, uint value) {
+  diverge(history);
+  int status = PDP8_Input(pdp8, &history->log, kind, value);
+  history->next = history->log.count;
+  return status;
+}
+
+void PDP8_HistoryAdvance(struct PDP8_History *history, const struct PDP8 *pdp8, uint64_t executed) {
+  diverge(history);
+  history->instructions += executed;
+  if (history->instructions >= newest(history)->instructions + PDP8_HISTORY_INTERVAL) {
+    take_snapshot(history, pdp8);
+  }
+}
+
+// Latest snapshot at or before instructions; there always is one at 0.
+static const struct PDP8_Snapshot *find(const struct PDP8_History *history, uint64_t instructions) {
+  for (uint i = history->recent_count; i-- > 0;) {
+    if (recent(history, i)->instructions <= instructions) return recent(history, i);
+  }
+  for (uint i = history->archive_count; i-- > 1;) {
+    if (history->archive[i].instructions <= instructions) return &history->archive[i];
+  }
+  return &history->archive[0];
+}
+
+uint64_t PDP8_HistorySeek(struct PDP8_History *history, struct PDP8 *pdp8, uint64_t instructions) {
+  uint64_t executed;
+  if (instructions >= history->instructions) {
+    PDP8_HistoryRun(history, pdp8, instructions - history->instructions, &executed);
+    return history->instructions;
+  }
+
+  const struct PDP8_Snapshot *snapshot = find(history, instructions);
+  struct hooks hooks = detach(pdp8);
+  *pdp8 = snapshot->state;
+  history->instructions = snapshot->instructions;
+  history->next = snapshot->event;
+
+  // later snapshots are rebuilt on the way forward again
+  while (history->recent_count && newest(history)->instructions > snapshot->instructions) {
+    history->recent_count--;
+  }
+  while (history->archive_count > 1 && newest_archived(history) > snapshot->instructions) {
+    history->archive_count--;
+  }
+
+  PDP8_HistoryRun(history, pdp8, instructions - history->instructions, &executed);
+  attach(pdp8, hooks);
+  return history->instructions;
+}
+
+uint64_t PDP8_HistoryBack(struct PDP8_History *history, struct PDP8 *pdp8, uint64_t count) {
+  uint64_t instructions = count < history->instructions ? history->instructions - count : 0;
+  return PDP8_HistorySeek(history, pdp8, instructions);
+}
+
+// Re-executes one instruction at a time from a snapshot up to end and
+// returns the last position where condition held, or end if none.
+static uint64_t scan(const struct PDP8_History *history, const struct PDP8_Snapshot *snapshot, uint64_t end,
+                     PDP8_HistoryCondition condition, void *context, struct PDP8 *scratch) {
+  const struct PDP8_InputLog *log = &history->log;
+  uint next = snapshot->event;
+  uint64_t found = end;
+
+  *scratch = snapshot->state;
+  for (uint64_t position = snapshot->instructions; position < end; ++position) {
+    if (condition(scratch, context)) found = position;
+    while (next < log->count && log->events[next].cycle <= scratch->cycles) {
+      const struct PDP8_InputEvent *event = &log->events[next++];
+      if (event->kind != PDP8_INPUT_END) PDP8_ApplyInput(scratch, event->kind, event->value);
+    }
+    PDP8_Step(scratch);
+  }
+  return found;
+}
+
+bool PDP8_HistoryReverse(struct PDP8_History *history, struct PDP8 *pdp8,
+                         PDP8_HistoryCondition condition, void *context) {
+  struct PDP8 *scratch = (struct PDP8 *)malloc(sizeof(struct PDP8));
+  if (!scratch) return false;
+
+  // newest segment first, so the first hit is the latest one
+  uint64_t end = history->instructions;
+  uint64_t found = 0;
+  bool hit = false;
+  while (end > 0 && !hit) {
+    const struct PDP8_Snapshot *snapshot = find(history, end - 1);
+    found = scan(history, snapshot, end, condition, context, scratch);
+    hit = found < end;
+    end = snapshot->instructions;
+  }
+  free(scratch);
+
+  PDP8_HistorySeek(history, pdp8, hit ? found : 0);
+  return hit;
+}
@@ -0,0 +1,67 @@
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+#ifndef PDP8_HISTORY_H
+#define PDP8_HISTORY_H
+
+#include "pdp8.h"
+#include "replay.h"
+
+#define PDP8_HISTORY_INTERVAL 65536    // instructions between recent snapshots
+#define PDP8_HISTORY_RECENT   64       // recent snapshots, PDP8_HISTORY_INTERVAL apart
+#define PDP8_HISTORY_ARCHIVE  64       // older snapshots, thinned as the run grows
+
+  // Machine state after instructions instructions, with the instrumentation
+  // pointers cleared.
+  struct PDP8_Snapshot {
+    uint64_t instructions;
+    uint event;                        //  log events applied before it
+    struct PDP8 state;
+  };
+
+  // Time travel: going back restores the nearest earlier snapshot and
+  // re-executes from there, replaying the logged input. Recent snapshots
+  // keep a step back to at most PDP8_HISTORY_INTERVAL instructions; the
+  // archive halves its density whenever it fills, so it spans any run.
+  struct PDP8_History {
+    struct PDP8_InputLog log;
+    uint64_t instructions;             //  current position
+    uint next;                         //  next event to replay; behind log.count after going back
+    uint64_t archive_interval;
+    struct PDP8_Snapshot *recent;      //  ring, oldest at recent_first
+    uint recent_first;
+    uint recent_count;
+    struct PDP8_Snapshot *archive;     //  oldest first, always starting at instruction 0
+    uint archive_count;
+  };
+
+  // Evaluated at instruction boundaries, before the instruction at PC.
+  typedef bool (*PDP8_HistoryCondition)(const struct PDP8 *pdp8, void *context);
+
+  // Starts the history at the current state of pdp8.
+  extern int  PDP8_HistoryInit(struct PDP8_History *history, const struct PDP8 *pdp8);
+  extern void PDP8_HistoryFree(struct PDP8_History *history);
+
+  // Running forward replays input logged past the current position, if any.
+  // New input, or instructions the caller executed itself, discard it.
+  extern int  PDP8_HistoryRun(struct PDP8_History *history, struct PDP8 *pdp8, uint64_t budget, uint64_t *executed);
+  extern int  PDP8_HistoryInput(struct PDP8_History *history, struct PDP8 *pdp8, uint kind, uint value);
+  extern void PDP8_HistoryAdvance(struct PDP8_History *history, const struct PDP8 *pdp8, uint64_t executed);
+
+  // Moves to a position, re-executing from the nearest earlier snapshot or
+  // running forward; returns the position reached, which is short of a
+  // later one if the machine halts first.
+  extern uint64_t PDP8_HistorySeek(struct PDP8_History *history, struct PDP8 *pdp8, uint64_t instructions);
+  extern uint64_t PDP8_HistoryBack(struct PDP8_History *history, struct PDP8 *pdp8, uint64_t count);
+
+  // Reverse continue: moves to the last earlier position where condition
+  // holds, or to instruction 0 when there is none.
+  extern bool PDP8_HistoryReverse(struct PDP8_History *history, struct PDP8 *pdp8,
+                                  PDP8_HistoryCondition condition, void *context);
+
+#endif //PDP8_HISTORY_H
+
+#if defined (__cplusplus)
+}
+#endif
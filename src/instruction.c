@@ -0,0 +1,86 @@
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "instruction.h"
+#include "symbols.h"
+
+const struct PDP8_Mnemonic PDP8_Mnemonics[] = {
+  // memory reference instructions
+  { "AND", 00000, PDP8_SYMBOL_MRI },
+  { "TAD", 01000, PDP8_SYMBOL_MRI },
+  { "ISZ", 02000, PDP8_SYMBOL_MRI },
+  { "DCA", 03000, PDP8_SYMBOL_MRI },
+  { "JMS", 04000, PDP8_SYMBOL_MRI },
+  { "JMP", 05000, PDP8_SYMBOL_MRI },
+
+  // address modifiers
+  { "I",   00400, PDP8_SYMBOL_PERMANENT },
+  { "Z",   00000, PDP8_SYMBOL_PERMANENT },
+
+  // processor IOTs
+  { "IOT",  06000, PDP8_SYMBOL_PERMANENT },
+  { "SKON", 06000, PDP8_SYMBOL_PERMANENT },
+  { "ION",  06001, PDP8_SYMBOL_PERMANENT },
+  { "IOF",  06002, PDP8_SYMBOL_PERMANENT },
+  { "SRQ",  06003, PDP8_SYMBOL_PERMANENT },
+  { "GTF",  06004, PDP8_SYMBOL_PERMANENT },
+  { "RTF",  06005, PDP8_SYMBOL_PERMANENT },
+  { "SGT",  06006, PDP8_SYMBOL_PERMANENT },
+  { "CAF",  06007, PDP8_SYMBOL_PERMANENT },
+
+  // keyboard/reader (device 03)
+  { "KCF",  06030, PDP8_SYMBOL_PERMANENT },
+  { "KSF",  06031, PDP8_SYMBOL_PERMANENT },
+  { "KCC",  06032, PDP8_SYMBOL_PERMANENT },
+  { "KRS",  06034, PDP8_SYMBOL_PERMANENT },
+  { "KIE",  06035, PDP8_SYMBOL_PERMANENT },
+  { "KRB",  06036, PDP8_SYMBOL_PERMANENT },
+
+  // teleprinter/punch (device 04)
+  { "TFL",  06040, PDP8_SYMBOL_PERMANENT },
+  { "TSF",  06041, PDP8_SYMBOL_PERMANENT },
+  { "TCF",  06042, PDP8_SYMBOL_PERMANENT },
+  { "TPC",  06044, PDP8_SYMBOL_PERMANENT },
+  { "TSK",  06045, PDP8_SYMBOL_PERMANENT },
+  { "TLS",  06046, PDP8_SYMBOL_PERMANENT },
+
+  // group 1 operate microinstructions
+  { "OPR",  07000, PDP8_SYMBOL_PERMANENT },
+  { "NOP",  07000, PDP8_SYMBOL_PERMANENT },
+  { "IAC",  07001, PDP8_SYMBOL_PERMANENT },
+  { "BSW",  07002, PDP8_SYMBOL_PERMANENT },
+  { "RAL",  07004, PDP8_SYMBOL_PERMANENT },
+  { "RTL",  07006, PDP8_SYMBOL_PERMANENT },
+  { "RAR",  07010, PDP8_SYMBOL_PERMANENT },
+  { "RTR",  07012, PDP8_SYMBOL_PERMANENT },
+  { "CML",  07020, PDP8_SYMBOL_PERMANENT },
+  { "CMA",  07040, PDP8_SYMBOL_PERMANENT },
+  { "CIA",  07041, PDP8_SYMBOL_PERMANENT },
+  { "CLL",  07100, PDP8_SYMBOL_PERMANENT },
+  { "STL",  07120, PDP8_SYMBOL_PERMANENT },
+  { "CLA",  07200, PDP8_SYMBOL_PERMANENT },
+  { "GLK",  07204, PDP8_SYMBOL_PERMANENT },
+  { "STA",  07240, PDP8_SYMBOL_PERMANENT },
+
+  // group 2 operate microinstructions
+  { "HLT",  07402, PDP8_SYMBOL_PERMANENT },
+  { "OSR",  07404, PDP8_SYMBOL_PERMANENT },
+  { "SKP",  07410, PDP8_SYMBOL_PERMANENT },
+  { "SNL",  07420, PDP8_SYMBOL_PERMANENT },
+  { "SZL",  07430, PDP8_SYMBOL_PERMANENT },
+  { "SZA",  07440, PDP8_SYMBOL_PERMANENT },
+  { "SNA",  07450, PDP8_SYMBOL_PERMANENT },
+  { "SMA",  07500, PDP8_SYMBOL_PERMANENT },
+  { "SPA",  07510, PDP8_SYMBOL_PERMANENT },
+  { "LAS",  07604, PDP8_SYMBOL_PERMANENT },
+
+  // group 3 operate microinstructions
+  { "MQL",  07421, PDP8_SYMBOL_PERMANENT },
+  { "MQA",  07501, PDP8_SYMBOL_PERMANENT },
+  { "SWP",  07521, PDP8_SYMBOL_PERMANENT },
+  { "CAM",  07621, PDP8_SYMBOL_PERMANENT },
+  { "ACL",  07701, PDP8_SYMBOL_PERMANENT },
+
+};
+
+const uint PDP8_MnemonicCount = sizeof(PDP8_Mnemonics) / sizeof(PDP8_Mnemonics[0]);
@@ -0,0 +1,118 @@
+#ifndef PDP8_INSTRUCTION_H
+#define PDP8_INSTRUCTION_H
+
+// Instruction format shared by the execution engine, the assembler and the
+// disassembler. Bit 0 is the most significant bit of a 12 bit word.
+
+#include "pdp8.h"
+
+#define PDP8_BMASK(b) (1 << (11 - b))
+#define PDP8_MASK(l, h) (((1 << ((h) - (l) + 1)) - 1) << (11 - (h)))
+
+enum INSTRUCTION_FORMAT_MASK {
+  OPCODE       = PDP8_MASK(0, 2),  // op\operation.code<0:2> := i<0:2>
+  INDIRECT_BIT = PDP8_BMASK(3),    // ib\indirect.bit< >     := i<3>
+  PAGE_BIT     = PDP8_BMASK(4),    // pb\page.0.bit  < >     := i<4>
+  PAGE_ADDRESS = PDP8_MASK(5, 11), // pa\page.address<0:6>   := i<5:11>
+  CURRENT_PAGE = PDP8_MASK(0, 4),
+};
+
+enum IO_MASK {
+  IO_SELECT    = PDP8_MASK(3, 8),  // IO.SELECT<0:5>   := i<3:8>   !device select
+  IO_CONTROL   = PDP8_MASK(9, 11), // io.control<0:2>  := i<9:11>  !device operation
+  IO_PULSE_P1  = PDP8_BMASK(11),   //   IO.PULSE.P1< > := io.control<2>  !issued first
+  IO_PULSE_P2  = PDP8_BMASK(10),   //   IO.PULSE.P2< > := io.control<1>
+  IO_PULSE_P4  = PDP8_BMASK(9),    //   IO.PULSE.P4< > := io.control<0>
+  IO_MICROOP   = PDP8_MASK(3, 11),
+};
+
+enum OPR_MASK {
+  OPR_GROUP = PDP8_BMASK(3),  // group< > := i<3>   !microinstruction group
+  OPR_SMA   = PDP8_BMASK(5),  // sma< >   := i<5>   !skip on minus AC
+  OPR_SPA   = PDP8_BMASK(5),  // spa< >   := i<5>   !skip on positive AC
+  OPR_SZA   = PDP8_BMASK(6),  // sza< >   := i<6>   !skip on zero AC
+  OPR_SNA   = PDP8_BMASK(6),  // sna< >   := i<6>   !skip on AC not zero
+  OPR_SZL   = PDP8_BMASK(7),  // szl< >   := i<7>   !skip on zero L
+  OPR_SNL   = PDP8_BMASK(7),  // snl< >   := i<7>   !skip on L not zero
+  OPR_IS    = PDP8_BMASK(8),  // is< >    := i<8>   !invert skip sense
+  
+  OPR_CLA   = PDP8_BMASK(4),  // cla< >   := i<4>   !clear AC
+  OPR_CLL   = PDP8_BMASK(5),  // cll< >   := i<5>   !clear L
+  OPR_CMA   = PDP8_BMASK(6),  // cma< >   := i<6>   !complement AC
+  OPR_CML   = PDP8_BMASK(7),  // cml< >   := i<7>   !complement L
+  OPR_RAR   = PDP8_BMASK(8),  // rar< >   := i<8>   !rotate right
+  OPR_RAL   = PDP8_BMASK(9),  // ral< >   := i<9>   !rotate left
+  OPR_RT    = PDP8_BMASK(10), // rt< >    := i<10>  !rotate twice
+  OPR_IAC   = PDP8_BMASK(11), // iac< >   := i<11>  !increment AC
+  
+  OPR_OSR   = PDP8_BMASK(9),  // osr< >   := i<9>   !logical or AC with SWITCHES
+  
+  OPR_HLT   = PDP8_BMASK(10), // hlt< >   := i<10>  !halt the processor
+  
+  OPR_MQA   = PDP8_BMASK(5),  // mqa< >   := i<5>   !logical or AC with MQ
+  OPR_MQL   = PDP8_BMASK(7),  // mql< >   := i<7>   !load MQ from AC, clear AC
+  OPR_EAE   = PDP8_MASK(6, 10) & ~OPR_MQL, // extended arithmetic element bits
+  OPR_GROUP3 = PDP8_BMASK(11), // group 3 when the group bit is set
+};
+
+enum PDP8_Opcode {
+  PDP8_AND = 0,
+  PDP8_TAD = 1,
+  PDP8_ISZ = 2,
+  PDP8_DCA = 3,
+  PDP8_JMS = 4,
+  PDP8_JMP = 5,
+  PDP8_IOT = 6,
+  PDP8_OPR = 7,
+};
+
+// Instruction word split into its fields.
+struct PDP8_Instruction {
+  uint opcode   : 3;                   // op<0:2>
+  uint indirect : 1;                   // ib< >
+  uint page     : 1;                   // pb< >, set for the current page
+  uint offset   : 7;                   // pa<0:6>
+  uint device   : 6;                   // IO.SELECT<0:5>
+  uint control  : 3;                   // io.control<0:2>
+};
+
+static inline struct PDP8_Instruction PDP8_Decode(uint ir) {
+  struct PDP8_Instruction i;
+  i.opcode   = (ir & OPCODE) >> 9;
+  i.indirect = (ir & INDIRECT_BIT) != 0;
+  i.page     = (ir & PAGE_BIT) != 0;
+  i.offset   = ir & PAGE_ADDRESS;
+  i.device   = (ir & IO_SELECT) >> 3;
+  i.control  = ir & IO_CONTROL;
+  return i;
+}
+
+// Direct address of a memory reference instruction fetched from pc.
+static inline uint PDP8_DirectAddress(uint ir, uint pc) {
+  // page bit * page address + page offset
+  return ((bool)(ir & PAGE_BIT)) * (pc & CURRENT_PAGE) + (ir & PAGE_ADDRESS);
+}
+
+// Whether an indirect reference through eadd first increments the pointer
+// there: the auto-index registers 0010-0017.
+static inline bool PDP8_AutoIndex(uint eadd) {
+  return (eadd & 07770) == 010;
+}
+
+// Effective address of an indirect reference through eadd, given the
+// pointer stored there before the reference.
+static inline uint PDP8_IndirectAddress(uint eadd, uint pointer) {
+  return PDP8_AutoIndex(eadd) ? (pointer + 1) & PDP8_WORD_MASK : pointer;
+}
+
+// Named instruction words, the permanent symbols of PAL.
+struct PDP8_Mnemonic {
+  const char *name;
+  uint value;
+  uint type;                           // PDP8_SymbolType
+};
+
+extern const struct PDP8_Mnemonic PDP8_Mnemonics[];
+extern const uint PDP8_MnemonicCount;
+
+#endif //PDP8_INSTRUCTION_H
@@ -0,0 +1,13 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "lamps.h"
+
+void PDP8_LampsReset(struct PDP8_Lamps *lamps) {
+  memset(lamps, 0, sizeof(*lamps));
+}
+
+void PDP8_LampsAttach(struct PDP8 *pdp8, struct PDP8_Lamps *lamps) {
+  pdp8->lamps = lamps;
+}
@@ -0,0 +1,123 @@
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+#ifndef PDP8_LAMPS_H
+#define PDP8_LAMPS_H
+
+#include "pdp8.h"
+
+#define PDP8_LAMP_BATCH 1024           // instructions buffered between flushes, a multiple of 16
+#define PDP8_LAMP_PLANES 7             // bits of a count of 16 word blocks in a batch
+
+  // Front panel lamps, numbered by bit of the two words recorded per
+  // instruction; registers are least significant bit first.
+  enum PDP8_Lamp {
+    PDP8_LAMP_MA      = 0,             //  12 lamps
+    PDP8_LAMP_MB      = 12,
+    PDP8_LAMP_AC      = 24,
+    PDP8_LAMP_MQ      = 36,
+    PDP8_LAMP_PC      = 48,
+    PDP8_LAMP_LINK    = 60,
+    PDP8_LAMP_ION     = 61,
+    PDP8_LAMP_IR      = 64,            //  8 lamps, AND TAD ISZ DCA JMS JMP IOT OPR
+    PDP8_LAMP_FETCH   = 72,
+    PDP8_LAMP_DEFER   = 73,
+    PDP8_LAMP_EXECUTE = 74,
+    PDP8_LAMP_COUNT   = 128,
+  };
+
+  // How many instructions each lamp was lit after, to show its average
+  // brightness like an incandescent lamp would. The engine only stores
+  // the two lamp words of each instruction; a flush counts every bit
+  // position of a batch at once with a carry-save adder tree over blocks
+  // of 16 words, a few logic operations per word instead of a count per
+  // lamp.
+  struct PDP8_Lamps {
+    uint64_t words[2][PDP8_LAMP_BATCH];
+    uint pending;                      //  instructions in words
+    uint64_t instructions;             //  instructions in the totals
+    uint64_t totals[PDP8_LAMP_COUNT];
+  };
+
+  extern void PDP8_LampsReset(struct PDP8_Lamps *lamps);
+  extern void PDP8_LampsAttach(struct PDP8 *pdp8, struct PDP8_Lamps *lamps);
+
+  static inline void PDP8_LampsCsa(uint64_t *high, uint64_t *low, uint64_t a, uint64_t b, uint64_t c) {
+    uint64_t u = a ^ b;
+    *high = (a & b) | (u & c);
+    *low = u ^ c;
+  }
+
+  static inline void PDP8_LampsFold(uint64_t *totals, uint64_t bits, uint64_t weight) {
+    for (; bits; bits &= bits - 1) totals[__builtin_ctzll(bits)] += weight;
+  }
+
+  // Adds the per bit counts of words, a multiple of 16 up to
+  // PDP8_LAMP_BATCH long, to totals. Each block's sixteens go into
+  // bit-sliced counters, plane p holding bit p of all 64 counts.
+  static inline void PDP8_LampsCountBits(uint64_t *totals, const uint64_t *words, uint count) {
+    uint64_t planes[PDP8_LAMP_PLANES] = { 0 };
+    uint64_t ones = 0, twos = 0, fours = 0, eights = 0;
+    uint64_t twos_a, twos_b, fours_a, fours_b, eights_a, eights_b, sixteens;
+    for (uint i = 0; i < count; i += 16) {
+      const uint64_t *d = &words[i];
+      PDP8_LampsCsa(&twos_a, &ones, ones, d[0], d[1]);
+      PDP8_LampsCsa(&twos_b, &ones, ones, d[2], d[3]);
+      PDP8_LampsCsa(&fours_a, &twos, twos, twos_a, twos_b);
+      PDP8_LampsCsa(&twos_a, &ones, ones, d[4], d[5]);
+      PDP8_LampsCsa(&twos_b, &ones, ones, d[6], d[7]);
+      PDP8_LampsCsa(&fours_b, &twos, twos, twos_a, twos_b);
+      PDP8_LampsCsa(&eights_a, &fours, fours, fours_a, fours_b);
+      PDP8_LampsCsa(&twos_a, &ones, ones, d[8], d[9]);
+      PDP8_LampsCsa(&twos_b, &ones, ones, d[10], d[11]);
+      PDP8_LampsCsa(&fours_a, &twos, twos, twos_a, twos_b);
+      PDP8_LampsCsa(&twos_a, &ones, ones, d[12], d[13]);
+      PDP8_LampsCsa(&twos_b, &ones, ones, d[14], d[15]);
+      PDP8_LampsCsa(&fours_b, &twos, twos, twos_a, twos_b);
+      PDP8_LampsCsa(&eights_b, &fours, fours, fours_a, fours_b);
+      PDP8_LampsCsa(&sixteens, &eights, eights, eights_a, eights_b);
+      for (uint p = 0; p < PDP8_LAMP_PLANES; ++p) {
+        uint64_t carry = planes[p] & sixteens;
+        planes[p] ^= sixteens;
+        sixteens = carry;
+      }
+    }
+    for (uint p = 0; p < PDP8_LAMP_PLANES; ++p) PDP8_LampsFold(totals, planes[p], (uint64_t)16 << p);
+    PDP8_LampsFold(totals, ones, 1);
+    PDP8_LampsFold(totals, twos, 2);
+    PDP8_LampsFold(totals, fours, 4);
+    PDP8_LampsFold(totals, eights, 8);
+  }
+
+  // Folds the buffered instructions into the totals.
+  static inline void PDP8_LampsFlush(struct PDP8_Lamps *lamps) {
+    uint count = (lamps->pending + 15) & ~15u;
+    for (uint word = 0; word < 2; ++word) {
+      // zero words count nothing
+      for (uint i = lamps->pending; i < count; ++i) lamps->words[word][i] = 0;
+      PDP8_LampsCountBits(&lamps->totals[word * 64], lamps->words[word], count);
+    }
+    lamps->instructions += lamps->pending;
+    lamps->pending = 0;
+  }
+
+  // Called by the engine after each instruction.
+  static inline void PDP8_LampsCount(struct PDP8_Lamps *lamps, const struct PDP8 *pdp8) {
+    uint opcode = pdp8->ir >> 9;
+    uint i = lamps->pending;
+    lamps->words[0][i] = (uint64_t)pdp8->ma << PDP8_LAMP_MA | (uint64_t)pdp8->mb << PDP8_LAMP_MB |
+                         (uint64_t)pdp8->ac << PDP8_LAMP_AC | (uint64_t)pdp8->mq << PDP8_LAMP_MQ |
+                         (uint64_t)pdp8->pc << PDP8_LAMP_PC | (uint64_t)pdp8->link << PDP8_LAMP_LINK |
+                         (uint64_t)pdp8->interrupt_enable << PDP8_LAMP_ION;
+    lamps->words[1][i] = 1u << opcode | 1u << (PDP8_LAMP_FETCH - 64) |
+                         (uint64_t)(opcode < 6 && (pdp8->ir & 0400)) << (PDP8_LAMP_DEFER - 64) |
+                         (uint64_t)(opcode < 5) << (PDP8_LAMP_EXECUTE - 64);
+    if (++lamps->pending == PDP8_LAMP_BATCH) PDP8_LampsFlush(lamps);
+  }
+
+#endif //PDP8_LAMPS_H
+
+#if defined (__cplusplus)
+}
+#endif
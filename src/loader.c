@@ -0,0 +1,397 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "loader.h"
+#include "assembler.h"
+
+// Paper tape frame layout, see the PDP-8 Small Computer Handbook:
+//   0200        leader/trailer
+//   11xxxxxx    field setting (BIN only, not part of the checksum)
+//   01xxxxxx    high half of an origin (BIN) or address (RIM) word
+//   00xxxxxx    high half of a data word
+#define TAPE_LEADER  0200
+#define TAPE_FIELD   0300
+#define TAPE_ORIGIN  0100
+#define TAPE_DATA    0077
+
+#define DEFAULT_START 00200
+
+typedef int (*emit_function)(void *context, uint address, uint value);
+
+const char *PDP8_StatusString(int status) {
+  switch (status) {
+    case PDP8_OK:             return "ok";
+    case PDP8_ERROR_OPEN:     return "cannot open file";
+    case PDP8_ERROR_READ:     return "read error";
+    case PDP8_ERROR_FORMAT:   return "invalid image format";
+    case PDP8_ERROR_CHECKSUM: return "checksum mismatch";
+    case PDP8_ERROR_ASSEMBLY: return "assembly failed";
+    case PDP8_ERROR_MEMORY:   return "out of memory";
+    case PDP8_ERROR_WRITE:    return "write error";
+  }
+  return "unknown error";
+}
+
+void PDP8_ImageInit(struct PDP8_Image *image) {
+  memset(image, 0, sizeof(*image));
+  image->start = PDP8_NO_START;
+}
+
+void PDP8_ImageFree(struct PDP8_Image *image) {
+  free(image->segments);
+  free(image->code);
+  free(image->deposits);
+  PDP8_ImageInit(image);
+}
+
+// Makes room for one more element of size bytes in *array.
+static bool grow(void **array, uint *capacity, uint count, size_t size) {
+  if (count < *capacity) return true;
+
+  uint new_capacity = *capacity ? *capacity * 2 : 16;
+  void *new_array = realloc(*array, new_capacity * size);
+  if (!new_array) return false;
+
+  *array = new_array;
+  *capacity = new_capacity;
+  return true;
+}
+
+int PDP8_ImageAppend(struct PDP8_Image *image, uint address, uint value) {
+  address &= PDP8_WORD_MASK;
+
+  struct PDP8_Segment *last = image->segment_count ? &image->segments[image->segment_count - 1] : NULL;
+  if (!last || last->origin + last->length != address) {
+    if (!grow((void **)&image->segments, &image->segment_capacity, image->segment_count, sizeof(struct PDP8_Segment))) {
+      return PDP8_ERROR_MEMORY;
+    }
+    last = &image->segments[image->segment_count++];
+    last->origin = address;
+    last->length = 0;
+    last->offset = image->code_length;
+  }
+
+  if (!grow((void **)&image->code, &image->code_capacity, image->code_length, sizeof(uint))) {
+    return PDP8_ERROR_MEMORY;
+  }
+  image->code[image->code_length++] = value & PDP8_WORD_MASK;
+  last->length++;
+
+  return PDP8_OK;
+}
+
+int PDP8_ImageDeposit(struct PDP8_Image *image, uint address, uint value) {
+  if (!grow((void **)&image->deposits, &image->deposit_capacity, image->deposit_count, sizeof(struct PDP8_Deposit))) {
+    return PDP8_ERROR_MEMORY;
+  }
+
+  struct PDP8_Deposit *deposit = &image->deposits[image->deposit_count++];
+  deposit->address = address & PDP8_WORD_MASK;
+  deposit->value = value & PDP8_WORD_MASK;
+
+  return PDP8_OK;
+}
+
+static int emit_image(void *context, uint address, uint value) {
+  return PDP8_ImageAppend((struct PDP8_Image *)context, address, value);
+}
+
+static int emit_memory(void *context, uint address, uint value) {
+  struct PDP8 *pdp8 = (struct PDP8 *)context;
+  pdp8->memory[address & PDP8_WORD_MASK] = value & PDP8_WORD_MASK;
+  return PDP8_OK;
+}
+
+// Reads the whole file into a newly allocated buffer.
+int PDP8_ReadFile(const char *file_name, unsigned char **buffer, size_t *length) {
+  FILE *file = fopen(file_name, "rb");
+  if (!file) {
+    return PDP8_ERROR_OPEN;
+  }
+
+  int status = PDP8_OK;
+  long size = -1;
+  if (fseek(file, 0, SEEK_END) == 0) size = ftell(file);
+  if (size < 0 || fseek(file, 0, SEEK_SET) != 0) {
+    fclose(file);
+    return PDP8_ERROR_READ;
+  }
+
+  *buffer = (unsigned char *)malloc(size + 1);
+  if (!*buffer) {
+    fclose(file);
+    return PDP8_ERROR_MEMORY;
+  }
+
+  *length = fread(*buffer, 1, size, file);
+  if (ferror(file)) {
+    status = PDP8_ERROR_READ;
+    free(*buffer);
+    *buffer = NULL;
+  }
+  fclose(file);
+
+  return status;
+}
+
+static uint tape_word(const unsigned char *tape, size_t i) {
+  return ((tape[i] & TAPE_DATA) << 6) | (tape[i + 1] & TAPE_DATA);
+}
+
+// BIN format: origin words set the load address, data words are stored at
+// consecutive addresses, and the last data word before the trailer is the
+// 12 bit sum of all preceding origin and data frames.
+static int parse_binary(const unsigned char *tape, size_t length, emit_function emit, void *context) {
+  size_t i = 0;
+  while (i < length && tape[i] == TAPE_LEADER) i++;
+
+  uint address = 0;
+  uint checksum = 0;
+  bool pending = false;
+  uint pending_word = 0;
+  uint pending_sum = 0;
+
+  while (i < length) {
+    unsigned char frame = tape[i];
+    if ((frame & TAPE_FIELD) == TAPE_FIELD) {
+      i++;
+      continue;
+    }
+    if (frame & TAPE_LEADER) break;
+    if (i + 1 >= length) return PDP8_ERROR_FORMAT;
+
+    if (pending) {
+      int status = emit(context, address, pending_word);
+      if (status != PDP8_OK) return status;
+      address = (address + 1) & PDP8_WORD_MASK;
+      checksum += pending_sum;
+      pending = false;
+    }
+
+    uint word = tape_word(tape, i);
+    if (frame & TAPE_ORIGIN) {
+      address = word;
+      checksum += tape[i] + tape[i + 1];
+    } else {
+      pending = true;
+      pending_word = word;
+      pending_sum = tape[i] + tape[i + 1];
+    }
+    i += 2;
+  }
+
+  if (!pending) return PDP8_ERROR_FORMAT;
+  if ((checksum & PDP8_WORD_MASK) != pending_word) return PDP8_ERROR_CHECKSUM;
+
+  return PDP8_OK;
+}
+
+// RIM format: every word is an address word followed by a data word.
+static int parse_rim(const unsigned char *tape, size_t length, emit_function emit, void *context) {
+  size_t i = 0;
+  while (i < length && tape[i] == TAPE_LEADER) i++;
+
+  while (i < length && !(tape[i] & TAPE_LEADER)) {
+    if (i + 3 >= length)                          return PDP8_ERROR_FORMAT;
+    if (!(tape[i] & TAPE_ORIGIN))                 return PDP8_ERROR_FORMAT;
+    if (tape[i + 2] & (TAPE_LEADER | TAPE_ORIGIN)) return PDP8_ERROR_FORMAT;
+
+    int status = emit(context, tape_word(tape, i), tape_word(tape, i + 2));
+    if (status != PDP8_OK) return status;
+    i += 4;
+  }
+
+  return PDP8_OK;
+}
+
+typedef int (*parse_function)(const unsigned char *, size_t, emit_function, void *);
+
+static int parse_file(const char *file_name, parse_function parse, emit_function emit, void *context) {
+  unsigned char *tape;
+  size_t length;
+
+  int status = PDP8_ReadFile(file_name, &tape, &length);
+  if (status != PDP8_OK) {
+    return status;
+  }
+
+  status = parse(tape, length, emit, context);
+  free(tape);
+
+  return status;
+}
+
+static int image_from(struct PDP8_Image *image, const char *file_name, parse_function parse) {
+  PDP8_ImageInit(image);
+
+  int status = parse_file(file_name, parse, emit_image, image);
+  if (status != PDP8_OK) {
+    PDP8_ImageFree(image);
+  }
+  return status;
+}
+
+int PDP8_ImageFromBinary(struct PDP8_Image *image, const char *file_name) {
+  return image_from(image, file_name, parse_binary);
+}
+
+int PDP8_ImageFromRim(struct PDP8_Image *image, const char *file_name) {
+  return image_from(image, file_name, parse_rim);
+}
+
+// Text format, one token per word, PAL style:
+//   / comment      ignored to the end of the line
+//   *nnnn          set the load address
+//   $nnnn          set the start address
+//   nnnn           store a word and advance the load address
+// All numbers are octal.
+static int parse_text(const unsigned char *text, size_t length, emit_function emit, void *context) {
+  struct PDP8_Image *image = (struct PDP8_Image *)context;
+  uint address = 0;
+  size_t i = 0;
+
+  while (i < length) {
+    unsigned char c = text[i];
+    if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+      i++;
+      continue;
+    }
+    if (c == '/') {
+      while (i < length && text[i] != '\n') i++;
+      continue;
+    }
+
+    char prefix = 0;
+    if (c == '*' || c == '$') {
+      prefix = c;
+      i++;
+    }
+
+    uint value = 0;
+    size_t digits = 0;
+    while (i < length && text[i] >= '0' && text[i] <= '7') {
+      value = (value << 3) | (text[i] - '0');
+      i++;
+      digits++;
+    }
+    if (digits == 0 || value > PDP8_WORD_MASK) return PDP8_ERROR_FORMAT;
+    if (i < length && !strchr(" \t\r\n/", text[i])) return PDP8_ERROR_FORMAT;
+
+    if (prefix == '*') {
+      address = value;
+    } else if (prefix == '$') {
+      image->start = value;
+    } else {
+      int status = emit(context, address, value);
+      if (status != PDP8_OK) return status;
+      address = (address + 1) & PDP8_WORD_MASK;
+    }
+  }
+
+  return PDP8_OK;
+}
+
+int PDP8_ImageFromText(struct PDP8_Image *image, const char *file_name) {
+  return image_from(image, file_name, parse_text);
+}
+
+static bool has_extension(const char *file_name, const char *extension) {
+  const char *dot = strrchr(file_name, '.');
+  if (!dot) return false;
+
+  for (++dot; *dot && *extension; ++dot, ++extension) {
+    if ((*dot | 040) != *extension) return false;
+  }
+  return *dot == *extension;
+}
+
+int PDP8_ImageFromFile(struct PDP8_Image *image, const char *file_name) {
+  if (has_extension(file_name, "bin")) return PDP8_ImageFromBinary(image, file_name);
+  if (has_extension(file_name, "rim")) return PDP8_ImageFromRim(image, file_name);
+
+  if (has_extension(file_name, "pal")) {
+    struct PDP8_AssemblerError error;
+    int status = PDP8_AssembleFile(image, NULL, file_name, &error);
+    if (status == PDP8_ERROR_ASSEMBLY) {
+      fprintf(stderr, "%s:%u: %s\n", file_name, error.line, error.message);
+    }
+    return status;
+  }
+  return PDP8_ImageFromText(image, file_name);
+}
+
+int PDP8_ImageFromFileWithSymbols(struct PDP8_Image *image, struct PDP8_Symbols *symbols,
+                                  const char *file_name, const char *listing) {
+  int status;
+  if (has_extension(file_name, "pal")) {
+    struct PDP8_AssemblerError error;
+    status = PDP8_AssembleFile(image, symbols, file_name, &error);
+    if (status == PDP8_ERROR_ASSEMBLY) fprintf(stderr, "%s:%u: %s\n", file_name, error.line, error.message);
+  } else {
+    status = PDP8_ImageFromFile(image, file_name);
+  }
+  if (status != PDP8_OK) {
+    fprintf(stderr, "%s: %s\n", file_name, PDP8_StatusString(status));
+    return status;
+  }
+
+  char sibling[4096];
+  if (!listing) {
+    const char *dot = strrchr(file_name, '.');
+    size_t stem = dot && !strchr(dot, '/') ? (size_t)(dot - file_name) : strlen(file_name);
+    if (stem + 5 > sizeof(sibling)) return PDP8_OK;
+    memcpy(sibling, file_name, stem);
+    strcpy(sibling + stem, ".lst");
+    PDP8_SymbolsFromListing(symbols, sibling);  // optional
+    return PDP8_OK;
+  }
+
+  status = PDP8_SymbolsFromListing(symbols, listing);
+  if (status != PDP8_OK) fprintf(stderr, "%s: %s\n", listing, PDP8_StatusString(status));
+  return status;
+}
+
+void PDP8_LoadImage(struct PDP8 *pdp8, const struct PDP8_Image *image) {
+  for (uint i = 0; i < image->segment_count; ++i) {
+    const struct PDP8_Segment *segment = &image->segments[i];
+    memcpy(&pdp8->memory[segment->origin], &image->code[segment->offset], segment->length * sizeof(uint));
+  }
+
+  for (uint i = 0; i < image->deposit_count; ++i) {
+    pdp8->memory[image->deposits[i].address] = image->deposits[i].value;
+  }
+}
+
+void PDP8_StartImage(struct PDP8 *pdp8, const struct PDP8_Image *image) {
+  pdp8->pc = image->start == PDP8_NO_START ? DEFAULT_START : image->start;
+  pdp8->run = true;
+}
+
+int PDP8_LoadBinary(struct PDP8 *pdp8, const char *file_name) {
+  return parse_file(file_name, parse_binary, emit_memory, pdp8);
+}
+
+// Parses a whole string as a 12 bit octal number.
+bool PDP8_ParseOctal(const char *text, uint *value) {
+  char *end;
+  unsigned long number = strtoul(text, &end, 8);
+  if (end == text || *end || number > PDP8_WORD_MASK) return false;
+
+  *value = number;
+  return true;
+}
+
+// Parses "address=value", both octal.
+bool PDP8_ParseDeposit(const char *text, uint *address, uint *value) {
+  const char *equals = strchr(text, '=');
+  if (!equals || equals - text >= 8) return false;
+
+  char buffer[8];
+  memcpy(buffer, text, equals - text);
+  buffer[equals - text] = 0;
+
+  return PDP8_ParseOctal(buffer, address) && PDP8_ParseOctal(equals + 1, value);
+}
@@ -0,0 +1,92 @@
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+#ifndef PDP8_LOADER_H
+#define PDP8_LOADER_H
+
+#include <stddef.h>
+
+#include "pdp8.h"
+
+  struct PDP8_Symbols;
+
+  enum PDP8_Status {
+    PDP8_OK = 0,
+    PDP8_ERROR_OPEN,                   // file could not be opened
+    PDP8_ERROR_READ,                   // i/o error while reading
+    PDP8_ERROR_FORMAT,                 // file is not a valid image
+    PDP8_ERROR_CHECKSUM,               // binary tape checksum mismatch
+    PDP8_ERROR_ASSEMBLY,               // PAL source failed to assemble
+    PDP8_ERROR_MEMORY,                 // out of host memory
+    PDP8_ERROR_WRITE,                  // i/o error while writing
+  };
+
+  enum PDP8_ImageConstants {
+    PDP8_NO_START = -1,                // image has no start address
+  };
+
+  // Contiguous run of words starting at origin. The words live in the
+  // image's shared code buffer at offset.
+  struct PDP8_Segment {
+    uint origin;                       //  first address<0:11>
+    uint length;                       //  number of words
+    uint offset;                       //  index of first word in code
+  };
+
+  // Single word stored after all segments are loaded.
+  struct PDP8_Deposit {
+    uint address;                      //  address<0:11>
+    uint value;                        //  value<0:11>
+  };
+
+  // Read-only program image. Parse it once, then load it into as many
+  // machines as needed; loading never touches the file system and only
+  // writes the populated ranges.
+  struct PDP8_Image {
+    uint segment_count;
+    uint segment_capacity;
+    struct PDP8_Segment *segments;
+
+    uint code_length;
+    uint code_capacity;
+    uint *code;                        //  segment words<0:11>
+
+    uint deposit_count;
+    uint deposit_capacity;
+    struct PDP8_Deposit *deposits;
+
+    int start;                         //  start address or PDP8_NO_START
+  };
+
+  extern const char *PDP8_StatusString(int status);
+  extern int PDP8_ReadFile(const char *file_name, unsigned char **buffer, size_t *length);
+
+  extern void PDP8_ImageInit(struct PDP8_Image *image);
+  extern void PDP8_ImageFree(struct PDP8_Image *image);
+  extern int  PDP8_ImageAppend(struct PDP8_Image *image, uint address, uint value);
+  extern int  PDP8_ImageDeposit(struct PDP8_Image *image, uint address, uint value);
+
+  extern int  PDP8_ImageFromBinary(struct PDP8_Image *image, const char *file_name);
+  extern int  PDP8_ImageFromRim(struct PDP8_Image *image, const char *file_name);
+  extern int  PDP8_ImageFromText(struct PDP8_Image *image, const char *file_name);
+  extern int  PDP8_ImageFromFile(struct PDP8_Image *image, const char *file_name);
+
+  // Also defines the image's symbols: a .pal source's own, and those of
+  // listing or, without one, of a .lst next to the image if there is one.
+  // Errors are reported on stderr.
+  extern int  PDP8_ImageFromFileWithSymbols(struct PDP8_Image *image, struct PDP8_Symbols *symbols,
+                                            const char *file_name, const char *listing);
+
+  extern void PDP8_LoadImage(struct PDP8 *pdp8, const struct PDP8_Image *image);
+  extern void PDP8_StartImage(struct PDP8 *pdp8, const struct PDP8_Image *image);
+  extern int  PDP8_LoadBinary(struct PDP8 *pdp8, const char *file_name);
+
+  extern bool PDP8_ParseOctal(const char *text, uint *value);
+  extern bool PDP8_ParseDeposit(const char *text, uint *address, uint *value);
+
+#endif //PDP8_LOADER_H
+
+#if defined (__cplusplus)
+}
+#endif
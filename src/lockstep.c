@@ -0,0 +1,104 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lockstep.h"
+#include "loader.h"
+#include "disassembler.h"
+#include "tracediff.h"
+
+bool PDP8_StateEqual(const struct PDP8 *a, const struct PDP8 *b) {
+  return a->pc == b->pc && a->lac == b->lac && a->mq == b->mq && a->ma == b->ma && a->mb == b->mb && a->ir == b->ir &&
+         a->run == b->run && a->interrupt_enable == b->interrupt_enable &&
+         a->interrupt_request == b->interrupt_request && a->switches == b->switches &&
+         a->keyboard_flag == b->keyboard_flag && a->keyboard_buffer == b->keyboard_buffer &&
+         a->printer_flag == b->printer_flag && a->printer_buffer == b->printer_buffer &&
+         a->last_pc == b->last_pc && a->restart == b->restart && a->cycles == b->cycles &&
+         !memcmp(a->memory, b->memory, sizeof(a->memory));
+}
+
+// Instrumentation and devices are not compared and must not run twice.
+static void detach(struct PDP8 *pdp8) {
+  pdp8->profile = NULL;
+  pdp8->stats = NULL;
+  pdp8->lamps = NULL;
+  pdp8->watchpoints = NULL;
+  pdp8->watch_pages = 0;
+  pdp8->print = NULL;
+  pdp8->print_context = NULL;
+}
+
+static bool same_block(const struct PDP8 *reference, uint64_t reference_count,
+                       const struct PDP8 *candidate, uint64_t candidate_count) {
+  return reference_count == candidate_count && PDP8_StateEqual(reference, candidate);
+}
+
+int PDP8_Lockstep(const struct PDP8 *initial, const struct PDP8_Engine *candidate,
+                  uint64_t budget, uint64_t block, struct PDP8_LockstepResult *result) {
+  struct PDP8 *reference = &result->reference;
+  struct PDP8 *machine = &result->candidate;
+  struct PDP8 *checkpoint = &result->before;
+
+  result->mismatch = false;
+  result->executed = 0;
+  if (block == 0) block = 1;
+
+  *checkpoint = *initial;
+  detach(checkpoint);
+  *reference = *checkpoint;
+  *machine = *checkpoint;
+
+  while (result->executed < budget && (reference->run || machine->run)) {
+    uint64_t count = budget - result->executed < block ? budget - result->executed : block;
+    uint64_t reference_count, candidate_count;
+    PDP8_RunFor(reference, count, &reference_count);
+    candidate->run(machine, count, &candidate_count);
+
+    if (same_block(reference, reference_count, machine, candidate_count)) {
+      result->executed += reference_count;
+      *checkpoint = *reference;
+      if (reference_count < count) break;  // both halted
+      continue;
+    }
+
+    // replay the block one instruction at a time from the checkpoint
+    *reference = *checkpoint;
+    *machine = *checkpoint;
+    for (uint64_t i = 0; i < count; ++i) {
+      PDP8_RunFor(reference, 1, &reference_count);
+      candidate->run(machine, 1, &candidate_count);
+      if (!same_block(reference, reference_count, machine, candidate_count)) break;
+
+      *checkpoint = *reference;
+      result->executed++;
+    }
+    result->mismatch = true;
+    break;
+  }
+
+  if (!result->mismatch) *checkpoint = *reference;
+  return PDP8_OK;
+}
+
+static void print_instruction(FILE *out, const char *label, const struct PDP8 *pdp8) {
+  char text[PDP8_DISASSEMBLY_LENGTH];
+  PDP8_Disassemble(pdp8->memory[pdp8->pc], pdp8->pc, NULL, text);
+  fprintf(out, "%s PC %04o  %04o %-16s L %o AC %04o\n", label, pdp8->pc, pdp8->memory[pdp8->pc], text,
+          pdp8->link, pdp8->ac);
+}
+
+void PDP8_PrintLockstepResult(FILE *out, const char *candidate, const struct PDP8_LockstepResult *result) {
+  if (!result->mismatch) {
+    fprintf(out, "%s matches the reference for %llu instructions\n", candidate,
+            (unsigned long long)result->executed);
+    return;
+  }
+
+  fprintf(out, "%s differs from the reference at instruction %llu\n", candidate,
+          (unsigned long long)result->executed);
+  print_instruction(out, "before:", &result->before);
+  fprintf(out, "a is the reference, b the candidate\n");
+  PDP8_PrintStateDiff(out, &result->reference, &result->candidate);
+}
@@ -0,0 +1,38 @@
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+#ifndef PDP8_LOCKSTEP_H
+#define PDP8_LOCKSTEP_H
+
+#include <stdio.h>
+
+#include "pdp8.h"
+#include "engine.h"
+
+  struct PDP8_LockstepResult {
+    bool mismatch;
+    uint64_t executed;                 //  instructions both engines agreed on
+    struct PDP8 before;                //  common state before the mismatch
+    struct PDP8 reference;             //  states after the mismatching instruction
+    struct PDP8 candidate;
+  };
+
+  // True when the architectural state (registers, flags, cycle count and
+  // memory) of two machines is identical.
+  extern bool PDP8_StateEqual(const struct PDP8 *a, const struct PDP8 *b);
+
+  // Runs candidate and the reference from initial for up to budget
+  // instructions, comparing full state every block instructions (1 for
+  // lockstep). A mismatching block is re-run one instruction at a time to
+  // find the first differing instruction. Printer output is discarded.
+  extern int PDP8_Lockstep(const struct PDP8 *initial, const struct PDP8_Engine *candidate,
+                           uint64_t budget, uint64_t block, struct PDP8_LockstepResult *result);
+
+  extern void PDP8_PrintLockstepResult(FILE *out, const char *candidate, const struct PDP8_LockstepResult *result);
+
+#endif //PDP8_LOCKSTEP_H
+
+#if defined (__cplusplus)
+}
+#endif
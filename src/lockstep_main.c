@@ -0,0 +1,205 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "pdp8.h"
+#include "instruction.h"
+#include "loader.h"
+#include "engine.h"
+#include "lockstep.h"
+#include "corpus.h"
+
+#define DEFAULT_BUDGET 10000000
+#define DEFAULT_BLOCK  4096
+
+static int usage(const char *name) {
+  fprintf(stderr, "usage: %s [-e engine]... [-n budget] [-b block] [-c corpus] [-t] [image]...\n", name);
+  fprintf(stderr, "  checks each engine (default: all but the faulty ones) against the reference on each image\n");
+  fprintf(stderr, "  (default: the corpus in %s), comparing state every block instructions;\n", PDP8_CORPUS_DIRECTORY);
+  fprintf(stderr, "  -b 1 runs in lockstep. -t checks the checker instead: faulty-tad must be\n");
+  fprintf(stderr, "  reported at the first TAD that carries. Engines:");
+  for (uint i = 0; i < PDP8_EngineCount; ++i) fprintf(stderr, " %s", PDP8_Engines[i].name);
+  fprintf(stderr, "\n");
+  return 2;
+}
+
+static double now(void) {
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+// Position of the first TAD that changes the link, which faulty-tad gets
+// wrong, or budget if there is none.
+static uint64_t first_carry(const struct PDP8 *initial, uint64_t budget) {
+  struct PDP8 *pdp8 = (struct PDP8 *)malloc(sizeof(struct PDP8));
+  if (!pdp8) return budget;
+  *pdp8 = *initial;
+
+  uint64_t found = budget;
+  for (uint64_t count = 0; count < budget && pdp8->run; ++count) {
+    uint link = pdp8->link;
+    PDP8_Step(pdp8);
+    if ((pdp8->ir >> 9) == PDP8_TAD && pdp8->link != link) {
+      found = count;
+      break;
+    }
+  }
+  free(pdp8);
+  return found;
+}
+
+// Whether the state before the mismatch is the reference's after as many
+// instructions as were reported to agree.
+static bool at_position(const struct PDP8 *initial, const struct PDP8_LockstepResult *result) {
+  struct PDP8 *pdp8 = (struct PDP8 *)malloc(sizeof(struct PDP8));
+  if (!pdp8) return false;
+  *pdp8 = *initial;
+  PDP8_RunFor(pdp8, result->executed, NULL);
+  bool ok = PDP8_StateEqual(pdp8, &result->before);
+  free(pdp8);
+  return ok;
+}
+
+// Whether the report of a mismatch is headed by its position and shows
+// the link differing.
+static bool reported(const struct PDP8_LockstepResult *result) {
+  char *report = NULL;
+  size_t length = 0;
+  FILE *out = open_memstream(&report, &length);
+  if (!out) return false;
+  PDP8_PrintLockstepResult(out, "faulty-tad", result);
+  fclose(out);
+
+  char heading[128];
+  snprintf(heading, sizeof(heading), "faulty-tad differs from the reference at instruction %llu\n",
+           (unsigned long long)result->executed);
+  bool ok = !strncmp(report, heading, strlen(heading)) && strstr(report, "\n  L ");
+  free(report);
+  return ok;
+}
+
+// Runs faulty-tad against the reference in lockstep, where the mismatch
+// must be found at the first TAD that carries, and then in blocks, where a
+// wrong link put right again within its block goes unseen: any mismatch
+// must be a later TAD.
+static bool self_test(const char *file_name, const struct PDP8 *initial, uint64_t budget, uint64_t block,
+                      struct PDP8_LockstepResult *result) {
+  const struct PDP8_Engine *faulty = PDP8_FindEngine("faulty-tad");
+  uint64_t expected = first_carry(initial, budget);
+  bool carries = expected < budget;
+
+  printf("%s: ", file_name);
+  PDP8_Lockstep(initial, faulty, budget, 1, result);
+  bool ok = carries ? result->mismatch && result->executed == expected && at_position(initial, result) &&
+                      reported(result)
+                    : !result->mismatch;
+  if (ok && block > 1) {
+    PDP8_Lockstep(initial, faulty, budget, block, result);
+    ok = !result->mismatch || (result->executed >= expected && at_position(initial, result) && reported(result) &&
+                               result->before.memory[result->before.pc] >> 9 == PDP8_TAD);
+  }
+
+  if (!ok) {
+    printf("self-test failed, expected %s %llu\n", carries ? "a mismatch at" : "no mismatch in",
+           (unsigned long long)expected);
+    PDP8_PrintLockstepResult(stdout, faulty->name, result);
+  } else if (!carries) {
+    printf("no TAD carries, faulty-tad rightly matches\n");
+  } else if (block > 1 && (!result->mismatch || result->executed != expected)) {
+    printf("faulty-tad caught at instruction %llu, in blocks of %llu at ", (unsigned long long)expected,
+           (unsigned long long)block);
+    if (result->mismatch) printf("%llu\n", (unsigned long long)result->executed);
+    else printf("none\n");
+  } else {
+    printf("faulty-tad caught at instruction %llu\n", (unsigned long long)expected);
+  }
+  return ok;
+}
+
+int main(int argc, char **argv) {
+  uint64_t budget = DEFAULT_BUDGET;
+  uint64_t block = DEFAULT_BLOCK;
+  const char *directory = PDP8_CORPUS_DIRECTORY;
+  const struct PDP8_Engine **engines = (const struct PDP8_Engine **)calloc(argc + PDP8_EngineCount, sizeof(*engines));
+  const char **images = (const char **)calloc(argc, sizeof(const char *));
+  uint engine_count = 0, image_count = 0;
+  bool testing = false;
+
+  for (int i = 1; i < argc; ++i) {
+    const char *arg = argv[i];
+    if (arg[0] != '-') {
+      images[image_count++] = arg;
+    } else if (!strcmp(arg, "-t")) {
+      testing = true;
+    } else if (i + 1 >= argc) {
+      return usage(argv[0]);
+    } else if (!strcmp(arg, "-e")) {
+      engines[engine_count] = PDP8_FindEngine(argv[++i]);
+      if (!engines[engine_count++]) return usage(argv[0]);
+    } else if (!strcmp(arg, "-n")) {
+      budget = strtoull(argv[++i], NULL, 10);
+    } else if (!strcmp(arg, "-b")) {
+      block = strtoull(argv[++i], NULL, 10);
+    } else if (!strcmp(arg, "-c")) {
+      directory = argv[++i];
+    } else {
+      return usage(argv[0]);
+    }
+  }
+  if (block == 0) return usage(argv[0]);
+  if (!engine_count) {
+    for (uint i = 0; i < PDP8_EngineCount; ++i) {
+      if (!PDP8_Engines[i].faulty) engines[engine_count++] = &PDP8_Engines[i];
+    }
+  }
+
+  struct PDP8 *initial = (struct PDP8 *)malloc(sizeof(struct PDP8));
+  struct PDP8_LockstepResult *result = (struct PDP8_LockstepResult *)malloc(sizeof(struct PDP8_LockstepResult));
+  if (!initial || !result) return 2;
+
+  int exit_code = 0;
+  uint count = image_count ? image_count : PDP8_CORPUS_COUNT;
+  for (uint w = 0; w < count; ++w) {
+    char path[4096];
+    const char *file_name = images[w];
+    if (!image_count) {
+      snprintf(path, sizeof(path), "%s/%s", directory, PDP8_Corpus[w]);
+      file_name = path;
+    }
+
+    struct PDP8_Image image;
+    int status = PDP8_ImageFromFile(&image, file_name);
+    if (status != PDP8_OK) {
+      fprintf(stderr, "%s: %s\n", file_name, PDP8_StatusString(status));
+      exit_code = 2;
+      continue;
+    }
+    PDP8_Reset(initial);
+    PDP8_MemoryReset(initial);
+    PDP8_LoadImage(initial, &image);
+    PDP8_StartImage(initial, &image);
+    PDP8_ImageFree(&image);
+
+    if (testing) {
+      if (!self_test(file_name, initial, budget, block, result)) exit_code = 1;
+      continue;
+    }
+
+    for (uint e = 0; e < engine_count; ++e) {
+      double start = now();
+      PDP8_Lockstep(initial, engines[e], budget, block, result);
+      printf("%s: ", file_name);
+      PDP8_PrintLockstepResult(stdout, engines[e]->name, result);
+      if (!result->mismatch) printf("  %.3f s\n", now() - start);
+      else exit_code = 1;
+    }
+  }
+
+  free(result);
+  free(initial);
+  free(images);
+  free(engines);
+  return exit_code;
+}
@@ -1,141 +1,538 @@
+#include <stdarg.h>
+
 #include "pdp8.h"
+#include "loader.h"
+#include "disassembler.h"
+#include "symbols.h"
+#include "emulator.h"
 
 #define OLC_PGE_APPLICATION
 #include "olcPixelGameEngine.h"
 
+#define FRAME_RATE 60                  // frames per second a steps per frame speed assumes
+#define SCREEN_WIDTH 680
+#define SCREEN_HEIGHT 480
+#define MAX_CAPTURES 256
+#define MEMORY_COLUMNS 49              // characters of a memory row, up to the CPU column
+#define HIGHLIGHT_FRAMES 30            // frames a changed word stays highlighted
+#define ADDRESS_DIGITS (PDP8_MEMORY_SIZE > PDP8_WORD_MASK + 1 ? 5 : 4)
+
+// Teleprinter output goes to the terminal.
+static void print_character(void *context, uint c) {
+  (void)context;
+  putchar(c & 0177);
+  fflush(stdout);
+}
+
 class Demo_PDP8 : public olc::PixelGameEngine {
   public:
-  Demo_PDP8() { sAppName = "PDP8 Demonstration"; }
+  Demo_PDP8() {
+    sAppName = "PDP8 Demonstration";
+    PDP8_SymbolsInit(&symbols);
+  }
   
-  std::string octal(uint n, uint8_t d) {
-    std::string s(d, '0');
-    for (int i = d - 1; i >= 0; --i, n >>= 3) {
-      s[i] = "01234567"[n & 7];
-    }
-    return s;
-  };
+  // Every word in each format, built once: the per-frame drawing only
+  // looks them up.
+  static char octal_numbers[PDP8_MEMORY_SIZE][5];
+  static char hex_numbers[PDP8_MEMORY_SIZE][5];
+  static char binary_numbers[PDP8_MEMORY_SIZE][13];
   
-  std::string hex(uint n, uint8_t d) {
-    std::string s(d, '0');
-    for (int i = d - 1; i >= 0; --i, n >>= 4) {
-      s[i] = "0123456789ABCDEF"[n & 0xF];
+  static void BuildNumbers() {
+    for (uint n = 0; n < PDP8_MEMORY_SIZE; ++n) {
+      snprintf(octal_numbers[n], sizeof(octal_numbers[n]), "%04o", n);
+      snprintf(hex_numbers[n], sizeof(hex_numbers[n]), "%03X", n);
+      for (int i = 11; i >= 0; --i) binary_numbers[n][11 - i] = "01"[(n >> i) & 1];
+      binary_numbers[n][12] = '\0';
     }
-    return s;
+  }
+  
+  // The memory view scrolls over all of memory but only looks at the rows
+  // on screen. Each keeps its text and the word, address and number format
+  // it was built from, and is only rebuilt, and disassembled, when one of
+  // those changes, so a still frame allocates nothing.
+  struct MemoryRow {
+    uint address = PDP8_MEMORY_SIZE;
+    uint word = 0;
+    bool pc = false;
+    const char (*numbers)[5] = nullptr;
+    std::string text;
   };
+  std::vector<MemoryRow> memory_rows;
+  const char *names[PDP8_MEMORY_SIZE] = {};    // labels by address
+  uint previous_memory[PDP8_MEMORY_SIZE];      // as of the last frame
+  uint64_t changed[PDP8_MEMORY_SIZE] = {};     // frame a word on screen last changed in
+  uint64_t frame = 0;
+  uint top = 0;                                // first address on screen
+  
+  int MemoryRows() const {
+    return view.panel ? 22 : 44;
+  }
+  
+  // Keeps a screenful of rows inside memory.
+  void ScrollTo(long address) {
+    long last = PDP8_MEMORY_SIZE - MemoryRows();
+    top = address < 0 ? 0 : address > last ? last : address;
+  }
+  
+  // Scrolls only if address is off screen, then puts it a quarter of the
+  // way down.
+  void Show(uint address) {
+    if (address < top || address >= top + MemoryRows()) ScrollTo((long)address - MemoryRows() / 4);
+  }
   
-  std::string binary(uint n, uint8_t d) {
-    std::string s(d, '0');
-    for (int i = d - 1; i >= 0; --i, n >>= 1) {
-      s[i] = "01"[n & 1];
+  void AppendAddress(std::string &text, uint address) {
+    if (PDP8_MEMORY_SIZE > PDP8_WORD_MASK + 1) text.push_back('0' + (address >> 12));
+    text.append(numbers[address & PDP8_WORD_MASK]);
+  }
+  
+  void DrawMemory(int x, int y, int nRows) {
+    const uint *memory = view.pdp8.memory;
+    if (!frame++) std::copy(memory, memory + PDP8_MEMORY_SIZE, previous_memory);
+    
+    memory_rows.resize(nRows);
+    for (int row = 0; row < nRows && top + row < PDP8_MEMORY_SIZE; ++row) {
+      MemoryRow &cache = memory_rows[row];
+      uint address = top + row;
+      uint word = memory[address];
+      bool pc = address == view.pdp8.pc;
+      if (word != previous_memory[address]) changed[address] = frame;
+      
+      if (cache.address != address || cache.word != word || cache.pc != pc || cache.numbers != numbers) {
+        cache.address = address;
+        cache.word = word;
+        cache.pc = pc;
+        cache.numbers = numbers;
+        
+        char text[PDP8_DISASSEMBLY_LENGTH];
+        const char *name = names[address & PDP8_WORD_MASK];
+        cache.text.assign(pc ? "> " : "  ");
+        AppendAddress(cache.text, address);
+        snprintf(text, sizeof(text), " %-6.6s ", name ? name : "");
+        cache.text.append(text);
+        cache.text.append(numbers[word]);
+        cache.text.append(" ");
+        PDP8_Disassemble(word, address & PDP8_WORD_MASK, names, text);
+        cache.text.append(text);
+        if (cache.text.size() > MEMORY_COLUMNS) cache.text.resize(MEMORY_COLUMNS);
+      }
+      
+      bool recent = changed[address] && frame - changed[address] < HIGHLIGHT_FRAMES;
+      DrawString(x, y + row * 10, cache.text, pc ? olc::CYAN : recent ? olc::YELLOW : olc::WHITE);
     }
-    return s;
-  };
+    
+    std::copy(memory, memory + PDP8_MEMORY_SIZE, previous_memory);
+  }
   
-  void DrawMemory(int x, int y, uint nAddr, int nRows, int nColumns) {
-    int nMemX = x, nMemY = y;
-    for (int row = 0; row < nRows; ++row) {
-      std::string sOffset = " " + format_number(nAddr) + ":";
-      for (int col = 0; col < nColumns; ++col) {
-        sOffset += " " + format_number(pdp8.memory[nAddr]);
-        nAddr += 1;
+  // J starts typing an octal address, ENTER jumps to it and ESCAPE gives up.
+  bool jumping = false;
+  std::string jump;
+  
+  void TypeJump() {
+    static const olc::Key digits[8] = { olc::K0, olc::K1, olc::K2, olc::K3, olc::K4, olc::K5, olc::K6, olc::K7 };
+    static const olc::Key keypad[8] = { olc::NP0, olc::NP1, olc::NP2, olc::NP3, olc::NP4, olc::NP5, olc::NP6, olc::NP7 };
+    for (uint digit = 0; digit < 8; ++digit) {
+      if ((GetKey(digits[digit]).bPressed || GetKey(keypad[digit]).bPressed) && jump.size() < ADDRESS_DIGITS) {
+        jump.push_back('0' + digit);
       }
-      DrawString(nMemX, nMemY, sOffset);
-      nMemY += 10;
     }
+    if (GetKey(olc::Key::BACK).bPressed && !jump.empty()) jump.pop_back();
+    
+    if (GetKey(olc::Key::ENTER).bPressed) {
+      if (!jump.empty()) Show(strtoul(jump.c_str(), NULL, 8) % PDP8_MEMORY_SIZE);
+      jumping = false;
+    }
+    if (GetKey(olc::Key::ESCAPE).bPressed) jumping = false;
+  }
+  
+  // Formats into a reused string, which stops allocating once it has grown.
+  // Labels too long for std::string's inline buffer go through it as well.
+  std::string line;
+  
+  const std::string &Line(const char *format, ...) {
+    char text[80];
+    va_list arguments;
+    va_start(arguments, format);
+    vsnprintf(text, sizeof(text), format, arguments);
+    va_end(arguments);
+    line.assign(text);
+    return line;
+  }
+  
+  const std::string &Register(const char *name, uint value) {
+    return Line("%s%s [%u]", name, numbers[value & PDP8_WORD_MASK], value);
+  }
+  
+  static const char *Flag(uint value) {
+    return value ? "1" : "0";
   }
   
   void DrawCPU(int x, int y) {
+    const struct PDP8 &pdp8 = view.pdp8;
+    
     DrawString(x,      y, "RUN: ", olc::WHITE);
-    DrawString(x + 40, y, std::to_string(pdp8.run), pdp8.run ? olc::GREEN : olc::RED);
+    DrawString(x + 40, y, Flag(pdp8.run), pdp8.run ? olc::GREEN : olc::RED);
     
-    DrawString(x, y + 20, "MA: " + format_number(pdp8.ma) + " [" + std::to_string(pdp8.ma) + "]");
-    DrawString(x, y + 30, "MB: " + format_number(pdp8.mb) + " [" + std::to_string(pdp8.mb) + "]");
+    DrawString(x, y + 20, Register("MA: ", pdp8.ma));
+    DrawString(x, y + 30, Register("MB: ", pdp8.mb));
     
-    DrawString(x, y + 50, "PC: " + format_number(pdp8.last_pc) + " [" + std::to_string(pdp8.last_pc) + "]");
-    DrawString(x, y + 60, "IR: " + format_number(pdp8.ir) + " [" + std::to_string(pdp8.ir) + "]");
+    DrawString(x, y + 50, Register("PC: ", pdp8.last_pc));
+    DrawString(x, y + 60, Register("IR: ", pdp8.ir));
+    char text[PDP8_DISASSEMBLY_LENGTH];
+    PDP8_Disassemble(pdp8.ir, pdp8.last_pc, NULL, text);
+    DrawString(x + 32, y + 70, Line("%s", text), olc::CYAN);
     
     DrawString(x,      y + 80, "LINK:", olc::WHITE);
-    DrawString(x + 48, y + 80, std::to_string(pdp8.link), pdp8.link ? olc::GREEN : olc::RED);
-    DrawString(x,      y + 90, "AC:   " + format_number(pdp8.ac) + " [" + std::to_string(pdp8.ac) + "]");
+    DrawString(x + 48, y + 80, Flag(pdp8.link), pdp8.link ? olc::GREEN : olc::RED);
+    DrawString(x,      y + 90, Register("AC:   ", pdp8.ac));
+    DrawString(x,      y + 100, Register("MQ:   ", pdp8.mq));
+    
+    DrawString(x,       y + 110, Line("INTERRUPT REQUEST:"), olc::WHITE);
+    DrawString(x + 152, y + 110, Flag(pdp8.interrupt_request), pdp8.interrupt_request ? olc::GREEN : olc::RED);
+    DrawString(x,       y + 120, Line("INTERRUPT ENABLE:"), olc::WHITE);
+    DrawString(x + 152, y + 120, Flag(pdp8.interrupt_enable), pdp8.interrupt_enable ? olc::GREEN : olc::RED);
+    
+    DrawString(x, y + 140, Line("SWITCHES: %s [%u]", binary_numbers[pdp8.switches], pdp8.switches));
+    
+    DrawString(x,      y + 160, "TRACE:", olc::WHITE);
+    DrawString(x + 56, y + 160, Flag(view.tracing), view.tracing ? olc::GREEN : olc::RED);
     
-    DrawString(x,       y + 110, "INTERRUPT REQUEST:", olc::WHITE);
-    DrawString(x + 152, y + 110, std::to_string(pdp8.interrupt_request), pdp8.interrupt_request ? olc::GREEN : olc::RED);
-    DrawString(x,       y + 120, "INTERRUPT ENABLE:", olc::WHITE);
-    DrawString(x + 152, y + 120, std::to_string(pdp8.interrupt_enable), pdp8.interrupt_enable ? olc::GREEN : olc::RED);
+    DrawString(x, y + 180, Line("INSTRUCTIONS: %llu", (unsigned long long)view.instructions));
+    DrawString(x, y + 190, Line("BREAKPOINTS:  %u", view.breakpoints));
+    DrawString(x,       y + 200, "GO:", olc::WHITE);
+    DrawString(x + 152, y + 200, Flag(view.running), view.running ? olc::GREEN : olc::RED);
     
-    DrawString(x, y + 140, "SWITCHES: " + binary(pdp8.switches, 12) + " [" + std::to_string(pdp8.switches) + "]");
+    if (view.throttle == PDP8_THROTTLE_NONE) {
+      DrawString(x, y + 210, Line("SPEED:        UNLIMITED"));
+    } else if (view.throttle == PDP8_THROTTLE_CYCLES) {
+      DrawString(x, y + 210, Line("SPEED:        REAL TIME"));
+    } else {
+      DrawString(x, y + 210, Line("SPEED:        %llu/FRAME", (unsigned long long)(view.rate / FRAME_RATE)));
+    }
+    DrawString(x, y + 220, Line("MIPS:         %.3f", view.mips));
   }
   
-  struct PDP8 pdp8;
-  struct PDP8_Program program;
-  std::function<std::string(uint)> format_number;
-  uint8_t page; // 0 - 31
+  // Front panel lamps glow with the fraction of the instructions since the
+  // last frame they were lit after; with none, they show the state as is.
+  float lamps[PDP8_LAMP_COUNT];
+  uint64_t lamp_totals[PDP8_LAMP_COUNT] = {};
+  uint64_t lamp_instructions = 0;
+  struct PDP8_Lamps instant;
   
-  public:
-  bool OnUserCreate() override {
-    program = PDP8_BinaryToProgram("../program/compare.bin");
+  void UpdateLamps() {
+    uint64_t instructions = view.lamp_instructions - lamp_instructions;
+    if (instructions) {
+      for (uint i = 0; i < PDP8_LAMP_COUNT; ++i) lamps[i] = float(view.lamps[i] - lamp_totals[i]) / instructions;
+    } else {
+      PDP8_LampsReset(&instant);
+      PDP8_LampsCount(&instant, &view.pdp8);
+      PDP8_LampsFlush(&instant);
+      for (uint i = 0; i < PDP8_LAMP_COUNT; ++i) lamps[i] = float(instant.totals[i]);
+    }
+    lamp_instructions = view.lamp_instructions;
+    std::copy(view.lamps, view.lamps + PDP8_LAMP_COUNT, lamp_totals);
+  }
+  
+  void DrawLamp(int x, int y, float brightness) {
+    FillCircle(x, y, 3, olc::Pixel(48 + 207 * brightness, 32 + 168 * brightness, 16 + 64 * brightness));
+  }
+  
+  // 12 lamps, bit 0 on the left, grouped in octal digits
+  void DrawRegisterLamps(int x, int y, const char *name, uint first) {
+    DrawString(x, y - 3, Line("%s", name));
+    for (uint bit = 0; bit < 12; ++bit) {
+      DrawLamp(x + 36 + bit * 12 + bit / 3 * 6, y, lamps[first + 11 - bit]);
+    }
+  }
+  
+  void DrawPanel(int x, int y) {
+    static const char *const ir_names[8] = { "AND", "TAD", "ISZ", "DCA", "JMS", "JMP", "IOT", "OPR" };
+    static const char *const state_names[3] = { "F", "D", "E" };
     
-    format_number = [&] (uint n) { return octal(n, 4); };
+    UpdateLamps();
+    DrawRegisterLamps(x, y,      "PC", PDP8_LAMP_PC);
+    DrawRegisterLamps(x, y + 16, "MA", PDP8_LAMP_MA);
+    DrawRegisterLamps(x, y + 32, "MB", PDP8_LAMP_MB);
+    DrawRegisterLamps(x, y + 48, "AC", PDP8_LAMP_AC);
+    DrawLamp(x + 28, y + 48, lamps[PDP8_LAMP_LINK]);
+    DrawRegisterLamps(x, y + 64, "MQ", PDP8_LAMP_MQ);
     
-    PDP8_Reset(&pdp8);
-    PDP8_MemoryReset(&pdp8);
-    PDP8_ReloadProgram(&pdp8, &program);
-    page = 0;
+    DrawString(x, y + 77, Line("SR"));
+    for (uint bit = 0; bit < 12; ++bit) {
+      bool up = (view.pdp8.switches >> (11 - bit)) & 1;
+      FillRect(x + 33 + bit * 12 + bit / 3 * 6, y + 76 + (up ? 0 : 4), 6, 6, up ? olc::WHITE : olc::GREY);
+    }
+    
+    for (uint i = 0; i < 8; ++i) {
+      DrawString(x + 240 + i * 32, y - 3, Line("%s", ir_names[i]));
+      DrawLamp(x + 251 + i * 32, y + 12, lamps[PDP8_LAMP_IR + i]);
+    }
+    for (uint i = 0; i < 3; ++i) {
+      DrawString(x + 240 + i * 32, y + 29, Line("%s", state_names[i]));
+      DrawLamp(x + 251 + i * 32, y + 32, lamps[PDP8_LAMP_FETCH + i]);
+    }
+    DrawString(x + 336, y + 29, Line("ION"));
+    DrawLamp(x + 366, y + 32, lamps[PDP8_LAMP_ION]);
+    DrawString(x + 400, y + 29, Line("RUN"));
+    DrawLamp(x + 430, y + 32, view.pdp8.run);
+  }
+  
+  struct PDP8_EmulatorView view;
+  const char (*numbers)[5] = octal_numbers;
+  uint64_t steps_per_frame = 1024;
+  
+  public:
+  struct PDP8_Image image;
+  struct PDP8_Symbols symbols;                 // names points into these
+  uint initial_switches = 0;
+  
+  struct PDP8_Emulator emulator;
+  
+  bool OnUserCreate() override {
+    BuildNumbers();
     
+    PDP8_EmulatorInit(&emulator, &image, initial_switches);
+    emulator.print = print_character;
+    int status = PDP8_EmulatorStart(&emulator);
+    if (status != PDP8_OK) {
+      fprintf(stderr, "emulator: %s\n", PDP8_StatusString(status));
+      return false;
+    }
+    return true;
+  }
+  
+  bool OnUserDestroy() override {
+    PDP8_EmulatorStop(&emulator);
+    PDP8_ImageFree(&image);
+    PDP8_SymbolsFree(&symbols);
     return true;
   }
   
   bool OnUserUpdate(float fElapsedTime) override {
-    Clear(olc::DARK_BLUE);
+    // the emulation thread runs on regardless; this is its latest state
+    PDP8_EmulatorRead(&emulator, &view);
+    
+    if (jumping) {
+      TypeJump();
+      Draw();
+      return true;
+    }
     
     if (GetKey(olc::Key::SPACE).bPressed) {
-      PDP8_Step(&pdp8);
+      PDP8_EmulatorCommand(&emulator, PDP8_COMMAND_STEP, 0);
+    }
+    
+    // breakpoint on the next instruction, and go until one is hit
+    if (GetKey(olc::Key::K).bPressed) {
+      PDP8_EmulatorCommand(&emulator, PDP8_COMMAND_BREAKPOINT, 0);
+    }
+    
+    if (GetKey(olc::Key::G).bPressed) {
+      PDP8_EmulatorCommand(&emulator, view.running ? PDP8_COMMAND_STOP : PDP8_COMMAND_RUN, 0);
+    }
+    
+    // speed: unlimited, a real PDP-8's, or halve or double the steps per frame
+    if (GetKey(olc::Key::U).bPressed) {
+      PDP8_EmulatorCommand(&emulator, PDP8_COMMAND_SPEED, 0);
+    }
+    
+    if (GetKey(olc::Key::P).bPressed) {
+      PDP8_EmulatorCommand(&emulator, PDP8_COMMAND_REAL_TIME, 0);
+    }
+    
+    if (GetKey(olc::Key::MINUS).bPressed || GetKey(olc::Key::EQUALS).bPressed) {
+      if (view.throttle == PDP8_THROTTLE_INSTRUCTIONS) {
+        if (GetKey(olc::Key::MINUS).bPressed && steps_per_frame > 1) steps_per_frame /= 2;
+        if (GetKey(olc::Key::EQUALS).bPressed && steps_per_frame < (1 << 24)) steps_per_frame *= 2;
+      }
+      PDP8_EmulatorCommand(&emulator, PDP8_COMMAND_SPEED, steps_per_frame * FRAME_RATE);
+    }
+    
+    // step back, or back to the last time the next instruction ran
+    if (GetKey(olc::Key::B).bPressed) {
+      PDP8_EmulatorCommand(&emulator, PDP8_COMMAND_BACK, 0);
+    }
+    
+    if (GetKey(olc::Key::V).bPressed) {
+      PDP8_EmulatorCommand(&emulator, PDP8_COMMAND_REVERSE, 0);
+    }
+    
+    if (GetKey(olc::Key::T).bPressed) {
+      PDP8_EmulatorCommand(&emulator, PDP8_COMMAND_TRACE, 0);
     }
     
     if (GetKey(olc::Key::R).bPressed) {
-      PDP8_Reset(&pdp8);
-      PDP8_MemoryReset(&pdp8);
-      PDP8_ReloadProgram(&pdp8, &program);
+      PDP8_EmulatorCommand(&emulator, PDP8_COMMAND_RESET, 0);
     }
     
     if (GetKey(olc::Key::M).bPressed) {
-      PDP8_MemoryReset(&pdp8);
+      PDP8_EmulatorCommand(&emulator, PDP8_COMMAND_CLEAR, 0);
     }
     
-    if (GetKey(olc::Key::PGDN).bPressed) {
-      page++;
-      page &= 31;
+    // scroll memory, or jump to an address or the next instruction
+    if (GetKey(olc::Key::UP).bPressed) ScrollTo((long)top - 1);
+    if (GetKey(olc::Key::DOWN).bPressed) ScrollTo((long)top + 1);
+    if (GetKey(olc::Key::PGUP).bPressed) ScrollTo((long)top - MemoryRows());
+    if (GetKey(olc::Key::PGDN).bPressed) ScrollTo((long)top + MemoryRows());
+    if (GetKey(olc::Key::HOME).bPressed) ScrollTo(0);
+    if (GetKey(olc::Key::END).bPressed) ScrollTo(PDP8_MEMORY_SIZE);
+    if (GetMouseWheel() > 0) ScrollTo((long)top - 4);
+    if (GetMouseWheel() < 0) ScrollTo((long)top + 4);
+    
+    if (GetKey(olc::Key::J).bPressed) {
+      jumping = true;
+      jump.clear();
     }
     
-    if (GetKey(olc::Key::PGUP).bPressed) {
-      page--;
-      page &= 31;
+    if (GetKey(olc::Key::PERIOD).bPressed) {
+      Show(view.pdp8.pc);
     }
     
     if (GetKey(olc::Key::O).bPressed) {
-      format_number = [&] (uint n) { return octal(n, 4); };
+      numbers = octal_numbers;
     }
     
     if (GetKey(olc::Key::H).bPressed) {
-      format_number = [&] (uint n) { return hex(n, 3); };
+      numbers = hex_numbers;
+    }
+    
+    if (GetKey(olc::Key::F).bPressed) {
+      PDP8_EmulatorCommand(&emulator, PDP8_COMMAND_PANEL, 0);
     }
     
-    DrawString(10, 12, "PAGE: " + std::to_string(page));
-    DrawMemory(2, 32, page << 7, 16, 8);
+    Draw();
+    
+    return true;
+  }
+  
+  void Draw() {
+    Clear(olc::DARK_BLUE);
+    if (!frame) Show(view.pdp8.pc);
+    ScrollTo(top);
+    if (jumping) {
+      DrawString(10, 12, Line("JUMP TO: %s_", jump.c_str()), olc::YELLOW);
+    } else {
+      line.assign("MEMORY: ");
+      AppendAddress(line, top);
+      line.append("-");
+      AppendAddress(line, top + MemoryRows() - 1);
+      DrawString(10, 12, line);
+    }
+    DrawMemory(2, 32, MemoryRows());
     DrawCPU(400, 12);
+    if (view.panel) DrawPanel(10, 262);
     
     //DrawString(10, 370, "SPACE = Step Instruction    R = RESET    I = IRQ    N = NMI");
+  }
+  
+  // Draws frames without a window: moves the machine to each instruction
+  // count in turn and saves the screen as prefix-count.png. The lamps show
+  // the average since the previous capture.
+  bool Capture(const uint64_t *counts, uint count, const char *prefix) {
+    olc_ConstructFontSheet();
+    olc::Sprite screen(SCREEN_WIDTH, SCREEN_HEIGHT);
+    SetDrawTarget(&screen);
+    if (!OnUserCreate()) return false;
     
-    return true;
+    bool ok = true;
+    for (uint i = 0; i < count && ok; ++i) {
+      PDP8_EmulatorCommand(&emulator, PDP8_COMMAND_SEEK, counts[i]);
+      PDP8_EmulatorWait(&emulator, &view);
+      if (view.instructions != counts[i]) {
+        fprintf(stderr, "halted after %llu instructions\n", (unsigned long long)view.instructions);
+      }
+      Show(view.pdp8.pc);
+      Draw();
+      
+      std::string file_name = Line("%s-%llu.png", prefix, (unsigned long long)counts[i]);
+      if (olc::Sprite::loader->SaveImageResource(&screen, file_name) != olc::rcode::OK) {
+        fprintf(stderr, "%s: can't write\n", file_name.c_str());
+        ok = false;
+      }
+    }
+    
+    OnUserDestroy();
+    return ok;
   }
 };
 
+char Demo_PDP8::octal_numbers[PDP8_MEMORY_SIZE][5];
+char Demo_PDP8::hex_numbers[PDP8_MEMORY_SIZE][5];
+char Demo_PDP8::binary_numbers[PDP8_MEMORY_SIZE][13];
+
+static int usage(const char *name) {
+  fprintf(stderr, "usage: %s [image] [-g start] [-s switches] [-d address=value]... [-l listing]\n", name);
+  fprintf(stderr, "          [-c instructions]... [-o prefix]\n");
+  fprintf(stderr, "  image is a .pal source, a .bin or .rim tape or a text image; numbers are octal\n");
+  fprintf(stderr, "  symbols come from the .pal source, the listing, or image.lst when present\n");
+  fprintf(stderr, "  -c saves the screen at an instruction count to prefix-count.png, without a window\n");
+  return 1;
+}
 
-int main() {
+int main(int argc, char **argv) {
   Demo_PDP8 demo;
-  if (demo.Construct(680, 480, 2, 2)) {
+  
+  const char *file_name = NULL;
+  int start = PDP8_NO_START;
+  struct PDP8_Image deposits;
+  PDP8_ImageInit(&deposits);
+  uint64_t captures[MAX_CAPTURES];
+  uint capture_count = 0;
+  const char *prefix = "pdp8";
+  const char *listing = NULL;
+  
+  for (int i = 1; i < argc; ++i) {
+    const char *arg = argv[i];
+    uint address, value;
+    if (arg[0] != '-') {
+      if (file_name) return usage(argv[0]);
+      file_name = arg;
+    } else if (i + 1 >= argc) {
+      return usage(argv[0]);
+    } else if (!strcmp(arg, "-g") && PDP8_ParseOctal(argv[++i], &address)) {
+      start = address;
+    } else if (!strcmp(arg, "-s") && PDP8_ParseOctal(argv[++i], &value)) {
+      demo.initial_switches = value;
+    } else if (!strcmp(arg, "-d") && PDP8_ParseDeposit(argv[++i], &address, &value)) {
+      PDP8_ImageDeposit(&deposits, address, value);
+    } else if (!strcmp(arg, "-c") && capture_count < MAX_CAPTURES) {
+      captures[capture_count++] = strtoull(argv[++i], NULL, 10);
+    } else if (!strcmp(arg, "-l")) {
+      listing = argv[++i];
+    } else if (!strcmp(arg, "-o")) {
+      prefix = argv[++i];
+    } else {
+      return usage(argv[0]);
+    }
+  }
+  
+  bool compare_demo = !file_name;
+  if (compare_demo) {
+    file_name = "../program/compare.bin";
+  }
+  
+  if (PDP8_ImageFromFileWithSymbols(&demo.image, &demo.symbols, file_name, listing) != PDP8_OK) {
+    return 1;
+  }
+  PDP8_SymbolsByAddress(&demo.symbols, demo.names);
+  if (compare_demo) { // compare.lst operands
+    PDP8_ImageDeposit(&demo.image, 00070, 32);
+    PDP8_ImageDeposit(&demo.image, 00100, 30);
+  }
+  for (uint i = 0; i < deposits.deposit_count; ++i) {
+    PDP8_ImageDeposit(&demo.image, deposits.deposits[i].address, deposits.deposits[i].value);
+  }
+  PDP8_ImageFree(&deposits);
+  if (start != PDP8_NO_START) {
+    demo.image.start = start;
+  }
+  
+  if (capture_count) {
+    return demo.Capture(captures, capture_count, prefix) ? 0 : 1;
+  }
+  
+  if (demo.Construct(SCREEN_WIDTH, SCREEN_HEIGHT, 2, 2)) {
     demo.Start();
   }
   
   return 0;
-}
\ No newline at end of file
+}
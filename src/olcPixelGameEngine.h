@@ -956,6 +956,7 @@ namespace olc
     std::function<olc::Pixel(const int x, const int y, const olc::Pixel&, const olc::Pixel&)> funcPixelMode;
     std::chrono::time_point<std::chrono::system_clock> m_tp1, m_tp2;
     std::vector<olc::vi2d> vFontSpacing;
+    uint8_t     vFontRows[96][8] = { { 0 } }; // glyph rows, bit i set for column i
     
     // State of keyboard		
     bool		pKeyNewState[256] = { 0 };
@@ -2572,6 +2573,41 @@ namespace olc
   {
     int32_t sx = 0;
     int32_t sy = 0;
+    
+    // Fast path for opaque unscaled text: glyph rows are written straight
+    // into the draw target, clipped a row at a time
+    if (scale == 1 && col.a == 255 && pDrawTarget)
+    {
+      Pixel* data = pDrawTarget->GetData();
+      int32_t w = pDrawTarget->width, h = pDrawTarget->height;
+      for (auto c : sText)
+      {
+        if (c == '\n')
+        {
+          sx = 0; sy += 8;
+          continue;
+        }
+        
+        int32_t gx = x + sx;
+        int32_t lo = std::max(0, -gx), hi = std::min(8, w - gx);
+        uint32_t g = uint32_t(uint8_t(c)) - 32;
+        if (g < 96 && lo < hi)
+        {
+          for (int32_t j = 0; j < 8; j++)
+          {
+            int32_t gy = y + sy + j;
+            uint32_t bits = vFontRows[g][j];
+            if (gy < 0 || gy >= h || !bits) continue;
+            Pixel* row = data + gy * w;
+            for (int32_t i = lo; i < hi; i++)
+              if (bits & (1 << i)) row[gx + i] = col;
+          }
+        }
+        sx += 8;
+      }
+      return;
+    }
+    
     Pixel::Mode m = nPixelMode;
     // Thanks @tucna, spotted bug with col.ALPHA :P
     if (col.a != 255)		SetPixelMode(Pixel::ALPHA);
@@ -2963,6 +2999,15 @@ namespace olc
       }
     }
     
+    for (int c = 0; c < 96; c++)
+      for (int j = 0; j < 8; j++)
+      {
+        uint8_t bits = 0;
+        for (int i = 0; i < 8; i++)
+          if (fontSprite->GetPixel(i + (c % 16) * 8, j + (c / 16) * 8).r > 0) bits |= 1 << i;
+        vFontRows[c][j] = bits;
+      }
+    
     fontDecal = new olc::Decal(fontSprite);
     
     constexpr std::array<uint8_t, 96> vSpacing = { {
@@ -3546,7 +3591,33 @@ namespace olc
     
     olc::rcode SaveImageResource(olc::Sprite* spr, const std::string& sImageFile) override
     {
-      return olc::rcode::OK;
+      // olc::Pixel is laid out r, g, b, a, so sprite rows are written as
+      // 8-bit RGBA rows as they are
+      FILE* f = fopen(sImageFile.c_str(), "wb");
+      if (!f) return olc::rcode::NO_FILE;
+      
+      std::vector<png_bytep> row_pointers(spr->height);
+      for (int y = 0; y < spr->height; y++)
+        row_pointers[y] = (png_bytep)(spr->GetData() + y * spr->width);
+      
+      png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+      png_infop info = png ? png_create_info_struct(png) : nullptr;
+      if (!info || setjmp(png_jmpbuf(png)))
+      {
+        png_destroy_write_struct(&png, &info);
+        fclose(f);
+        return olc::rcode::FAIL;
+      }
+      
+      png_init_io(png, f);
+      png_set_IHDR(png, info, spr->width, spr->height, 8, PNG_COLOR_TYPE_RGB_ALPHA,
+                   PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+      png_write_info(png, info);
+      png_write_image(png, row_pointers.data());
+      png_write_end(png, nullptr);
+      png_destroy_write_struct(&png, &info);
+      
+      return fclose(f) == 0 ? olc::rcode::OK : olc::rcode::FAIL;
     }
   };
 }
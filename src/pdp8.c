@@ -4,97 +4,90 @@
 #include <stdlib.h>
 
 #include "pdp8.h"
+#include "instruction.h"
+#include "profile.h"
+#include "stats.h"
+#include "lamps.h"
+#include "watchpoint.h"
 
 #define UNUSED(x) (void)(x)
 
-#define PDP8_BMASK(b) (1 << (11 - b))
-#define PDP8_MASK(l, h) (((1 << ((h) - (l) + 1)) - 1) << (11 - (h)))
-
-enum INSTRUCTION_FORMAT_MASK {
-  OPCODE       = PDP8_MASK(0, 2),  // op\operation.code<0:2> := i<0:2>
-  INDIRECT_BIT = PDP8_BMASK(3),    // ib\indirect.bit< >     := i<3>
-  PAGE_BIT     = PDP8_BMASK(4),    // pb\page.0.bit  < >     := i<4>
-  PAGE_ADDRESS = PDP8_MASK(5, 11), // pa\page.address<0:6>   := i<5:11>
-  CURRENT_PAGE = PDP8_MASK(0, 4),
-};
-
-enum IO_MASK {
-  IO_SELECT    = PDP8_MASK(3, 8),  // IO.SELECT<0:5>   := i<3:8>   !device select
-  IO_CONTROL   = PDP8_MASK(9, 11), // io.control<0:2>  := i<9:11>  !device operation
-  IO_PULSE_P1  = PDP8_BMASK(9),    //   IO.PULSE.P1< > := io.control<0>
-  IO_PULSE_P2  = PDP8_BMASK(10),   //   IO.PULSE.P2< > := io.control<1>
-  IO_PULSE_P4  = PDP8_BMASK(11),   //   IO.PULSE.P4< > := io.control<2>
-  IO_MICROOP   = PDP8_MASK(3, 11),
+// Memory cycles per instruction indexed by op and ib (i<0:3>): fetch, plus
+// defer for indirect memory references, plus execute for all but JMP.
+static const uint8_t instruction_cycles[16] = {
+  2, 3, 2, 3, 2, 3, 2, 3, 2, 3, 1, 2, 1, 1, 1, 1,
 };
 
-enum OPR_MASK {
-  OPR_GROUP = PDP8_BMASK(3),  // group< > := i<3>   !microinstruction group
-  OPR_SMA   = PDP8_BMASK(5),  // sma< >   := i<5>   !skip on minus AC
-  OPR_SPA   = PDP8_BMASK(5),  // spa< >   := i<5>   !skip on positive AC
-  OPR_SZA   = PDP8_BMASK(6),  // sza< >   := i<6>   !skip on zero AC
-  OPR_SNA   = PDP8_BMASK(6),  // sna< >   := i<6>   !skip on AC not zero
-  OPR_SZL   = PDP8_BMASK(7),  // szl< >   := i<7>   !skip on zero L
-  OPR_SNL   = PDP8_BMASK(7),  // snl< >   := i<7>   !skip on L not zero
-  OPR_IS    = PDP8_BMASK(8),  // is< >    := i<8>   !invert skip sense
-  
-  OPR_CLA   = PDP8_BMASK(4),  // cla< >   := i<4>   !clear AC
-  OPR_CLL   = PDP8_BMASK(5),  // cll< >   := i<5>   !clear L
-  OPR_CMA   = PDP8_BMASK(6),  // cma< >   := i<6>   !complement AC
-  OPR_CML   = PDP8_BMASK(7),  // cml< >   := i<7>   !complement L
-  OPR_RAR   = PDP8_BMASK(8),  // rar< >   := i<8>   !rotate right
-  OPR_RAL   = PDP8_BMASK(9),  // ral< >   := i<9>   !rotate left
-  OPR_RT    = PDP8_BMASK(10), // rt< >    := i<10>  !rotate twice
-  OPR_IAC   = PDP8_BMASK(11), // iac< >   := i<11>  !increment AC
-  
-  OPR_OSR   = PDP8_BMASK(9),  // osr< >   := i<9>   !logical or AC with SWITCHES
+// Slow path for accesses to a page holding a watchpoint; only the first
+// hit of an instruction is kept.
+static void watch(struct PDP8 *pdp8, uint access, uint value) {
+  struct PDP8_Watchpoints *watchpoints = pdp8->watchpoints;
+  if (!(watchpoints->watch[pdp8->ma] & access)) return;
   
-  OPR_HLT   = PDP8_BMASK(10), // hlt< >   := i<10>  !halt the processor
-};
+  watchpoints->hits++;
+  if (watchpoints->hit) return;
+  watchpoints->hit = true;
+  watchpoints->address = pdp8->ma;
+  watchpoints->access = access;
+  watchpoints->old_value = pdp8->memory[pdp8->ma];
+  watchpoints->value = value;
+  watchpoints->pc = pdp8->last_pc;
+}
+
+// watching is a constant wherever it is inlined, so the engine is
+// compiled once with the page test and once without any.
+static inline bool watched(const struct PDP8 *pdp8, bool watching) {
+  return watching && (pdp8->watch_pages & (1u << (pdp8->ma / PDP8_WATCH_PAGE_SIZE)));
+}
 
-inline void memory_read(struct PDP8 *pdp8) {
+inline void memory_read(struct PDP8 *pdp8, bool watching) {
+  if (watched(pdp8, watching)) watch(pdp8, PDP8_WATCH_READ, pdp8->memory[pdp8->ma]);
   pdp8->mb = pdp8->memory[pdp8->ma];
+  if (pdp8->profile) pdp8->profile->reads[pdp8->ma]++;
 }
 
-inline uint PDP8_MemoryRead(struct PDP8 *pdp8, uint address) {
+uint PDP8_MemoryRead(struct PDP8 *pdp8, uint address) {
   pdp8->ma = address;
-  memory_read(pdp8);
+  memory_read(pdp8, true);
   return pdp8->mb;
 }
 
-inline void memory_write(struct PDP8 *pdp8) {
+inline void memory_write(struct PDP8 *pdp8, bool watching) {
+  if (watched(pdp8, watching)) watch(pdp8, PDP8_WATCH_WRITE, pdp8->mb);
   pdp8->memory[pdp8->ma] = pdp8->mb;
+  if (pdp8->profile) pdp8->profile->writes[pdp8->ma]++;
 }
 
-inline void PDP8_MemoryWrite(struct PDP8 *pdp8, uint address, uint value) {
+void PDP8_MemoryWrite(struct PDP8 *pdp8, uint address, uint value) {
   pdp8->ma = address;
   pdp8->mb = value;
-  memory_write(pdp8);
+  memory_write(pdp8, true);
 }
 
-void effective_address(struct PDP8 *pdp8) {
+static inline void effective_address(struct PDP8 *pdp8, bool watching) {
   uint ir      = pdp8->ir;
   uint last_pc = pdp8->last_pc;
   
-  // page bit * page address + page offset
-  uint eadd = ((bool)(ir & PAGE_BIT)) * (last_pc & CURRENT_PAGE) + (ir & PAGE_ADDRESS);
+  uint eadd = PDP8_DirectAddress(ir, last_pc);
   
   if ((ir & INDIRECT_BIT) == 0) {
     pdp8->ma = eadd;
     return;
   }
   
-  // auto index
-  uint ceadd = PDP8_MemoryRead(pdp8, eadd);
-  if (eadd > 010 && eadd < 017) {
-    ceadd = (ceadd + 1) & PDP8_WORD_MASK;
-    PDP8_MemoryWrite(pdp8, eadd, ceadd);
+  pdp8->ma = eadd;
+  memory_read(pdp8, watching);
+  uint ceadd = PDP8_IndirectAddress(eadd, pdp8->mb);
+  if (PDP8_AutoIndex(eadd)) {
+    pdp8->mb = ceadd;
+    memory_write(pdp8, watching);
   }
   
   pdp8->ma = ceadd;
 }
 
 inline uint PDP8_EffectiveAddress(struct PDP8 *pdp8) {
-  effective_address(pdp8);
+  effective_address(pdp8, true);
   return pdp8->ma;
 }
 
@@ -103,17 +96,13 @@ void skip(struct PDP8 *pdp8) {
   uint ac   = pdp8->ac;
   uint link = pdp8->link;
   
+  // SMA, SZA and SNL are or'ed; IS inverts the result, giving SPA, SNA
+  // and SZL and'ed, or SKP when none is selected
   bool skip = false;
-  if (ir & OPR_IS) { // invert skip condition
-    if ((ir & OPR_SZL & OPR_SNA & OPR_SPA) == 0)  skip = true;
-    if ((ir & OPR_SZL) && (link == 0))            skip = true;
-    if ((ir & OPR_SNA) && (ac > 0))               skip = true;
-    if ((ir & OPR_SPA) && (ac < PDP8_WORD_SIGN))  skip = true;
-  } else {
-    if ((ir & OPR_SNL) && (link == 1))            skip = true;
-    if ((ir & OPR_SZA) && (ac == 0))              skip = true;
-    if ((ir & OPR_SMA) && (ac >= PDP8_WORD_SIGN)) skip = true;
-  }
+  if ((ir & OPR_SMA) && (ac >= PDP8_WORD_SIGN)) skip = true;
+  if ((ir & OPR_SZA) && (ac == 0))              skip = true;
+  if ((ir & OPR_SNL) && (link == 1))            skip = true;
+  if (ir & OPR_IS) skip = !skip;
   
   if (skip) {
     pdp8->pc = (pdp8->pc + 1) & PDP8_WORD_MASK;
@@ -123,10 +112,20 @@ void skip(struct PDP8 *pdp8) {
 void operate(struct PDP8 *pdp8) {
   uint ir = pdp8->ir;
   if (ir & OPR_GROUP) { // group 2 and 3
-    if (ir & 1) { // group 3
+    if (ir & OPR_GROUP3) { // group 3
       if (ir & OPR_CLA) {
         pdp8->ac = 0;
       }
+      if ((ir & OPR_MQA) && (ir & OPR_MQL)) { // swp
+        uint mq = pdp8->mq;
+        pdp8->mq = pdp8->ac;
+        pdp8->ac = mq;
+      } else if (ir & OPR_MQL) { // mql
+        pdp8->mq = pdp8->ac;
+        pdp8->ac = 0;
+      } else if (ir & OPR_MQA) { // mqa
+        pdp8->ac |= pdp8->mq;
+      }
     } else {
       skip(pdp8);
       if (ir & OPR_CLA) {
@@ -175,64 +174,123 @@ void operate(struct PDP8 *pdp8) {
   }
 }
 
-void execute(struct PDP8 *pdp8) {
+static inline bool interrupt_pending(const struct PDP8 *pdp8) {
+  return pdp8->interrupt_request || pdp8->keyboard_flag || pdp8->printer_flag;
+}
+
+static inline void skip_if(struct PDP8 *pdp8, bool condition) {
+  if (condition) {
+    pdp8->pc = (pdp8->pc + 1) & PDP8_WORD_MASK;
+  }
+}
+
+void processor_iot(struct PDP8 *pdp8) {
+  switch (pdp8->ir & IO_CONTROL) {
+    case 0: { // SKON - Skip if Interrupt System On, and turn it off
+      skip_if(pdp8, pdp8->interrupt_enable);
+      pdp8->interrupt_enable = false;
+    } break;
+    case 1: { // ION - Interrupt System On
+      pdp8->interrupt_enable = true;
+      pdp8->restart = true;
+    } break;
+    case 2: { // IOF - Interrupt System Off
+      pdp8->interrupt_enable = false;
+    } break;
+    case 3: { // SRQ - Skip on Interrupt Request
+      skip_if(pdp8, interrupt_pending(pdp8));
+    } break;
+  }
+}
+
+void keyboard_iot(struct PDP8 *pdp8) {
+  uint ir = pdp8->ir;
+  if (ir & IO_PULSE_P1) { // KSF - Skip on Keyboard Flag
+    skip_if(pdp8, pdp8->keyboard_flag);
+  }
+  if (ir & IO_PULSE_P2) { // KCC - Clear Keyboard Flag and AC
+    pdp8->keyboard_flag = false;
+    pdp8->ac = 0;
+  }
+  if (ir & IO_PULSE_P4) { // KRS - Read Keyboard Buffer Static
+    pdp8->ac |= pdp8->keyboard_buffer;
+  }
+}
+
+// The printer completes at once: the flag is set as the character leaves.
+void printer_iot(struct PDP8 *pdp8) {
+  uint ir = pdp8->ir;
+  if (ir & IO_PULSE_P1) { // TSF - Skip on Printer Flag
+    skip_if(pdp8, pdp8->printer_flag);
+  }
+  if (ir & IO_PULSE_P2) { // TCF - Clear Printer Flag
+    pdp8->printer_flag = false;
+  }
+  if (ir & IO_PULSE_P4) { // TPC - Load Printer Buffer and Print
+    pdp8->printer_buffer = pdp8->ac;
+    if (pdp8->print) pdp8->print(pdp8->print_context, pdp8->printer_buffer);
+    pdp8->printer_flag = true;
+  }
+}
+
+void iot(struct PDP8 *pdp8) {
+  switch ((pdp8->ir & IO_SELECT) >> 3) {
+    case 000: processor_iot(pdp8); break;
+    case 003: keyboard_iot(pdp8); break;
+    case 004: printer_iot(pdp8); break;
+  }
+}
+
+static inline void execute(struct PDP8 *pdp8, bool watching) {
   uint ir = pdp8->ir;
   
   switch ((ir & OPCODE) >> 9) {
     case 000: { // AND
-      effective_address(pdp8);
-      memory_read(pdp8);
+      effective_address(pdp8, watching);
+      memory_read(pdp8, watching);
       
       pdp8->ac = pdp8->ac & pdp8->mb;
     } break;
     case 001: { // TAD
-      effective_address(pdp8);
-      memory_read(pdp8);
+      effective_address(pdp8, watching);
+      memory_read(pdp8, watching);
       
       pdp8->lac = pdp8->lac + pdp8->mb;
     } break;
     case 002: { // ISZ
-      effective_address(pdp8);
-      memory_read(pdp8);
+      effective_address(pdp8, watching);
+      memory_read(pdp8, watching);
       
       pdp8->mb = (pdp8->mb + 1) & PDP8_WORD_MASK;
-      memory_write(pdp8);
+      memory_write(pdp8, watching);
       
       if (pdp8->mb == 0) {
         pdp8->pc++;
       }
     } break;
     case 003: { // DCA
-      effective_address(pdp8);
+      effective_address(pdp8, watching);
       
       pdp8->mb = pdp8->ac;
-      memory_write(pdp8);
+      memory_write(pdp8, watching);
       
       pdp8->ac = 0;
     } break;
     case 004: { // JMS
-      effective_address(pdp8);
+      effective_address(pdp8, watching);
       
       pdp8->mb = pdp8->pc;
-      memory_write(pdp8);
+      memory_write(pdp8, watching);
       
       pdp8->pc = (pdp8->ma + 1) & PDP8_WORD_MASK;
     } break;
     case 005: { // JMP
-      effective_address(pdp8);
+      effective_address(pdp8, watching);
       
       pdp8->pc = pdp8->ma;
     } break;
     case 006: { // IOT
-      switch (ir & IO_MICROOP) {
-        case 001: { // ION - Interrupt System On
-          pdp8->interrupt_enable = true;
-          pdp8->restart = true;
-        } break;
-        case 002: { // IOF - Interrupt System Off
-          pdp8->interrupt_enable = false;
-        } break;
-      }
+      iot(pdp8);
     } break;
     case 007: { // OPR
       operate(pdp8);
@@ -252,6 +310,7 @@ void PDP8_Reset(struct PDP8 *pdp8) {
   
   pdp8->link = false;
   pdp8->ac = 0;
+  pdp8->mq = 0;
   pdp8->pc = 0;
   pdp8->run = false;
   pdp8->interrupt_enable = false;
@@ -259,66 +318,86 @@ void PDP8_Reset(struct PDP8 *pdp8) {
   pdp8->interrupt_request = false;
   pdp8->switches = 0;
   
+  pdp8->keyboard_flag = false;
+  pdp8->keyboard_buffer = 0;
+  pdp8->printer_flag = false;
+  pdp8->printer_buffer = 0;
+  
   pdp8->ir = 0;
   pdp8->last_pc = 0;
   pdp8->restart = false;
+  
+  pdp8->cycles = 0;
+  pdp8->profile = NULL;
+  pdp8->stats = NULL;
+  pdp8->lamps = NULL;
+  pdp8->watchpoints = NULL;
+  pdp8->watch_pages = 0;
+  pdp8->print = NULL;
+  pdp8->print_context = NULL;
 }
 
-void PDP8_Load(struct PDP8 *pdp8, struct PDP8_Program *program) {
-  for (int addr = 0; addr < program->code_length; ++addr) {
-    pdp8->memory[addr] = program->code[addr];
-  }
-}
-
-#define MAX_CODE_LENGTH 4096
-
-struct PDP8_Program PDP8_BinaryToProgram(const char *file_name) {
-  FILE *file;
+// Everything is derived from the executed instruction so the execute paths
+// stay untouched: a skip was taken when PC moved on by two.
+static inline void count_stats(struct PDP8_Stats *stats, uint ir, uint last_pc, uint pc) {
+  uint opcode = ir >> 9;
+  stats->opcodes[opcode]++;
   
-  file = fopen(file_name, "rb");
-  if (!file) {
-    fprintf(stderr, "Error opening file: %s", file_name);
-    exit(1);
+  if (opcode < PDP8_IOT) {
+    if (ir & INDIRECT_BIT) {
+      stats->indirect++;
+      if (PDP8_AutoIndex(PDP8_DirectAddress(ir, last_pc))) stats->auto_index++;
+    } else {
+      stats->direct++;
+    }
+    if (ir & PAGE_BIT) stats->current_page++;
+    else stats->page_zero++;
+  } else if (opcode == PDP8_IOT) {
+    stats->iots[(ir & IO_SELECT) >> 3]++;
   }
   
-  struct PDP8_Program program;
-  unsigned char buffer[2];
-  program.code_length = 0;
-  while (fread(buffer, 2, 1, file) == 1) {
-    program.code[program.code_length] = ((buffer[0] << 6) + buffer[1]) & PDP8_WORD_MASK;
-    program.code_length++;
+  bool conditional = opcode == PDP8_ISZ || (opcode == PDP8_OPR && (ir & (OPR_GROUP | OPR_GROUP3)) == OPR_GROUP &&
+                                           (ir & (OPR_SMA | OPR_SZA | OPR_SNL | OPR_IS)));
+  if (conditional) {
+    if (pc == ((last_pc + 2) & PDP8_WORD_MASK)) stats->skips_taken++;
+    else stats->skips_not_taken++;
   }
-  
-  fclose(file);
-  
-  return program;
-}
-
-void PDP8_ReloadProgram(struct PDP8 *pdp8, struct PDP8_Program *program) {
-  // compare.lst
-  PDP8_Load(pdp8, program);
-  
-  pdp8->memory[00070] = 32;
-  pdp8->memory[00100] = 30;
-  
-  pdp8->pc = 00170;
 }
 
 bool PDP8_Step(struct PDP8 *pdp8) {
-  pdp8->ir = PDP8_MemoryRead(pdp8, pdp8->pc);
+  // fetch; counted as an execution rather than a data read
+  pdp8->ma = pdp8->pc;
+  pdp8->mb = pdp8->memory[pdp8->ma];
+  pdp8->ir = pdp8->mb;
   pdp8->last_pc = pdp8->pc;
   
   pdp8->pc++;
-  execute(pdp8);
+  if (pdp8->watch_pages) execute(pdp8, true);
+  else execute(pdp8, false);
   
-  if (pdp8->restart) return true;
+  uint cycles = instruction_cycles[pdp8->ir >> 8];
+  pdp8->cycles += cycles;
+  if (pdp8->profile) {
+    pdp8->profile->executions[pdp8->last_pc]++;
+    pdp8->profile->cycles[pdp8->last_pc] += cycles;
+  }
+  if (pdp8->stats) count_stats(pdp8->stats, pdp8->ir, pdp8->last_pc, pdp8->pc);
+  if (pdp8->lamps) PDP8_LampsCount(pdp8->lamps, pdp8);
   
-  if (pdp8->interrupt_enable && pdp8->interrupt_request) {
+  // ION takes effect after the next instruction
+  if (pdp8->restart) {
+    pdp8->restart = false;
+    return pdp8->run;
+  }
+  
+  // an interrupt is a JMS 0 with the interrupt system turned off
+  if (pdp8->interrupt_enable && interrupt_pending(pdp8)) {
+    pdp8->interrupt_enable = false;
     PDP8_MemoryWrite(pdp8, 0, pdp8->pc);
     pdp8->pc = 1;
   }
   
-  return true;
+  return pdp8->run;
 }
 
 bool PDP8_Run(struct PDP8 *pdp8) {
@@ -329,3 +408,49 @@ bool PDP8_Run(struct PDP8 *pdp8) {
   return run;
 }
 
+// Runs until RUN is cleared or budget instructions have executed.
+int PDP8_RunFor(struct PDP8 *pdp8, uint64_t budget, uint64_t *executed) {
+  uint64_t count = 0;
+  while (pdp8->run && count < budget) {
+    PDP8_Step(pdp8);
+    count++;
+  }
+  
+  if (executed) *executed = count;
+  return pdp8->run ? PDP8_STOP_BUDGET : PDP8_STOP_HALT;
+}
+
+static uint64_t mix(uint64_t h, uint64_t value) {
+  return (h ^ value) * 1099511628211ull;
+}
+
+// FNV-1a over the architectural state: registers, cycle count and memory.
+uint64_t PDP8_StateHash(const struct PDP8 *pdp8) {
+  uint64_t h = 14695981039346656037ull;
+  h = mix(h, pdp8->ma);
+  h = mix(h, pdp8->mb);
+  h = mix(h, pdp8->lac);
+  h = mix(h, pdp8->mq);
+  h = mix(h, pdp8->pc);
+  h = mix(h, pdp8->run);
+  h = mix(h, pdp8->interrupt_enable);
+  h = mix(h, pdp8->interrupt_request);
+  h = mix(h, pdp8->switches);
+  h = mix(h, pdp8->keyboard_flag);
+  h = mix(h, pdp8->keyboard_buffer);
+  h = mix(h, pdp8->printer_flag);
+  h = mix(h, pdp8->printer_buffer);
+  h = mix(h, pdp8->ir);
+  h = mix(h, pdp8->last_pc);
+  h = mix(h, pdp8->restart);
+  h = mix(h, pdp8->cycles);
+  for (uint i = 0; i < PDP8_MEMORY_SIZE; ++i) {
+    h = mix(h, pdp8->memory[i]);
+  }
+  return h;
+}
+
+void PDP8_KeyboardInput(struct PDP8 *pdp8, uint c) {
+  pdp8->keyboard_buffer = c;
+  pdp8->keyboard_flag = true;
+}
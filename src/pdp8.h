@@ -5,6 +5,7 @@ extern "C" {
 #ifndef PDP8_H
 #define PDP8_H
   
+#include <stdbool.h>
 #include <stdint.h>
   
   typedef unsigned int uint;
@@ -16,6 +17,10 @@ extern "C" {
     PDP8_MEMORY_SIZE = 4096,
   };
   
+  struct PDP8_Profile;
+  struct PDP8_Stats;
+  struct PDP8_Lamps;
+  
   struct PDP8 {
     uint memory[PDP8_MEMORY_SIZE]; //  M\Memory[0:4095]<0:11>
     uint ma                : 12;   //  MA\Memory.Address<0:11>
@@ -29,6 +34,7 @@ extern "C" {
         uint link          :  1;   //    L\Link< >            := LAC<0>
       };
     };
+    uint mq                : 12;   //  MQ\Multiplier.Quotient<0:11>
     uint pc                : 12;   //  PC\Program.Counter<0:11>
     uint run               :  1;   //  RUN< >
     uint interrupt_enable  :  1;   //  INTERRUPT.ENABLE< >
@@ -37,23 +43,48 @@ extern "C" {
     uint interrupt_request :  1;   //  INTERRUPT.REQUEST< >
     uint switches          : 12;   //  SWITCHES<0:11>
     
+    // Teletype: keyboard (device 03) and printer (device 04)
+    uint keyboard_flag     :  1;   //  KBD.FLAG< >
+    uint keyboard_buffer   :  8;   //  KBD.BUFFER<0:7>
+    uint printer_flag      :  1;   //  TTO.FLAG< >
+    uint printer_buffer    :  8;   //  TTO.BUFFER<0:7>
+    
     uint ir                : 12;   //  i\instruction<0:11>
     uint last_pc           : 12;   //  last.pc<0:11>
     uint restart           :  1;
+    
+    uint64_t cycles;                //  memory cycles since reset
+    
+    struct PDP8_Profile *profile;   //  per-address counters or NULL
+    struct PDP8_Stats *stats;       //  instruction mix counters or NULL
+    struct PDP8_Lamps *lamps;       //  front panel lamp counters or NULL
+    struct PDP8_Watchpoints *watchpoints; // data watchpoints or NULL
+    uint32_t watch_pages;           //  pages holding a watchpoint, bit n for page n
+    
+    void (*print)(void *context, uint c); // printer output or NULL
+    void *print_context;
   };
   
-  struct PDP8_Program {
-    uint code_length;
-    uint code[4096];
+  enum PDP8_StopReason {
+    PDP8_STOP_HALT,                 //  RUN cleared, e.g. by HLT
+    PDP8_STOP_BUDGET,               //  instruction budget used up
+    PDP8_STOP_END,                  //  end of a replayed input log
+    PDP8_STOP_BREAKPOINT,           //  before an instruction at a breakpoint
+    PDP8_STOP_WATCHPOINT,           //  after an instruction that touched a watchpoint
   };
   
-  extern struct PDP8_Program PDP8_BinaryToProgram(const char *file_name);
-  extern void PDP8_ReloadProgram(struct PDP8 *pdp8, struct PDP8_Program *program);
   extern void PDP8_Reset(struct PDP8 *pdp8);
   extern void PDP8_MemoryReset(struct PDP8 *pdp8);
   extern bool PDP8_Step(struct PDP8 *pdp8);
   extern bool PDP8_Run(struct PDP8 *pdp8);
-  extern void PDP8_Load(struct PDP8 *pdp8, struct PDP8_Program *program);
+  extern int  PDP8_RunFor(struct PDP8 *pdp8, uint64_t budget, uint64_t *executed);
+  extern void PDP8_KeyboardInput(struct PDP8 *pdp8, uint c);
+  
+  // Data accesses as the processor makes them, for devices transferring
+  // by data break; they are profiled and watched like any other.
+  extern uint PDP8_MemoryRead(struct PDP8 *pdp8, uint address);
+  extern void PDP8_MemoryWrite(struct PDP8 *pdp8, uint address, uint value);
+  extern uint64_t PDP8_StateHash(const struct PDP8 *pdp8);
   
 #endif //PDP8_H
   
@@ -0,0 +1,99 @@
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+
+#include "pdp8.h"
+#include "perfcount.h"
+
+const char *const PDP8_PerfCounterNames[PDP8_PERF_COUNT] = {
+  "cycles", "instructions", "branch-misses", "L1d-misses",
+};
+
+struct reading {
+  uint64_t value;
+  uint64_t enabled;
+  uint64_t running;
+};
+
+static int open_event(uint32_t type, uint64_t config) {
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = type;
+  attr.config = config;
+  attr.disabled = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+  return syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+bool PDP8_PerfOpen(struct PDP8_PerfCounters *counters) {
+  static const struct {
+    uint32_t type;
+    uint64_t config;
+  } events[PDP8_PERF_COUNT] = {
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+    { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                          (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+  };
+
+  bool any = false;
+  counters->error = 0;
+  for (uint i = 0; i < PDP8_PERF_COUNT; ++i) {
+    counters->fds[i] = open_event(events[i].type, events[i].config);
+    if (counters->fds[i] < 0 && !counters->error) counters->error = errno;
+    any |= counters->fds[i] >= 0;
+  }
+  PDP8_PerfReset(counters);
+  return any;
+}
+
+void PDP8_PerfClose(struct PDP8_PerfCounters *counters) {
+  for (uint i = 0; i < PDP8_PERF_COUNT; ++i) {
+    if (counters->fds[i] >= 0) close(counters->fds[i]);
+    counters->fds[i] = -1;
+  }
+}
+
+bool PDP8_PerfAvailable(const struct PDP8_PerfCounters *counters, uint counter) {
+  return counters->fds[counter] >= 0;
+}
+
+void PDP8_PerfReset(struct PDP8_PerfCounters *counters) {
+  memset(counters->values, 0, sizeof(counters->values));
+}
+
+void PDP8_PerfStart(struct PDP8_PerfCounters *counters) {
+  for (uint i = 0; i < PDP8_PERF_COUNT; ++i) {
+    if (counters->fds[i] < 0) continue;
+    ioctl(counters->fds[i], PERF_EVENT_IOC_RESET, 0);
+    ioctl(counters->fds[i], PERF_EVENT_IOC_ENABLE, 0);
+  }
+}
+
+void PDP8_PerfStop(struct PDP8_PerfCounters *counters) {
+  for (uint i = 0; i < PDP8_PERF_COUNT; ++i) {
+    if (counters->fds[i] >= 0) ioctl(counters->fds[i], PERF_EVENT_IOC_DISABLE, 0);
+  }
+
+  for (uint i = 0; i < PDP8_PERF_COUNT; ++i) {
+    struct reading reading;
+    if (counters->fds[i] < 0 || read(counters->fds[i], &reading, sizeof(reading)) != sizeof(reading)) continue;
+
+    // scale up when the counter shared the PMU with others
+    if (reading.running && reading.running < reading.enabled) {
+      reading.value = (uint64_t)((double)reading.value * reading.enabled / reading.running);
+    }
+    counters->values[i] += reading.value;
+  }
+}
@@ -0,0 +1,43 @@
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+#ifndef PDP8_PERFCOUNT_H
+#define PDP8_PERFCOUNT_H
+
+#include "pdp8.h"
+
+  enum PDP8_PerfCounter {
+    PDP8_PERF_CYCLES,                  // host CPU cycles
+    PDP8_PERF_INSTRUCTIONS,            // host instructions retired
+    PDP8_PERF_BRANCH_MISSES,
+    PDP8_PERF_L1D_MISSES,              // L1 data cache read misses
+    PDP8_PERF_COUNT,
+  };
+
+  // Hardware counters of the calling thread, user space only, read through
+  // perf_event_open. Counters the kernel or CPU refuses are left closed and
+  // report as unavailable; helper threads are not counted.
+  struct PDP8_PerfCounters {
+    int fds[PDP8_PERF_COUNT];          //  -1 when unavailable
+    uint64_t values[PDP8_PERF_COUNT];  //  totals, scaled when multiplexed
+    int error;                         //  errno of the first failure, or 0
+  };
+
+  extern const char *const PDP8_PerfCounterNames[PDP8_PERF_COUNT];
+
+  // Returns true if at least one counter is available.
+  extern bool PDP8_PerfOpen(struct PDP8_PerfCounters *counters);
+  extern void PDP8_PerfClose(struct PDP8_PerfCounters *counters);
+  extern bool PDP8_PerfAvailable(const struct PDP8_PerfCounters *counters, uint counter);
+  // Zeroes values.
+  extern void PDP8_PerfReset(struct PDP8_PerfCounters *counters);
+  // Counts between Start and Stop are added to values.
+  extern void PDP8_PerfStart(struct PDP8_PerfCounters *counters);
+  extern void PDP8_PerfStop(struct PDP8_PerfCounters *counters);
+
+#endif //PDP8_PERFCOUNT_H
+
+#if defined (__cplusplus)
+}
+#endif
@@ -0,0 +1,128 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "profile.h"
+#include "disassembler.h"
+
+struct ranked {
+  uint index;
+  uint64_t key;
+};
+
+void PDP8_ProfileReset(struct PDP8_Profile *profile) {
+  memset(profile, 0, sizeof(*profile));
+}
+
+void PDP8_ProfileAttach(struct PDP8 *pdp8, struct PDP8_Profile *profile) {
+  pdp8->profile = profile;
+}
+
+// Descending by key, ascending by index for ties.
+static int compare_ranked(const void *left, const void *right) {
+  const struct ranked *a = (const struct ranked *)left;
+  const struct ranked *b = (const struct ranked *)right;
+  if (a->key != b->key) return a->key < b->key ? 1 : -1;
+  return a->index < b->index ? -1 : a->index > b->index;
+}
+
+static double percent(uint64_t part, uint64_t total) {
+  return total ? 100.0 * part / total : 0.0;
+}
+
+// Nearest label at or below address, as LABEL or LABEL+offset.
+static void locate(const char *const *names, uint address, char *text, size_t size) {
+  text[0] = 0;
+  if (!names) return;
+
+  for (uint label = address + 1; label-- > 0;) {
+    if (!names[label]) continue;
+    if (label == address) snprintf(text, size, "%s", names[label]);
+    else snprintf(text, size, "%s+%o", names[label], address - label);
+    return;
+  }
+}
+
+// Code is ranked by the cycles spent executing it, data by its reads and
+// writes.
+static void report_addresses(FILE *out, const struct PDP8_Profile *profile, const uint *memory,
+                             const char *const *names, uint top, uint64_t total, bool data) {
+  struct ranked ranked[PDP8_MEMORY_SIZE];
+  uint count = 0;
+  for (uint i = 0; i < PDP8_MEMORY_SIZE; ++i) {
+    uint64_t key = data ? profile->reads[i] + profile->writes[i] : profile->cycles[i];
+    if (key) {
+      ranked[count].index = i;
+      ranked[count].key = key;
+      count++;
+    }
+  }
+  qsort(ranked, count, sizeof(ranked[0]), compare_ranked);
+  if (count > top) count = top;
+
+  fprintf(out, "address  symbol          %12s %12s %6s %10s %10s  instruction\n",
+          "executions", "cycles", "%", "reads", "writes");
+  for (uint i = 0; i < count; ++i) {
+    uint address = ranked[i].index;
+    char symbol[40];
+    char text[PDP8_DISASSEMBLY_LENGTH] = "";
+    locate(names, address, symbol, sizeof(symbol));
+    if (memory && profile->executions[address]) {
+      PDP8_Disassemble(memory[address], address, names, text);
+    }
+
+    fprintf(out, "%04o     %-15.15s %12llu %12llu %6.2f %10llu %10llu  %s\n", address, symbol,
+            (unsigned long long)profile->executions[address], (unsigned long long)profile->cycles[address],
+            percent(profile->cycles[address], total), (unsigned long long)profile->reads[address],
+            (unsigned long long)profile->writes[address], text);
+  }
+}
+
+static void report_pages(FILE *out, const struct PDP8_Profile *profile, uint64_t total) {
+  uint64_t executions[PDP8_PAGE_COUNT] = { 0 };
+  uint64_t reads[PDP8_PAGE_COUNT] = { 0 };
+  uint64_t writes[PDP8_PAGE_COUNT] = { 0 };
+  struct ranked ranked[PDP8_PAGE_COUNT];
+
+  for (uint page = 0; page < PDP8_PAGE_COUNT; ++page) {
+    ranked[page].index = page;
+    ranked[page].key = 0;
+  }
+  for (uint i = 0; i < PDP8_MEMORY_SIZE; ++i) {
+    uint page = i / PDP8_PAGE_SIZE;
+    executions[page] += profile->executions[i];
+    reads[page] += profile->reads[i];
+    writes[page] += profile->writes[i];
+    ranked[page].key += profile->cycles[i];
+  }
+  qsort(ranked, PDP8_PAGE_COUNT, sizeof(ranked[0]), compare_ranked);
+
+  fprintf(out, "page     range           %12s %12s %6s %10s %10s\n", "executions", "cycles", "%", "reads", "writes");
+  for (uint i = 0; i < PDP8_PAGE_COUNT; ++i) {
+    uint page = ranked[i].index;
+    if (!executions[page] && !reads[page] && !writes[page]) continue;
+
+    uint first = page * PDP8_PAGE_SIZE;
+    fprintf(out, "%-8o %04o-%04o       %12llu %12llu %6.2f %10llu %10llu\n", page, first, first + PDP8_PAGE_SIZE - 1,
+            (unsigned long long)executions[page], (unsigned long long)ranked[i].key,
+            percent(ranked[i].key, total), (unsigned long long)reads[page], (unsigned long long)writes[page]);
+  }
+}
+
+void PDP8_ProfileReport(FILE *out, const struct PDP8_Profile *profile, const uint *memory,
+                        const char *const *names, uint top) {
+  uint64_t executions = 0, cycles = 0;
+  for (uint i = 0; i < PDP8_MEMORY_SIZE; ++i) {
+    executions += profile->executions[i];
+    cycles += profile->cycles[i];
+  }
+
+  fprintf(out, "%llu instructions, %llu cycles\n\n", (unsigned long long)executions, (unsigned long long)cycles);
+  report_addresses(out, profile, memory, names, top, cycles, false);
+  fprintf(out, "\n");
+  report_addresses(out, profile, memory, names, top, cycles, true);
+  fprintf(out, "\n");
+  report_pages(out, profile, cycles);
+}
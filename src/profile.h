@@ -0,0 +1,42 @@
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+#ifndef PDP8_PROFILE_H
+#define PDP8_PROFILE_H
+
+#include <stdio.h>
+
+#include "pdp8.h"
+
+  enum PDP8_ProfileConstants {
+    PDP8_PAGE_SIZE  = 0200,
+    PDP8_PAGE_COUNT = PDP8_MEMORY_SIZE / PDP8_PAGE_SIZE,
+  };
+
+  // Exact per-address counters, updated by the engine while attached to
+  // pdp8->profile. Fetches count as executions, not reads; cycles are
+  // charged to the address of the instruction.
+  struct PDP8_Profile {
+    uint64_t executions[PDP8_MEMORY_SIZE];
+    uint64_t reads[PDP8_MEMORY_SIZE];
+    uint64_t writes[PDP8_MEMORY_SIZE];
+    uint64_t cycles[PDP8_MEMORY_SIZE];
+  };
+
+  // PDP8_Reset detaches the profile; attach it again afterwards.
+  extern void PDP8_ProfileReset(struct PDP8_Profile *profile);
+  extern void PDP8_ProfileAttach(struct PDP8 *pdp8, struct PDP8_Profile *profile);
+
+  // Lists the top code addresses by cycles, the top data addresses by
+  // accesses and all used pages by cycles. memory and names
+  // (see PDP8_SymbolsByAddress) are optional and add disassembly and
+  // LABEL+offset columns.
+  extern void PDP8_ProfileReport(FILE *out, const struct PDP8_Profile *profile, const uint *memory,
+                                 const char *const *names, uint top);
+
+#endif //PDP8_PROFILE_H
+
+#if defined (__cplusplus)
+}
+#endif
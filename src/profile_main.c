@@ -0,0 +1,97 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pdp8.h"
+#include "loader.h"
+#include "symbols.h"
+#include "profile.h"
+#include "stats.h"
+
+#define DEFAULT_BUDGET 100000000
+#define DEFAULT_TOP    20
+
+static int usage(const char *name) {
+  fprintf(stderr, "usage: %s image [-s switches] [-n budget] [-t top] [-l listing] [-m period]\n", name);
+  fprintf(stderr, "  symbols come from the .pal source, the listing, or image.lst when present\n");
+  fprintf(stderr, "  -m prints the instruction mix every period instructions\n");
+  return 1;
+}
+
+int main(int argc, char **argv) {
+  const char *file_name = NULL;
+  const char *listing = NULL;
+  uint switches = 0;
+  uint64_t budget = DEFAULT_BUDGET;
+  uint top = DEFAULT_TOP;
+  uint64_t period = 0;
+
+  for (int i = 1; i < argc; ++i) {
+    const char *arg = argv[i];
+    if (arg[0] != '-') {
+      if (file_name) return usage(argv[0]);
+      file_name = arg;
+    } else if (i + 1 >= argc) {
+      return usage(argv[0]);
+    } else if (!strcmp(arg, "-s")) {
+      if (!PDP8_ParseOctal(argv[++i], &switches)) return usage(argv[0]);
+    } else if (!strcmp(arg, "-n")) {
+      budget = strtoull(argv[++i], NULL, 10);
+    } else if (!strcmp(arg, "-t")) {
+      top = strtoul(argv[++i], NULL, 10);
+    } else if (!strcmp(arg, "-l")) {
+      listing = argv[++i];
+    } else if (!strcmp(arg, "-m")) {
+      period = strtoull(argv[++i], NULL, 10);
+      if (!period) return usage(argv[0]);
+    } else {
+      return usage(argv[0]);
+    }
+  }
+  if (!file_name) return usage(argv[0]);
+
+  struct PDP8_Image image;
+  struct PDP8_Symbols symbols;
+  PDP8_ImageInit(&image);
+  PDP8_SymbolsInit(&symbols);
+
+  int result = 1;
+  struct PDP8 *pdp8 = (struct PDP8 *)malloc(sizeof(struct PDP8));
+  struct PDP8_Profile *profile = (struct PDP8_Profile *)malloc(sizeof(struct PDP8_Profile));
+  const char **names = (const char **)malloc(PDP8_MEMORY_SIZE * sizeof(const char *));
+
+  if (pdp8 && profile && names && PDP8_ImageFromFileWithSymbols(&image, &symbols, file_name, listing) == PDP8_OK) {
+    PDP8_Reset(pdp8);
+    PDP8_MemoryReset(pdp8);
+    PDP8_LoadImage(pdp8, &image);
+    PDP8_StartImage(pdp8, &image);
+    pdp8->switches = switches;
+
+    PDP8_ProfileReset(profile);
+    PDP8_ProfileAttach(pdp8, profile);
+    uint64_t executed;
+    int stop;
+    if (period) {
+      struct PDP8_StatsTotal total;
+      PDP8_StatsTotalInit(&total);
+      stop = PDP8_StatsRun(pdp8, &total, stdout, budget, period, &executed);
+      PDP8_StatsTotalFree(&total);
+      printf("\n");
+    } else {
+      stop = PDP8_RunFor(pdp8, budget, &executed);
+    }
+
+    printf("%s after %llu instructions at PC %04o\n", stop == PDP8_STOP_HALT ? "halted" : "budget exhausted",
+           (unsigned long long)executed, pdp8->pc);
+    PDP8_SymbolsByAddress(&symbols, names);
+    PDP8_ProfileReport(stdout, profile, pdp8->memory, names, top);
+    result = 0;
+  }
+
+  free(names);
+  free(profile);
+  free(pdp8);
+  PDP8_SymbolsFree(&symbols);
+  PDP8_ImageFree(&image);
+  return result;
+}
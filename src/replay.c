@@ -0,0 +1,204 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "replay.h"
+#include "loader.h"
+
+#define LOG_MAGIC        "PDP8INP1"
+#define INITIAL_CAPACITY 64
+#define MAX_INSTRUCTION_CYCLES 3
+
+void PDP8_InputLogInit(struct PDP8_InputLog *log, const struct PDP8 *initial) {
+  log->initial_hash = initial ? PDP8_StateHash(initial) : 0;
+  log->final_hash = 0;
+  log->count = 0;
+  log->capacity = 0;
+  log->events = NULL;
+}
+
+void PDP8_InputLogFree(struct PDP8_InputLog *log) {
+  free(log->events);
+  PDP8_InputLogInit(log, NULL);
+}
+
+static int append(struct PDP8_InputLog *log, uint64_t cycle, uint kind, uint value) {
+  if (log->count == log->capacity) {
+    uint capacity = log->capacity ? 2 * log->capacity : INITIAL_CAPACITY;
+    struct PDP8_InputEvent *events =
+      (struct PDP8_InputEvent *)realloc(log->events, capacity * sizeof(struct PDP8_InputEvent));
+    if (!events) return PDP8_ERROR_MEMORY;
+    log->events = events;
+    log->capacity = capacity;
+  }
+
+  struct PDP8_InputEvent *event = &log->events[log->count++];
+  event->cycle = cycle;
+  event->kind = kind;
+  event->value = value;
+  return PDP8_OK;
+}
+
+void PDP8_ApplyInput(struct PDP8 *pdp8, uint kind, uint value) {
+  switch (kind) {
+    case PDP8_INPUT_KEYBOARD:  PDP8_KeyboardInput(pdp8, value); break;
+    case PDP8_INPUT_SWITCHES:  pdp8->switches = value; break;
+    case PDP8_INPUT_INTERRUPT: pdp8->interrupt_request = value; break;
+  }
+}
+
+int PDP8_Input(struct PDP8 *pdp8, struct PDP8_InputLog *log, uint kind, uint value) {
+  PDP8_ApplyInput(pdp8, kind, value);
+  return log ? append(log, pdp8->cycles, kind, value) : PDP8_OK;
+}
+
+int PDP8_InputLogEnd(struct PDP8_InputLog *log, const struct PDP8 *pdp8, uint stop) {
+  log->final_hash = PDP8_StateHash(pdp8);
+  return append(log, pdp8->cycles, PDP8_INPUT_END, stop);
+}
+
+static void put_varint(FILE *file, uint64_t value) {
+  while (value >= 0x80) {
+    fputc((int)(value & 0x7F) | 0x80, file);
+    value >>= 7;
+  }
+  fputc((int)value, file);
+}
+
+static bool get_varint(FILE *file, uint64_t *value) {
+  *value = 0;
+  for (uint shift = 0; shift < 64; shift += 7) {
+    int c = fgetc(file);
+    if (c == EOF) return false;
+    *value |= (uint64_t)(c & 0x7F) << shift;
+    if (!(c & 0x80)) return true;
+  }
+  return false;
+}
+
+static void put_u64(FILE *file, uint64_t value) {
+  for (uint i = 0; i < 8; ++i) fputc((int)(value >> (8 * i)) & 0xFF, file);
+}
+
+static bool get_u64(FILE *file, uint64_t *value) {
+  *value = 0;
+  for (uint i = 0; i < 8; ++i) {
+    int c = fgetc(file);
+    if (c == EOF) return false;
+    *value |= (uint64_t)c << (8 * i);
+  }
+  return true;
+}
+
+int PDP8_InputLogSave(const struct PDP8_InputLog *log, const char *file_name) {
+  FILE *file = fopen(file_name, "wb");
+  if (!file) return PDP8_ERROR_OPEN;
+
+  fwrite(LOG_MAGIC, 1, 8, file);
+  put_u64(file, log->initial_hash);
+  put_u64(file, log->final_hash);
+
+  uint64_t cycle = 0;
+  for (uint i = 0; i < log->count; ++i) {
+    const struct PDP8_InputEvent *event = &log->events[i];
+    put_varint(file, event->cycle - cycle);
+    fputc(event->kind, file);
+    put_varint(file, event->value);
+    cycle = event->cycle;
+  }
+
+  bool failed = ferror(file);
+  if (fclose(file) != 0) failed = true;
+  return failed ? PDP8_ERROR_WRITE : PDP8_OK;
+}
+
+// Whether value is one kind can hold: a character, the switches, the
+// request line or a stop reason, which readers use as a table index.
+static bool valid_event(int kind, uint64_t value) {
+  static const uint64_t limits[] = { 0377, PDP8_WORD_MASK, 1, PDP8_STOP_WATCHPOINT };
+  return kind >= 0 && kind <= PDP8_INPUT_END && value <= limits[kind];
+}
+
+int PDP8_InputLogLoad(struct PDP8_InputLog *log, const char *file_name) {
+  PDP8_InputLogInit(log, NULL);
+
+  FILE *file = fopen(file_name, "rb");
+  if (!file) return PDP8_ERROR_OPEN;
+
+  char magic[8];
+  int status = PDP8_OK;
+  if (fread(magic, 1, 8, file) != 8 || memcmp(magic, LOG_MAGIC, 8) ||
+      !get_u64(file, &log->initial_hash) || !get_u64(file, &log->final_hash)) {
+    status = PDP8_ERROR_FORMAT;
+  }
+
+  // nothing follows the end of the run
+  uint64_t cycle = 0;
+  for (int kind; status == PDP8_OK && (kind = fgetc(file)) != EOF;) {
+    ungetc(kind, file);
+
+    uint64_t delta, value;
+    if ((log->count && log->events[log->count - 1].kind == PDP8_INPUT_END) || !get_varint(file, &delta) ||
+        (kind = fgetc(file)) == EOF || !get_varint(file, &value) || !valid_event(kind, value)) {
+      status = PDP8_ERROR_FORMAT;
+      break;
+    }
+    cycle += delta;
+    status = append(log, cycle, kind, (uint)value);
+  }
+
+  fclose(file);
+  if (status != PDP8_OK) PDP8_InputLogFree(log);
+  return status;
+}
+
+void PDP8_ReplayInit(struct PDP8_Replay *replay, const struct PDP8_InputLog *log) {
+  replay->log = log;
+  replay->next = 0;
+}
+
+uint PDP8_ReplayStop(const struct PDP8_Replay *replay) {
+  const struct PDP8_InputLog *log = replay->log;
+  return log->count && log->events[log->count - 1].kind == PDP8_INPUT_END ? log->events[log->count - 1].value : 0;
+}
+
+int PDP8_ReplayRun(struct PDP8 *pdp8, struct PDP8_Replay *replay, uint64_t budget, uint64_t *executed) {
+  const struct PDP8_InputLog *log = replay->log;
+  uint64_t count = 0;
+  int stop = PDP8_STOP_BUDGET;
+
+  while (count < budget) {
+    // apply everything due; a late event (a diverged replay) is applied late
+    if (replay->next < log->count && log->events[replay->next].cycle <= pdp8->cycles) {
+      const struct PDP8_InputEvent *event = &log->events[replay->next++];
+      if (event->kind == PDP8_INPUT_END) {
+        stop = PDP8_STOP_END;
+        break;
+      }
+      PDP8_ApplyInput(pdp8, event->kind, event->value);
+      continue;
+    }
+    if (!pdp8->run) {
+      stop = PDP8_STOP_HALT;
+      break;
+    }
+
+    // run in bulk as far as the next event is certainly not passed: no
+    // instruction takes more than three cycles
+    uint64_t limit = budget - count;
+    if (replay->next < log->count) {
+      uint64_t safe = (log->events[replay->next].cycle - pdp8->cycles) / MAX_INSTRUCTION_CYCLES;
+      if (safe == 0) safe = 1;
+      if (safe < limit) limit = safe;
+    }
+
+    uint64_t ran;
+    PDP8_RunFor(pdp8, limit, &ran);
+    count += ran;
+  }
+
+  if (executed) *executed = count;
+  return stop;
+}
@@ -0,0 +1,65 @@
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+#ifndef PDP8_REPLAY_H
+#define PDP8_REPLAY_H
+
+#include "pdp8.h"
+
+  enum PDP8_InputKind {
+    PDP8_INPUT_KEYBOARD,               // character typed
+    PDP8_INPUT_SWITCHES,               // switch register set
+    PDP8_INPUT_INTERRUPT,              // external interrupt request line
+    PDP8_INPUT_END,                    // end of the run; value is its stop reason
+  };
+
+  // Input applied at the instruction boundary where the machine had run
+  // cycle memory cycles; every instruction takes at least one, so the
+  // boundary is unique.
+  struct PDP8_InputEvent {
+    uint64_t cycle;
+    uint kind;                         //  PDP8_InputKind
+    uint value;
+  };
+
+  // Everything outside struct PDP8 that influenced a run. Together with
+  // the initial state it reproduces the run exactly.
+  struct PDP8_InputLog {
+    uint64_t initial_hash;             //  PDP8_StateHash before the first instruction
+    uint64_t final_hash;               //  and at the end
+    uint count;
+    uint capacity;
+    struct PDP8_InputEvent *events;
+  };
+
+  struct PDP8_Replay {
+    const struct PDP8_InputLog *log;
+    uint next;                         //  next event to apply
+  };
+
+  extern void PDP8_InputLogInit(struct PDP8_InputLog *log, const struct PDP8 *initial);
+  extern void PDP8_InputLogFree(struct PDP8_InputLog *log);
+
+  // Hosts deliver input through here; log may be NULL when not recording.
+  extern void PDP8_ApplyInput(struct PDP8 *pdp8, uint kind, uint value);
+  extern int  PDP8_Input(struct PDP8 *pdp8, struct PDP8_InputLog *log, uint kind, uint value);
+  extern int  PDP8_InputLogEnd(struct PDP8_InputLog *log, const struct PDP8 *pdp8, uint stop);
+
+  // Compact file: magic, both hashes, then per event a varint cycle delta,
+  // the kind and a varint value. Loading fails with PDP8_ERROR_FORMAT on a
+  // value out of range for its kind or an event after the end.
+  extern int  PDP8_InputLogSave(const struct PDP8_InputLog *log, const char *file_name);
+  extern int  PDP8_InputLogLoad(struct PDP8_InputLog *log, const char *file_name);
+
+  // Runs as fast as the engine allows, applying each event at its cycle.
+  // Returns PDP8_STOP_END at the recorded end of the run.
+  extern void PDP8_ReplayInit(struct PDP8_Replay *replay, const struct PDP8_InputLog *log);
+  extern int  PDP8_ReplayRun(struct PDP8 *pdp8, struct PDP8_Replay *replay, uint64_t budget, uint64_t *executed);
+  extern uint PDP8_ReplayStop(const struct PDP8_Replay *replay);
+
+#endif //PDP8_REPLAY_H
+
+#if defined (__cplusplus)
+}
+#endif
@@ -0,0 +1,434 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pdp8.h"
+#include "loader.h"
+#include "disassembler.h"
+#include "replay.h"
+#include "history.h"
+#include "breakpoint.h"
+#include "watchpoint.h"
+
+#define MAX_RANGES         16
+#define MAX_REVERSALS      16
+
+enum RunStop {
+  RUN_HALT,                            // HLT or RUN cleared
+  RUN_BUDGET,                          // instruction or cycle budget used up
+  RUN_BREAKPOINT,                      // PC reached a breakpoint whose conditions held
+  RUN_INPUT,                           // waiting for input after end of file
+  RUN_WATCHPOINT,                      // an instruction touched a watched word
+};
+
+static const char *const stop_names[] = { "halted", "budget exhausted", "breakpoint", "end of input",
+                                           "watchpoint" };
+
+struct runner {
+  struct PDP8 pdp8;
+  FILE *input;                         //  keyboard, or NULL
+  FILE *output;                        //  printer, or NULL
+  bool input_done;
+  struct PDP8_InputLog *log;           //  recording, or NULL
+  struct PDP8_History *history;        //  kept for going back, or NULL
+  int log_status;
+
+  uint64_t budget;                     //  instructions
+  uint64_t cycle_budget;
+  struct PDP8_Breakpoints breakpoints;
+  struct PDP8_Watchpoints watchpoints;
+  bool stop_on_input;
+};
+
+static void print_character(void *context, uint c) {
+  fputc(c & 0177, (FILE *)context);
+}
+
+// Hands the next input character to the keyboard once the program has
+// taken the previous one. Input has mark parity and LF becomes CR.
+static void feed_keyboard(struct runner *runner) {
+  int c = fgetc(runner->input);
+  if (c == EOF) {
+    runner->input_done = true;
+    return;
+  }
+  if (c == '\n') c = '\r';
+  c = (c & 0177) | 0200;
+  int status = runner->history ? PDP8_HistoryInput(runner->history, &runner->pdp8, PDP8_INPUT_KEYBOARD, c)
+                               : PDP8_Input(&runner->pdp8, runner->log, PDP8_INPUT_KEYBOARD, c);
+  if (runner->log_status == PDP8_OK) runner->log_status = status;
+}
+
+static int run_for(struct runner *runner, uint64_t budget, uint64_t *executed) {
+  if (runner->history) return PDP8_HistoryRun(runner->history, &runner->pdp8, budget, executed);
+  return PDP8_RunFor(&runner->pdp8, budget, executed);
+}
+
+static int run(struct runner *runner, uint64_t *executed) {
+  struct PDP8 *pdp8 = &runner->pdp8;
+  bool feeding = runner->input != NULL;
+  uint64_t count = 0;
+
+  // without devices or a cycle budget a run loop does it all
+  bool breaking = runner->breakpoints.count || runner->watchpoints.count;
+  if (!feeding && !runner->cycle_budget && !(breaking && runner->history)) {
+    uint hit;
+    int stop = breaking ? PDP8_BreakpointRun(pdp8, &runner->breakpoints, runner->budget, false, executed, &hit)
+                        : run_for(runner, runner->budget, executed);
+    if (stop == PDP8_STOP_BREAKPOINT) return RUN_BREAKPOINT;
+    if (stop == PDP8_STOP_WATCHPOINT) return RUN_WATCHPOINT;
+    return stop == PDP8_STOP_HALT ? RUN_HALT : RUN_BUDGET;
+  }
+
+  int stop = RUN_BUDGET;
+  while (count < runner->budget) {
+    if (!pdp8->run) {
+      stop = RUN_HALT;
+      break;
+    }
+    if (runner->breakpoints.trap[pdp8->pc] && PDP8_BreakpointCheck(&runner->breakpoints, pdp8)) {
+      stop = RUN_BREAKPOINT;
+      break;
+    }
+    if (runner->cycle_budget && pdp8->cycles >= runner->cycle_budget) break;
+
+    if (feeding && !pdp8->keyboard_flag) {
+      feed_keyboard(runner);
+      feeding = !runner->input_done;
+    }
+
+    uint64_t ran;
+    run_for(runner, 1, &ran);
+    count++;
+    if (pdp8->watch_pages && pdp8->watchpoints->hit) {
+      stop = RUN_WATCHPOINT;
+      break;
+    }
+
+    // a KSF that finds nothing once the input is gone will wait forever
+    if (runner->stop_on_input && runner->input_done && !pdp8->keyboard_flag && pdp8->ir == 06031) {
+      stop = RUN_INPUT;
+      break;
+    }
+  }
+  if (stop == RUN_BUDGET && !pdp8->run) stop = RUN_HALT;
+
+  *executed = count;
+  return stop;
+}
+
+// Reproduces a recorded run; it ends where the recording ended.
+static int replay(struct runner *runner, const struct PDP8_InputLog *log, uint64_t *executed) {
+  struct PDP8_Replay replay;
+  PDP8_ReplayInit(&replay, log);
+
+  int stop = PDP8_ReplayRun(&runner->pdp8, &replay, runner->budget, executed);
+  if (stop == PDP8_STOP_END) return PDP8_ReplayStop(&replay);
+  return stop == PDP8_STOP_HALT ? RUN_HALT : RUN_BUDGET;
+}
+
+// Reverse continue target: a -B address.
+static bool at_address(const struct PDP8 *pdp8, void *context) {
+  return pdp8->pc == *(const uint *)context;
+}
+
+static void print_registers(FILE *out, const struct PDP8 *pdp8) {
+  char text[PDP8_DISASSEMBLY_LENGTH];
+  PDP8_Disassemble(pdp8->ir, pdp8->last_pc, NULL, text);
+
+  fprintf(out, "PC %04o  L %o  AC %04o  MQ %04o  MA %04o  MB %04o  IR %04o %s\n",
+          pdp8->pc, pdp8->link, pdp8->ac, pdp8->mq, pdp8->ma, pdp8->mb, pdp8->ir, text);
+  fprintf(out, "RUN %o  ION %o  IRQ %o  SR %04o  KBD %o/%03o  TTO %o/%03o\n",
+          pdp8->run, pdp8->interrupt_enable, pdp8->interrupt_request, pdp8->switches,
+          pdp8->keyboard_flag, pdp8->keyboard_buffer, pdp8->printer_flag, pdp8->printer_buffer);
+}
+
+static void print_state(FILE *out, const struct PDP8 *pdp8, int stop, uint64_t executed) {
+  fprintf(out, "%s after %llu instructions, %llu cycles\n", stop_names[stop],
+          (unsigned long long)executed, (unsigned long long)pdp8->cycles);
+  print_registers(out, pdp8);
+  if (stop == RUN_WATCHPOINT) {
+    const struct PDP8_Watchpoints *watchpoints = pdp8->watchpoints;
+    fprintf(out, "%s %04o by %04o: %04o", watchpoints->access == PDP8_WATCH_READ ? "read" : "write",
+            watchpoints->address, watchpoints->pc, watchpoints->old_value);
+    if (watchpoints->access == PDP8_WATCH_WRITE) fprintf(out, " -> %04o", watchpoints->value);
+    fprintf(out, "\n");
+  }
+}
+
+// Octal dump, eight words per line.
+static void dump_memory(FILE *out, const struct PDP8 *pdp8, uint first, uint last) {
+  for (uint address = first & ~07u; address <= last; address += 8) {
+    fprintf(out, "%04o:", address);
+    for (uint i = address; i < address + 8; ++i) {
+      if (i < first || i > last) fprintf(out, "     ");
+      else fprintf(out, " %04o", pdp8->memory[i]);
+    }
+    fprintf(out, "\n");
+  }
+}
+
+static bool parse_range(const char *text, uint *first, uint *last) {
+  char buffer[16];
+  const char *dash = strchr(text, '-');
+  if (!dash) {
+    if (!PDP8_ParseOctal(text, first)) return false;
+    *last = *first;
+    return true;
+  }
+  size_t length = dash - text;
+  if (length >= sizeof(buffer)) return false;
+  memcpy(buffer, text, length);
+  buffer[length] = 0;
+  return PDP8_ParseOctal(buffer, first) && PDP8_ParseOctal(dash + 1, last) && *first <= *last;
+}
+
+// first[-last][,r|,w|,rw]
+static bool parse_watchpoint(char *text, uint *first, uint *last, uint *access) {
+  char *comma = strchr(text, ',');
+  *access = PDP8_WATCH_WRITE;
+  if (comma) {
+    *comma = 0;
+    if (!strcmp(comma + 1, "r")) *access = PDP8_WATCH_READ;
+    else if (!strcmp(comma + 1, "rw")) *access = PDP8_WATCH_ACCESS;
+    else if (strcmp(comma + 1, "w")) return false;
+  }
+  return parse_range(text, first, last);
+}
+
+// address[,ac=value[/mask]][,l=link][,ignore=count]
+static bool parse_breakpoint(char *text, struct PDP8_Breakpoint *breakpoint) {
+  char *field = strtok(text, ",");
+  uint address, value;
+  if (!field || !PDP8_ParseOctal(field, &address)) return false;
+  PDP8_BreakpointInit(breakpoint, address);
+
+  while ((field = strtok(NULL, ","))) {
+    char *end;
+    if (!strncmp(field, "ac=", 3)) {
+      char *slash = strchr(field, '/');
+      if (slash) *slash = 0;
+      if (!PDP8_ParseOctal(field + 3, &breakpoint->ac_value)) return false;
+      breakpoint->ac_mask = PDP8_WORD_MASK;
+      if (slash && !PDP8_ParseOctal(slash + 1, &breakpoint->ac_mask)) return false;
+      breakpoint->ac_value &= breakpoint->ac_mask;
+    } else if (!strncmp(field, "l=", 2) && PDP8_ParseOctal(field + 2, &value) && value <= 1) {
+      breakpoint->link = value;
+    } else if (!strncmp(field, "ignore=", 7)) {
+      breakpoint->ignore = strtoull(field + 7, &end, 10);
+      if (*end) return false;
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+static FILE *open_device(const char *name, const char *mode, FILE *standard) {
+  if (!strcmp(name, "-")) return standard;
+  FILE *file = fopen(name, mode);
+  if (!file) perror(name);
+  return file;
+}
+
+static int usage(const char *name) {
+  fprintf(stderr, "usage: %s image [-g start] [-s switches] [-d address=value]... [-i input] [-o output]\n", name);
+  fprintf(stderr, "       [-n instructions] [-c cycles] [-a breakpoint]... [-W watchpoint]...\n");
+  fprintf(stderr, "       [-w] [-m first-last]... [-q]\n");
+  fprintf(stderr, "       [-r log | -p log] [-b instructions | -B address]...\n");
+  fprintf(stderr, "  -i/-o attach the keyboard and printer to files, - for stdin/stdout\n");
+  fprintf(stderr, "  -a address[,ac=value[/mask]][,l=link][,ignore=count] stops when PC\n");
+  fprintf(stderr, "  reaches address with the conditions met, -W first[-last][,r|,w|,rw] after an\n");
+  fprintf(stderr, "  instruction reads or writes (default) a word, -w when the program waits for input\n");
+  fprintf(stderr, "  after its end, -m dumps memory, -q omits the final state\n");
+  fprintf(stderr, "  -r records keyboard input to log, -p replays it at full speed, without -a or -W\n");
+  fprintf(stderr, "  then -b steps back and -B goes back to the last time PC was at address\n");
+  fprintf(stderr, "  numbers are octal except budgets; exits 0 on halt, 2 on budget, 3 at a\n");
+  fprintf(stderr, "  breakpoint, 4 at end of input, 5 at a watchpoint and 1 on errors or a\n");
+  fprintf(stderr, "  diverged replay\n");
+  return 1;
+}
+
+int main(int argc, char **argv) {
+  struct runner *runner = (struct runner *)calloc(1, sizeof(struct runner));
+  const char *file_name = NULL;
+  const char *input_name = NULL;
+  const char *output_name = NULL;
+  const char *record_name = NULL;
+  const char *replay_name = NULL;
+  int start = PDP8_NO_START;
+  uint switches = 0;
+  bool quiet = false;
+  uint ranges[2 * MAX_RANGES];
+  uint range_count = 0;
+  struct PDP8_Image deposits;
+  struct { bool to_address; uint64_t value; } reversals[MAX_REVERSALS];
+  uint reversal_count = 0;
+
+  if (!runner) return 1;
+  runner->budget = UINT64_MAX;
+  PDP8_BreakpointsInit(&runner->breakpoints);
+  PDP8_WatchpointsInit(&runner->watchpoints);
+  PDP8_ImageInit(&deposits);
+
+  for (int i = 1; i < argc; ++i) {
+    const char *arg = argv[i];
+    uint address, value;
+    if (arg[0] != '-') {
+      if (file_name) return usage(argv[0]);
+      file_name = arg;
+    } else if (!strcmp(arg, "-w")) {
+      runner->stop_on_input = true;
+    } else if (!strcmp(arg, "-q")) {
+      quiet = true;
+    } else if (i + 1 >= argc) {
+      return usage(argv[0]);
+    } else if (!strcmp(arg, "-g") && PDP8_ParseOctal(argv[++i], &address)) {
+      start = address;
+    } else if (!strcmp(arg, "-s") && PDP8_ParseOctal(argv[++i], &value)) {
+      switches = value;
+    } else if (!strcmp(arg, "-d") && PDP8_ParseDeposit(argv[++i], &address, &value)) {
+      PDP8_ImageDeposit(&deposits, address, value);
+    } else if (!strcmp(arg, "-a")) {
+      struct PDP8_Breakpoint breakpoint;
+      if (!parse_breakpoint(argv[++i], &breakpoint) || !PDP8_BreakpointSet(&runner->breakpoints, &breakpoint)) {
+        return usage(argv[0]);
+      }
+    } else if (!strcmp(arg, "-m") && range_count < MAX_RANGES &&
+               parse_range(argv[++i], &ranges[2 * range_count], &ranges[2 * range_count + 1])) {
+      range_count++;
+    } else if (!strcmp(arg, "-b") && reversal_count < MAX_REVERSALS) {
+      reversals[reversal_count].to_address = false;
+      reversals[reversal_count++].value = strtoull(argv[++i], NULL, 10);
+    } else if (!strcmp(arg, "-B") && reversal_count < MAX_REVERSALS && PDP8_ParseOctal(argv[++i], &address)) {
+      reversals[reversal_count].to_address = true;
+      reversals[reversal_count++].value = address;
+    } else if (!strcmp(arg, "-W")) {
+      uint first, last, access;
+      if (!parse_watchpoint(argv[++i], &first, &last, &access)) return usage(argv[0]);
+      for (uint address = first; address <= last; ++address) {
+        PDP8_WatchpointSet(&runner->watchpoints, address, access);
+      }
+    } else if (!strcmp(arg, "-i")) {
+      input_name = argv[++i];
+    } else if (!strcmp(arg, "-o")) {
+      output_name = argv[++i];
+    } else if (!strcmp(arg, "-r")) {
+      record_name = argv[++i];
+    } else if (!strcmp(arg, "-p")) {
+      replay_name = argv[++i];
+    } else if (!strcmp(arg, "-n")) {
+      runner->budget = strtoull(argv[++i], NULL, 10);
+    } else if (!strcmp(arg, "-c")) {
+      runner->cycle_budget = strtoull(argv[++i], NULL, 10);
+    } else {
+      return usage(argv[0]);
+    }
+  }
+  // a replay runs on its own, without checking breakpoints or watchpoints
+  bool breaking = runner->breakpoints.count || runner->watchpoints.count;
+  if (!file_name || (replay_name && (record_name || input_name || reversal_count || breaking))) return usage(argv[0]);
+
+  struct PDP8_Image image;
+  int status = PDP8_ImageFromFile(&image, file_name);
+  if (status != PDP8_OK) {
+    fprintf(stderr, "%s: %s\n", file_name, PDP8_StatusString(status));
+    return 1;
+  }
+  for (uint i = 0; i < deposits.deposit_count; ++i) {
+    PDP8_ImageDeposit(&image, deposits.deposits[i].address, deposits.deposits[i].value);
+  }
+  PDP8_ImageFree(&deposits);
+  if (start != PDP8_NO_START) image.start = start;
+
+  if (input_name && !(runner->input = open_device(input_name, "rb", stdin))) return 1;
+  if (output_name && !(runner->output = open_device(output_name, "wb", stdout))) return 1;
+
+  struct PDP8 *pdp8 = &runner->pdp8;
+  PDP8_Reset(pdp8);
+  PDP8_MemoryReset(pdp8);
+  PDP8_LoadImage(pdp8, &image);
+  PDP8_StartImage(pdp8, &image);
+  pdp8->switches = switches;
+  if (runner->output) {
+    pdp8->print = print_character;
+    pdp8->print_context = runner->output;
+  }
+  if (runner->watchpoints.count) PDP8_WatchpointsAttach(pdp8, &runner->watchpoints);
+  PDP8_ImageFree(&image);
+
+  struct PDP8_History history;
+  if (reversal_count) {
+    status = PDP8_HistoryInit(&history, pdp8);
+    if (status != PDP8_OK) {
+      fprintf(stderr, "%s\n", PDP8_StatusString(status));
+      return 1;
+    }
+    runner->history = &history;
+  }
+
+  // with a history its log is the recording
+  struct PDP8_InputLog log;
+  PDP8_InputLogInit(&log, pdp8);
+  struct PDP8_InputLog *recording = runner->history ? &history.log : &log;
+  if (record_name) runner->log = recording;
+  if (replay_name) {
+    status = PDP8_InputLogLoad(&log, replay_name);
+    if (status != PDP8_OK) {
+      fprintf(stderr, "%s: %s\n", replay_name, PDP8_StatusString(status));
+      return 1;
+    }
+    if (log.initial_hash != PDP8_StateHash(pdp8)) {
+      fprintf(stderr, "%s: recorded with a different image, switches or start address\n", replay_name);
+    }
+  }
+
+  uint64_t executed;
+  int stop = replay_name ? replay(runner, &log, &executed) : run(runner, &executed);
+  int result = 0;
+
+  if (record_name) {
+    status = runner->log_status;
+    if (status == PDP8_OK) status = PDP8_InputLogEnd(recording, pdp8, stop);
+    if (status == PDP8_OK) status = PDP8_InputLogSave(recording, record_name);
+    if (status != PDP8_OK) {
+      fprintf(stderr, "%s: %s\n", record_name, PDP8_StatusString(status));
+      result = 1;
+    }
+  }
+
+  if (runner->output) fflush(runner->output);
+  if (runner->output && runner->output != stdout) fclose(runner->output);
+  if (runner->input && runner->input != stdin) fclose(runner->input);
+
+  // keep the state apart from printer output on stdout
+  FILE *out = runner->output == stdout ? stderr : stdout;
+  if (!quiet) print_state(out, pdp8, stop, executed);
+  for (uint i = 0; i < reversal_count; ++i) {
+    uint address = (uint)reversals[i].value;
+    if (!reversals[i].to_address) {
+      PDP8_HistoryBack(&history, pdp8, reversals[i].value);
+    } else if (!PDP8_HistoryReverse(&history, pdp8, at_address, &address)) {
+      fprintf(out, "PC never at %04o before\n", address);
+    }
+    if (!quiet) {
+      fprintf(out, "back at %llu instructions, %llu cycles\n", (unsigned long long)history.instructions,
+              (unsigned long long)pdp8->cycles);
+      print_registers(out, pdp8);
+    }
+  }
+  for (uint i = 0; i < range_count; ++i) {
+    dump_memory(out, pdp8, ranges[2 * i], ranges[2 * i + 1]);
+  }
+
+  if (replay_name && log.final_hash != PDP8_StateHash(pdp8)) {
+    fprintf(out, "replay diverged from the recording\n");
+    result = 1;
+  }
+
+  if (runner->history) PDP8_HistoryFree(&history);
+  PDP8_InputLogFree(&log);
+  free(runner);
+  static const int exit_codes[] = { 0, 2, 3, 4, 5 };
+  return result ? result : exit_codes[stop];
+}
@@ -0,0 +1,119 @@
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "stats.h"
+#include "disassembler.h"
+
+#define FIELD_COUNT (sizeof(struct PDP8_Stats) / sizeof(uint64_t))
+
+static const char *const opcode_names[8] = { "AND", "TAD", "ISZ", "DCA", "JMS", "JMP", "IOT", "OPR" };
+
+void PDP8_StatsReset(struct PDP8_Stats *stats) {
+  memset(stats, 0, sizeof(*stats));
+}
+
+void PDP8_StatsAttach(struct PDP8 *pdp8, struct PDP8_Stats *stats) {
+  pdp8->stats = stats;
+}
+
+uint64_t PDP8_StatsInstructions(const struct PDP8_Stats *stats) {
+  uint64_t count = 0;
+  for (uint i = 0; i < 8; ++i) count += stats->opcodes[i];
+  return count;
+}
+
+// Every member is a uint64_t counter.
+void PDP8_StatsAdd(struct PDP8_Stats *total, const struct PDP8_Stats *stats) {
+  uint64_t *to = (uint64_t *)total;
+  const uint64_t *from = (const uint64_t *)stats;
+  for (size_t i = 0; i < FIELD_COUNT; ++i) to[i] += from[i];
+}
+
+static double percent(uint64_t part, uint64_t total) {
+  return total ? 100.0 * part / total : 0.0;
+}
+
+static void print_pair(FILE *out, const char *name_a, uint64_t a, const char *name_b, uint64_t b) {
+  fprintf(out, "  %-14s %12llu %6.2f%%   %-14s %12llu %6.2f%%\n", name_a, (unsigned long long)a,
+          percent(a, a + b), name_b, (unsigned long long)b, percent(b, a + b));
+}
+
+void PDP8_StatsPrint(FILE *out, const struct PDP8_Stats *stats) {
+  uint64_t instructions = PDP8_StatsInstructions(stats);
+  fprintf(out, "%llu instructions\n", (unsigned long long)instructions);
+
+  for (uint i = 0; i < 8; ++i) {
+    fprintf(out, "  %-14s %12llu %6.2f%%\n", opcode_names[i], (unsigned long long)stats->opcodes[i],
+            percent(stats->opcodes[i], instructions));
+  }
+  print_pair(out, "direct", stats->direct, "indirect", stats->indirect);
+  print_pair(out, "page zero", stats->page_zero, "current page", stats->current_page);
+  fprintf(out, "  %-14s %12llu %6.2f%% of indirect\n", "auto-index", (unsigned long long)stats->auto_index,
+          percent(stats->auto_index, stats->indirect));
+  print_pair(out, "skip taken", stats->skips_taken, "not taken", stats->skips_not_taken);
+
+  for (uint device = 0; device < PDP8_DEVICE_COUNT; ++device) {
+    if (!stats->iots[device]) continue;
+
+    // name known devices after their first IOT, e.g. "TSF" for 04
+    char name[24];
+    const char *mnemonic = PDP8_MnemonicText(06001 | (device << 3));
+    if (mnemonic[0] >= '0' && mnemonic[0] <= '7') mnemonic = "";
+    snprintf(name, sizeof(name), "IOT %02o %s", device, mnemonic);
+    fprintf(out, "  %-14s %12llu %6.2f%%\n", name, (unsigned long long)stats->iots[device],
+            percent(stats->iots[device], stats->opcodes[6]));
+  }
+}
+
+void PDP8_StatsTotalInit(struct PDP8_StatsTotal *total) {
+  pthread_mutex_init(&total->lock, NULL);
+  PDP8_StatsReset(&total->stats);
+}
+
+void PDP8_StatsTotalFree(struct PDP8_StatsTotal *total) {
+  pthread_mutex_destroy(&total->lock);
+}
+
+void PDP8_StatsFlush(struct PDP8_StatsTotal *total, struct PDP8_Stats *stats) {
+  pthread_mutex_lock(&total->lock);
+  PDP8_StatsAdd(&total->stats, stats);
+  pthread_mutex_unlock(&total->lock);
+  PDP8_StatsReset(stats);
+}
+
+void PDP8_StatsSnapshot(struct PDP8_StatsTotal *total, struct PDP8_Stats *stats) {
+  pthread_mutex_lock(&total->lock);
+  *stats = total->stats;
+  pthread_mutex_unlock(&total->lock);
+}
+
+int PDP8_StatsRun(struct PDP8 *pdp8, struct PDP8_StatsTotal *total, FILE *out,
+                  uint64_t budget, uint64_t period, uint64_t *executed) {
+  struct PDP8_Stats local, snapshot;
+  struct PDP8_Stats *attached = pdp8->stats;
+  PDP8_StatsReset(&local);
+  PDP8_StatsAttach(pdp8, &local);
+  if (period == 0) period = budget;
+
+  uint64_t count = 0;
+  int stop = PDP8_STOP_BUDGET;
+  while (count < budget) {
+    uint64_t slice;
+    stop = PDP8_RunFor(pdp8, budget - count < period ? budget - count : period, &slice);
+    count += slice;
+
+    PDP8_StatsFlush(total, &local);
+    if (out) {
+      PDP8_StatsSnapshot(total, &snapshot);
+      PDP8_StatsPrint(out, &snapshot);
+    }
+    if (stop == PDP8_STOP_HALT) break;
+  }
+
+  PDP8_StatsAttach(pdp8, attached);
+  if (executed) *executed = count;
+  return stop;
+}
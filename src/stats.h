@@ -0,0 +1,58 @@
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+#ifndef PDP8_STATS_H
+#define PDP8_STATS_H
+
+#include <pthread.h>
+#include <stdio.h>
+
+#include "pdp8.h"
+
+  enum PDP8_StatsConstants {
+    PDP8_DEVICE_COUNT = 64,            // IOT device select codes
+  };
+
+  // Instruction mix counters. Each running machine owns one (attached to
+  // pdp8->stats) and updates it without synchronisation; the owner folds
+  // it into a shared PDP8_StatsTotal every so many instructions.
+  struct PDP8_Stats {
+    uint64_t opcodes[8];               //  AND TAD ISZ DCA JMS JMP IOT OPR
+    uint64_t direct;                   //  memory references without I
+    uint64_t indirect;
+    uint64_t page_zero;                //  memory references to page zero
+    uint64_t current_page;
+    uint64_t auto_index;               //  indirect references through 0010-0017
+    uint64_t skips_taken;              //  ISZ and group 2 skips
+    uint64_t skips_not_taken;
+    uint64_t iots[PDP8_DEVICE_COUNT];  //  IOTs by device select code
+  };
+
+  struct PDP8_StatsTotal {
+    pthread_mutex_t lock;
+    struct PDP8_Stats stats;
+  };
+
+  extern void PDP8_StatsReset(struct PDP8_Stats *stats);
+  extern void PDP8_StatsAttach(struct PDP8 *pdp8, struct PDP8_Stats *stats);
+  extern uint64_t PDP8_StatsInstructions(const struct PDP8_Stats *stats);
+  extern void PDP8_StatsAdd(struct PDP8_Stats *total, const struct PDP8_Stats *stats);
+  extern void PDP8_StatsPrint(FILE *out, const struct PDP8_Stats *stats);
+
+  extern void PDP8_StatsTotalInit(struct PDP8_StatsTotal *total);
+  extern void PDP8_StatsTotalFree(struct PDP8_StatsTotal *total);
+  // Adds stats to the total and clears them.
+  extern void PDP8_StatsFlush(struct PDP8_StatsTotal *total, struct PDP8_Stats *stats);
+  extern void PDP8_StatsSnapshot(struct PDP8_StatsTotal *total, struct PDP8_Stats *stats);
+
+  // Runs like PDP8_RunFor, flushing into total and printing it to out
+  // every period instructions.
+  extern int PDP8_StatsRun(struct PDP8 *pdp8, struct PDP8_StatsTotal *total, FILE *out,
+                           uint64_t budget, uint64_t period, uint64_t *executed);
+
+#endif //PDP8_STATS_H
+
+#if defined (__cplusplus)
+}
+#endif
@@ -0,0 +1,179 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "symbols.h"
+#include "loader.h"
+
+#define INITIAL_CAPACITY 256
+
+static char upper(char c) {
+  return (c >= 'a' && c <= 'z') ? c - 040 : c;
+}
+
+// FNV-1a over the upper case name.
+static uint32_t hash(const char *name, uint length) {
+  uint32_t h = 2166136261u;
+  for (uint i = 0; i < length; ++i) {
+    h = (h ^ (unsigned char)upper(name[i])) * 16777619u;
+  }
+  return h;
+}
+
+static bool same(const struct PDP8_Symbol *symbol, const char *name, uint length) {
+  for (uint i = 0; i < length; ++i) {
+    if (symbol->name[i] != upper(name[i])) return false;
+  }
+  return symbol->name[length] == 0;
+}
+
+static struct PDP8_Symbol *find_slot(struct PDP8_Symbol *table, uint capacity, const char *name, uint length) {
+  uint mask = capacity - 1;
+  for (uint i = hash(name, length) & mask;; i = (i + 1) & mask) {
+    if (!table[i].name[0] || same(&table[i], name, length)) {
+      return &table[i];
+    }
+  }
+}
+
+void PDP8_SymbolsInit(struct PDP8_Symbols *symbols) {
+  symbols->count = 0;
+  symbols->capacity = 0;
+  symbols->table = NULL;
+}
+
+void PDP8_SymbolsFree(struct PDP8_Symbols *symbols) {
+  free(symbols->table);
+  PDP8_SymbolsInit(symbols);
+}
+
+static bool rehash(struct PDP8_Symbols *symbols, uint capacity) {
+  struct PDP8_Symbol *table = (struct PDP8_Symbol *)calloc(capacity, sizeof(struct PDP8_Symbol));
+  if (!table) return false;
+
+  for (uint i = 0; i < symbols->capacity; ++i) {
+    struct PDP8_Symbol *symbol = &symbols->table[i];
+    if (symbol->name[0]) {
+      *find_slot(table, capacity, symbol->name, strlen(symbol->name)) = *symbol;
+    }
+  }
+
+  free(symbols->table);
+  symbols->table = table;
+  symbols->capacity = capacity;
+  return true;
+}
+
+int PDP8_SymbolsDefine(struct PDP8_Symbols *symbols, const char *name, uint length, uint value, uint type) {
+  if (length > PDP8_SYMBOL_LENGTH) length = PDP8_SYMBOL_LENGTH;
+
+  // keep the load factor below 3/4
+  if (4 * (symbols->count + 1) > 3 * symbols->capacity) {
+    if (!rehash(symbols, symbols->capacity ? symbols->capacity * 2 : INITIAL_CAPACITY)) {
+      return PDP8_ERROR_MEMORY;
+    }
+  }
+
+  struct PDP8_Symbol *symbol = find_slot(symbols->table, symbols->capacity, name, length);
+  if (!symbol->name[0]) {
+    for (uint i = 0; i < length; ++i) {
+      symbol->name[i] = upper(name[i]);
+    }
+    symbol->name[length] = 0;
+    symbols->count++;
+  }
+  symbol->value = value;
+  symbol->type = type;
+
+  return PDP8_OK;
+}
+
+struct PDP8_Symbol *PDP8_SymbolsLookup(const struct PDP8_Symbols *symbols, const char *name, uint length) {
+  if (!symbols->capacity) return NULL;
+  if (length > PDP8_SYMBOL_LENGTH) length = PDP8_SYMBOL_LENGTH;
+
+  struct PDP8_Symbol *symbol = find_slot(symbols->table, symbols->capacity, name, length);
+  return symbol->name[0] ? symbol : NULL;
+}
+
+// Fills names[PDP8_MEMORY_SIZE] with the user symbol for each address, NULL
+// where there is none. Labels win over equates. The names stay valid until
+// the table is modified or freed.
+void PDP8_SymbolsByAddress(const struct PDP8_Symbols *symbols, const char **names) {
+  memset(names, 0, PDP8_MEMORY_SIZE * sizeof(const char *));
+
+  for (uint i = 0; i < symbols->capacity; ++i) {
+    const struct PDP8_Symbol *symbol = &symbols->table[i];
+    if (!symbol->name[0]) continue;
+
+    const char **name = &names[symbol->value & PDP8_WORD_MASK];
+    if (symbol->type == PDP8_SYMBOL_LABEL || (symbol->type == PDP8_SYMBOL_EQUATE && !*name)) {
+      *name = symbol->name;
+    }
+  }
+}
+
+static bool is_digit(char c) {
+  return c >= '0' && c <= '9';
+}
+
+static bool is_alpha(char c) {
+  c = upper(c);
+  return c >= 'A' && c <= 'Z';
+}
+
+static const char *skip_blanks(const char *p, const char *end) {
+  while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) p++;
+  return p;
+}
+
+// Symbol table lines look like "    1  HELLO  00200"; anything else, such
+// as page headers, is ignored.
+static int define_listing_line(struct PDP8_Symbols *symbols, const char *p, const char *end) {
+  p = skip_blanks(p, end);
+  if (p == end || !is_digit(*p)) return PDP8_OK;
+  while (p < end && is_digit(*p)) p++;
+
+  p = skip_blanks(p, end);
+  const char *name = p;
+  if (p == end || !is_alpha(*p)) return PDP8_OK;
+  while (p < end && (is_alpha(*p) || is_digit(*p))) p++;
+  uint length = p - name;
+
+  p = skip_blanks(p, end);
+  if (p == end || *p < '0' || *p > '7') return PDP8_OK;
+  uint value = 0;
+  while (p < end && *p >= '0' && *p <= '7') value = (value << 3) | (*p++ - '0');
+
+  if (skip_blanks(p, end) != end) return PDP8_OK;
+  return PDP8_SymbolsDefine(symbols, name, length, value & PDP8_WORD_MASK, PDP8_SYMBOL_LABEL);
+}
+
+int PDP8_SymbolsFromListing(struct PDP8_Symbols *symbols, const char *file_name) {
+  unsigned char *buffer;
+  size_t length;
+  int status = PDP8_ReadFile(file_name, &buffer, &length);
+  if (status != PDP8_OK) return status;
+
+  const char *text = (const char *)buffer;
+  const char *end = text + length;
+  bool table = false;
+
+  while (text < end && status == PDP8_OK) {
+    const char *line_end = (const char *)memchr(text, '\n', end - text);
+    if (!line_end) line_end = end;
+
+    if (!table) {
+      const char *p = text;
+      while (p + 12 <= line_end && memcmp(p, "Symbol Table", 12) != 0) p++;
+      table = p + 12 <= line_end;
+    } else {
+      status = define_listing_line(symbols, text, line_end);
+    }
+    text = line_end + 1;
+  }
+
+  free(buffer);
+  return table || status != PDP8_OK ? status : PDP8_ERROR_FORMAT;
+}
@@ -0,0 +1,48 @@
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+#ifndef PDP8_SYMBOLS_H
+#define PDP8_SYMBOLS_H
+
+#include "pdp8.h"
+
+  enum PDP8_SymbolType {
+    PDP8_SYMBOL_PERMANENT,             // built-in IOT/OPR/modifier
+    PDP8_SYMBOL_MRI,                   // memory reference instruction
+    PDP8_SYMBOL_PSEUDO,                // assembler directive
+    PDP8_SYMBOL_LABEL,                 // NAME,
+    PDP8_SYMBOL_EQUATE,                // NAME=value
+  };
+
+  enum PDP8_SymbolConstants {
+    PDP8_SYMBOL_LENGTH = 31,           // longer names are truncated
+  };
+
+  struct PDP8_Symbol {
+    char name[PDP8_SYMBOL_LENGTH + 1]; //  upper case, empty for a free slot
+    uint value;
+    uint type;                         //  PDP8_SymbolType
+  };
+
+  // Open addressing hash table keyed by upper case name.
+  struct PDP8_Symbols {
+    uint count;
+    uint capacity;                     //  power of two
+    struct PDP8_Symbol *table;
+  };
+
+  extern void PDP8_SymbolsInit(struct PDP8_Symbols *symbols);
+  extern void PDP8_SymbolsFree(struct PDP8_Symbols *symbols);
+  extern int  PDP8_SymbolsDefine(struct PDP8_Symbols *symbols, const char *name, uint length, uint value, uint type);
+  extern struct PDP8_Symbol *PDP8_SymbolsLookup(const struct PDP8_Symbols *symbols, const char *name, uint length);
+  extern void PDP8_SymbolsByAddress(const struct PDP8_Symbols *symbols, const char **names);
+
+  // Defines the labels in the symbol table section of a PAL .lst listing.
+  extern int  PDP8_SymbolsFromListing(struct PDP8_Symbols *symbols, const char *file_name);
+
+#endif //PDP8_SYMBOLS_H
+
+#if defined (__cplusplus)
+}
+#endif
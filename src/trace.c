@@ -0,0 +1,164 @@
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "trace.h"
+#include "loader.h"
+#include "instruction.h"
+
+#define TRACE_MAGIC       "PDP8TRC1"
+#define TRACE_IDLE_NS     100000
+#define FILE_BUFFER_SIZE  (1 << 20)
+
+static void *consume(void *argument) {
+  struct PDP8_Trace *trace = (struct PDP8_Trace *)argument;
+  uint64_t capacity = trace->mask + 1;
+  uint64_t tail = trace->tail;
+
+  for (;;) {
+    uint64_t head = __atomic_load_n(&trace->head, __ATOMIC_ACQUIRE);
+    if (head == tail) {
+      if (__atomic_load_n(&trace->stop, __ATOMIC_ACQUIRE)) {
+        // the producer has finished; one last look for stragglers
+        if (__atomic_load_n(&trace->head, __ATOMIC_ACQUIRE) == tail) break;
+        continue;
+      }
+      struct timespec idle = { 0, TRACE_IDLE_NS };
+      nanosleep(&idle, NULL);
+      continue;
+    }
+
+    while (tail != head) {
+      uint64_t index = tail & trace->mask;
+      uint64_t count = head - tail;
+      if (count > capacity - index) count = capacity - index;
+
+      if (trace->status == PDP8_OK) {
+        trace->status = trace->sink.write(trace->sink.context, &trace->ring[index], count);
+      }
+      tail += count;
+    }
+    __atomic_store_n(&trace->tail, tail, __ATOMIC_RELEASE);
+  }
+
+  return NULL;
+}
+
+int PDP8_TraceOpen(struct PDP8_Trace *trace, uint capacity_log2, struct PDP8_TraceSink sink) {
+  memset(trace, 0, sizeof(*trace));
+  trace->sink = sink;
+  trace->status = PDP8_OK;
+  trace->mask = ((uint64_t)1 << capacity_log2) - 1;
+
+  trace->ring = (struct PDP8_TraceRecord *)malloc((trace->mask + 1) * sizeof(struct PDP8_TraceRecord));
+  if (!trace->ring) {
+    sink.close(sink.context);
+    return PDP8_ERROR_MEMORY;
+  }
+
+  if (pthread_create(&trace->thread, NULL, consume, trace) != 0) {
+    free(trace->ring);
+    trace->ring = NULL;
+    sink.close(sink.context);
+    return PDP8_ERROR_MEMORY;
+  }
+
+  return PDP8_OK;
+}
+
+int PDP8_TraceClose(struct PDP8_Trace *trace) {
+  __atomic_store_n(&trace->stop, 1, __ATOMIC_RELEASE);
+  pthread_join(trace->thread, NULL);
+
+  int status = trace->sink.close(trace->sink.context);
+  if (trace->status == PDP8_OK) trace->status = status;
+
+  free(trace->ring);
+  trace->ring = NULL;
+
+  return trace->status;
+}
+
+static int file_write(void *context, const struct PDP8_TraceRecord *records, size_t count) {
+  FILE *file = (FILE *)context;
+  return fwrite(records, sizeof(struct PDP8_TraceRecord), count, file) == count ? PDP8_OK : PDP8_ERROR_WRITE;
+}
+
+static int file_close(void *context) {
+  return fclose((FILE *)context) == 0 ? PDP8_OK : PDP8_ERROR_WRITE;
+}
+
+// Raw trace file: the 8 byte magic followed by native PDP8_TraceRecords.
+int PDP8_TraceOpenFile(struct PDP8_Trace *trace, const char *file_name) {
+  FILE *file = fopen(file_name, "wb");
+  if (!file) {
+    return PDP8_ERROR_OPEN;
+  }
+  setvbuf(file, NULL, _IOFBF, FILE_BUFFER_SIZE);
+
+  if (fwrite(TRACE_MAGIC, 1, 8, file) != 8) {
+    fclose(file);
+    return PDP8_ERROR_WRITE;
+  }
+
+  struct PDP8_TraceSink sink;
+  sink.context = file;
+  sink.write = file_write;
+  sink.close = file_close;
+
+  return PDP8_TraceOpen(trace, 20, sink);
+}
+
+// The effective address of the instruction at PC, worked out from memory
+// before it runs: MA afterwards is 0 when an interrupt was taken.
+static inline uint effective_address(const struct PDP8 *pdp8) {
+  uint ir = pdp8->memory[pdp8->pc];
+  if ((ir >> 9) >= PDP8_IOT) return 0;
+
+  uint eadd = PDP8_DirectAddress(ir, pdp8->pc);
+  if ((ir & INDIRECT_BIT) == 0) return eadd;
+  return PDP8_IndirectAddress(eadd, pdp8->memory[eadd]);
+}
+
+static inline void push(struct PDP8_Trace *trace, const struct PDP8 *pdp8, uint ea, uint cycles) {
+  uint64_t head = trace->head;
+
+  // full: wait for the consumer rather than drop records
+  while (head - trace->cached_tail > trace->mask) {
+    trace->cached_tail = __atomic_load_n(&trace->tail, __ATOMIC_ACQUIRE);
+    if (head - trace->cached_tail > trace->mask) sched_yield();
+  }
+
+  struct PDP8_TraceRecord *record = &trace->ring[head & trace->mask];
+  record->pc     = pdp8->last_pc;
+  record->ir     = pdp8->ir;
+  record->lac    = pdp8->lac;
+  record->ea     = ea;
+  record->cycles = cycles;
+
+  __atomic_store_n(&trace->head, head + 1, __ATOMIC_RELEASE);
+}
+
+bool PDP8_TraceStep(struct PDP8_Trace *trace, struct PDP8 *pdp8) {
+  uint64_t cycles = pdp8->cycles;
+  uint ea = effective_address(pdp8);
+  bool run = PDP8_Step(pdp8);
+  push(trace, pdp8, ea, pdp8->cycles - cycles);
+  return run;
+}
+
+int PDP8_TraceRun(struct PDP8_Trace *trace, struct PDP8 *pdp8, uint64_t budget, uint64_t *executed) {
+  uint64_t count = 0;
+  while (pdp8->run && count < budget) {
+    PDP8_TraceStep(trace, pdp8);
+    count++;
+  }
+
+  if (executed) *executed = count;
+  return pdp8->run ? PDP8_STOP_BUDGET : PDP8_STOP_HALT;
+}
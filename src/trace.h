@@ -0,0 +1,58 @@
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+#ifndef PDP8_TRACE_H
+#define PDP8_TRACE_H
+
+#include <pthread.h>
+#include <stddef.h>
+
+#include "pdp8.h"
+
+  // One executed instruction.
+  struct PDP8_TraceRecord {
+    uint16_t pc;                       //  last.pc<0:11>
+    uint16_t ir;                       //  i<0:11>
+    uint16_t lac;                      //  LAC<0:12> after execution
+    uint16_t ea;                       //  effective address<0:11> of a memory
+                                       //  reference instruction, 0 for IOT and OPR
+    uint16_t cycles;                   //  memory cycles taken
+  };
+
+  // Destination for drained records, called on the consumer thread only.
+  struct PDP8_TraceSink {
+    void *context;
+    int  (*write)(void *context, const struct PDP8_TraceRecord *records, size_t count);
+    int  (*close)(void *context);
+  };
+
+  // Single producer, single consumer ring. The emulation thread pushes one
+  // record per instruction; a consumer thread drains the ring to the sink.
+  struct PDP8_Trace {
+    struct PDP8_TraceRecord *ring;
+    uint64_t mask;                     //  capacity - 1
+    uint64_t head;                     //  next record to write, producer owned
+    uint64_t tail;                     //  next record to drain, consumer owned
+    uint64_t cached_tail;              //  producer's last view of tail
+    int stop;
+
+    struct PDP8_TraceSink sink;
+    int status;                        //  first sink error
+    pthread_t thread;
+  };
+
+  extern int  PDP8_TraceOpen(struct PDP8_Trace *trace, uint capacity_log2, struct PDP8_TraceSink sink);
+  extern int  PDP8_TraceOpenFile(struct PDP8_Trace *trace, const char *file_name);
+  extern int  PDP8_TraceClose(struct PDP8_Trace *trace);
+
+  // Tracing variants of PDP8_Step and PDP8_RunFor; the untraced engine is
+  // not touched, so disabled tracing costs nothing.
+  extern bool PDP8_TraceStep(struct PDP8_Trace *trace, struct PDP8 *pdp8);
+  extern int  PDP8_TraceRun(struct PDP8_Trace *trace, struct PDP8 *pdp8, uint64_t budget, uint64_t *executed);
+
+#endif //PDP8_TRACE_H
+
+#if defined (__cplusplus)
+}
+#endif
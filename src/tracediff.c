@@ -0,0 +1,225 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tracediff.h"
+#include "tracefile.h"
+#include "disassembler.h"
+#include "loader.h"
+
+#define COMPARE_BLOCK 4096
+
+bool PDP8_ReferenceStep(struct PDP8 *pdp8, void *context) {
+  (void)context;
+  return PDP8_Step(pdp8);
+}
+
+struct side {
+  struct PDP8 *pdp8;
+  PDP8_StepFunction step;
+  void *context;
+};
+
+// Steps both machines count times; a halted machine stays put.
+static uint64_t run_both(struct side *a, struct side *b, uint64_t count) {
+  uint64_t i;
+  for (i = 0; i < count; ++i) {
+    if (!a->pdp8->run && !b->pdp8->run) break;
+    if (a->pdp8->run) a->step(a->pdp8, a->context);
+    if (b->pdp8->run) b->step(b->pdp8, b->context);
+  }
+  return i;
+}
+
+static bool same_state(const struct side *a, const struct side *b) {
+  return PDP8_StateHash(a->pdp8) == PDP8_StateHash(b->pdp8);
+}
+
+int PDP8_FindDivergence(struct PDP8 *pdp8_a, PDP8_StepFunction step_a, void *context_a,
+                        struct PDP8 *pdp8_b, PDP8_StepFunction step_b, void *context_b,
+                        uint64_t budget, uint64_t interval, struct PDP8_Divergence *divergence) {
+  struct side a = { pdp8_a, step_a, context_a };
+  struct side b = { pdp8_b, step_b, context_b };
+
+  divergence->found = false;
+  divergence->instruction = 0;
+  divergence->reexecuted = 0;
+  if (interval == 0) interval = 1;
+
+  struct PDP8 *checkpoint_a = (struct PDP8 *)malloc(sizeof(struct PDP8));
+  struct PDP8 *checkpoint_b = (struct PDP8 *)malloc(sizeof(struct PDP8));
+  if (!checkpoint_a || !checkpoint_b) {
+    free(checkpoint_a);
+    free(checkpoint_b);
+    return PDP8_ERROR_MEMORY;
+  }
+
+  *checkpoint_a = *pdp8_a;
+  *checkpoint_b = *pdp8_b;
+  uint64_t checkpoint = 0;
+  uint64_t executed = 0;
+
+  if (!same_state(&a, &b)) {
+    divergence->found = true;
+    divergence->before = *pdp8_a;
+  }
+
+  while (!divergence->found && executed < budget) {
+    uint64_t count = budget - executed < interval ? budget - executed : interval;
+    uint64_t done = run_both(&a, &b, count);
+    executed += done;
+
+    if (same_state(&a, &b)) {
+      *checkpoint_a = *pdp8_a;
+      *checkpoint_b = *pdp8_b;
+      checkpoint = executed;
+      if (done < count) break;  // both halted
+      continue;
+    }
+
+    // the states matched at checkpoint and differ at executed
+    uint64_t low = checkpoint, high = executed;
+    while (high - low > 1) {
+      uint64_t middle = low + (high - low) / 2;
+      *pdp8_a = *checkpoint_a;
+      *pdp8_b = *checkpoint_b;
+      divergence->reexecuted += run_both(&a, &b, middle - low);
+
+      if (same_state(&a, &b)) {
+        *checkpoint_a = *pdp8_a;
+        *checkpoint_b = *pdp8_b;
+        low = middle;
+      } else {
+        high = middle;
+      }
+    }
+
+    *pdp8_a = *checkpoint_a;
+    *pdp8_b = *checkpoint_b;
+    divergence->before = *pdp8_a;
+    divergence->reexecuted += run_both(&a, &b, 1);
+    divergence->found = true;
+    divergence->instruction = low;
+  }
+
+  if (divergence->found) {
+    divergence->a = *pdp8_a;
+    divergence->b = *pdp8_b;
+  }
+
+  free(checkpoint_a);
+  free(checkpoint_b);
+  return PDP8_OK;
+}
+
+static bool same_record(const struct PDP8_TraceRecord *a, const struct PDP8_TraceRecord *b) {
+  return a->pc == b->pc && a->ir == b->ir && a->lac == b->lac && a->ea == b->ea && a->cycles == b->cycles;
+}
+
+static int compare_traces(struct PDP8_TraceReader *a, struct PDP8_TraceReader *b, struct PDP8_TraceDivergence *divergence) {
+  // equal chunks at the same place are skipped without decompressing them
+  uint64_t position = 0;
+  if (a->compressed && b->compressed) {
+    uint64_t i = 0;
+    while (i < a->chunk_count && i < b->chunk_count &&
+           a->chunks[i].first == b->chunks[i].first && a->chunks[i].count == b->chunks[i].count &&
+           a->chunks[i].hash == b->chunks[i].hash) {
+      position = a->chunks[i].first + a->chunks[i].count;
+      i++;
+    }
+    divergence->chunks_skipped = i;
+  }
+
+  int status = PDP8_TraceReaderSeek(a, position);
+  if (status == PDP8_OK) status = PDP8_TraceReaderSeek(b, position);
+  if (status != PDP8_OK) return status;
+
+  struct PDP8_TraceRecord *block_a = (struct PDP8_TraceRecord *)malloc(2 * COMPARE_BLOCK * sizeof(struct PDP8_TraceRecord));
+  if (!block_a) return PDP8_ERROR_MEMORY;
+  struct PDP8_TraceRecord *block_b = block_a + COMPARE_BLOCK;
+
+  for (;;) {
+    size_t count_a, count_b;
+    status = PDP8_TraceReaderRead(a, block_a, COMPARE_BLOCK, &count_a);
+    if (status == PDP8_OK) status = PDP8_TraceReaderRead(b, block_b, COMPARE_BLOCK, &count_b);
+    if (status != PDP8_OK) break;
+
+    size_t count = count_a < count_b ? count_a : count_b;
+    size_t i = 0;
+    while (i < count && same_record(&block_a[i], &block_b[i])) i++;
+
+    if (i < count || count_a != count_b) {
+      divergence->found = true;
+      divergence->record = position + i;
+      divergence->a_valid = i < count_a;
+      divergence->b_valid = i < count_b;
+      if (divergence->a_valid) divergence->a = block_a[i];
+      if (divergence->b_valid) divergence->b = block_b[i];
+      break;
+    }
+    if (count == 0) break;
+    position += count;
+  }
+
+  free(block_a);
+  return status;
+}
+
+int PDP8_TraceDiff(const char *file_a, const char *file_b, struct PDP8_TraceDivergence *divergence) {
+  memset(divergence, 0, sizeof(*divergence));
+
+  struct PDP8_TraceReader a, b;
+  int status = PDP8_TraceReaderOpen(&a, file_a);
+  if (status != PDP8_OK) return status;
+
+  status = PDP8_TraceReaderOpen(&b, file_b);
+  if (status == PDP8_OK) {
+    status = compare_traces(&a, &b, divergence);
+    PDP8_TraceReaderClose(&b);
+  }
+  PDP8_TraceReaderClose(&a);
+
+  return status;
+}
+
+static void print_register(FILE *out, const char *name, uint a, uint b, uint digits) {
+  if (a != b) fprintf(out, "  %-18s %0*o %0*o\n", name, digits, a, digits, b);
+}
+
+void PDP8_PrintStateDiff(FILE *out, const struct PDP8 *a, const struct PDP8 *b) {
+  fprintf(out, "  %-18s %-4s %-4s\n", "", "a", "b");
+  print_register(out, "PC", a->pc, b->pc, 4);
+  print_register(out, "L", a->link, b->link, 1);
+  print_register(out, "AC", a->ac, b->ac, 4);
+  print_register(out, "MQ", a->mq, b->mq, 4);
+  print_register(out, "MA", a->ma, b->ma, 4);
+  print_register(out, "MB", a->mb, b->mb, 4);
+  print_register(out, "IR", a->ir, b->ir, 4);
+  print_register(out, "RUN", a->run, b->run, 1);
+  print_register(out, "INTERRUPT.ENABLE", a->interrupt_enable, b->interrupt_enable, 1);
+  print_register(out, "INTERRUPT.REQUEST", a->interrupt_request, b->interrupt_request, 1);
+  print_register(out, "SWITCHES", a->switches, b->switches, 4);
+  print_register(out, "KBD.FLAG", a->keyboard_flag, b->keyboard_flag, 1);
+  print_register(out, "KBD.BUFFER", a->keyboard_buffer, b->keyboard_buffer, 3);
+  print_register(out, "TTO.FLAG", a->printer_flag, b->printer_flag, 1);
+  print_register(out, "TTO.BUFFER", a->printer_buffer, b->printer_buffer, 3);
+  if (a->cycles != b->cycles) {
+    fprintf(out, "  %-18s %llu %llu\n", "cycles", (unsigned long long)a->cycles, (unsigned long long)b->cycles);
+  }
+
+  for (uint i = 0; i < PDP8_MEMORY_SIZE; ++i) {
+    if (a->memory[i] != b->memory[i]) {
+      fprintf(out, "  memory %04o        %04o %04o\n", i, a->memory[i], b->memory[i]);
+    }
+  }
+}
+
+void PDP8_PrintTraceRecord(FILE *out, const char *label, const struct PDP8_TraceRecord *record) {
+  char text[PDP8_DISASSEMBLY_LENGTH];
+  PDP8_Disassemble(record->ir, record->pc, NULL, text);
+  fprintf(out, "%s PC %04o IR %04o %-16s L %o AC %04o EA %04o cycles %u\n", label,
+          record->pc, record->ir, text, (record->lac >> 12) & 1, record->lac & PDP8_WORD_MASK,
+          record->ea, record->cycles);
+}
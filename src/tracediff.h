@@ -0,0 +1,55 @@
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+#ifndef PDP8_TRACEDIFF_H
+#define PDP8_TRACEDIFF_H
+
+#include <stdio.h>
+
+#include "pdp8.h"
+#include "trace.h"
+
+  // Advances a machine by one instruction; any engine or device model can
+  // be compared as long as all of its state lives in struct PDP8.
+  typedef bool (*PDP8_StepFunction)(struct PDP8 *pdp8, void *context);
+
+  struct PDP8_Divergence {
+    bool found;
+    uint64_t instruction;              //  0-based number of the first diverging instruction
+    uint64_t reexecuted;               //  instructions re-run by the binary search
+    struct PDP8 before;                //  common state before it
+    struct PDP8 a;                     //  states after it
+    struct PDP8 b;
+  };
+
+  struct PDP8_TraceDivergence {
+    bool found;
+    uint64_t record;                   //  first differing record, or the shorter length
+    bool a_valid, b_valid;             //  false past the end of a trace
+    struct PDP8_TraceRecord a;
+    struct PDP8_TraceRecord b;
+    uint64_t chunks_skipped;           //  chunks proven equal by their index hash
+  };
+
+  // Runs both machines for up to budget instructions, comparing state
+  // hashes every interval instructions, then binary searches the last
+  // interval by re-execution from the last matching checkpoint.  The step
+  // functions must be deterministic given struct PDP8.  Both machines are
+  // left in the diverged states.
+  extern int PDP8_FindDivergence(struct PDP8 *a, PDP8_StepFunction step_a, void *context_a,
+                                 struct PDP8 *b, PDP8_StepFunction step_b, void *context_b,
+                                 uint64_t budget, uint64_t interval, struct PDP8_Divergence *divergence);
+
+  extern int PDP8_TraceDiff(const char *file_a, const char *file_b, struct PDP8_TraceDivergence *divergence);
+
+  extern void PDP8_PrintStateDiff(FILE *out, const struct PDP8 *a, const struct PDP8 *b);
+  extern void PDP8_PrintTraceRecord(FILE *out, const char *label, const struct PDP8_TraceRecord *record);
+
+  extern bool PDP8_ReferenceStep(struct PDP8 *pdp8, void *context);
+
+#endif //PDP8_TRACEDIFF_H
+
+#if defined (__cplusplus)
+}
+#endif
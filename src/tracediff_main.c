@@ -0,0 +1,117 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pdp8.h"
+#include "loader.h"
+#include "tracediff.h"
+
+#define DEFAULT_BUDGET   100000000
+#define DEFAULT_INTERVAL 65536
+
+static int usage(const char *name) {
+  fprintf(stderr, "usage: %s a.trace b.trace\n", name);
+  fprintf(stderr, "       %s -l image-a image-b [-s switches] [-n budget] [-i interval]\n", name);
+  fprintf(stderr, "  exits 0 when equal, 1 at a divergence, 2 on error; numbers are octal\n");
+  fprintf(stderr, "  except budget and interval\n");
+  return 2;
+}
+
+static int load(struct PDP8 *pdp8, const char *file_name, uint switches) {
+  struct PDP8_Image image;
+  int status = PDP8_ImageFromFile(&image, file_name);
+  if (status != PDP8_OK) {
+    fprintf(stderr, "%s: %s\n", file_name, PDP8_StatusString(status));
+    return status;
+  }
+
+  PDP8_Reset(pdp8);
+  PDP8_MemoryReset(pdp8);
+  PDP8_LoadImage(pdp8, &image);
+  PDP8_StartImage(pdp8, &image);
+  pdp8->switches = switches;
+  PDP8_ImageFree(&image);
+  return PDP8_OK;
+}
+
+static int diff_live(const char *file_a, const char *file_b, uint switches, uint64_t budget, uint64_t interval) {
+  struct PDP8 *a = (struct PDP8 *)malloc(sizeof(struct PDP8));
+  struct PDP8 *b = (struct PDP8 *)malloc(sizeof(struct PDP8));
+  struct PDP8_Divergence *divergence = (struct PDP8_Divergence *)malloc(sizeof(struct PDP8_Divergence));
+  int result = 2;
+
+  if (a && b && divergence &&
+      load(a, file_a, switches) == PDP8_OK && load(b, file_b, switches) == PDP8_OK &&
+      PDP8_FindDivergence(a, PDP8_ReferenceStep, NULL, b, PDP8_ReferenceStep, NULL,
+                          budget, interval, divergence) == PDP8_OK) {
+    if (!divergence->found) {
+      printf("no divergence\n");
+      result = 0;
+    } else {
+      printf("diverged at instruction %llu (%llu re-executed)\n",
+             (unsigned long long)divergence->instruction, (unsigned long long)divergence->reexecuted);
+      printf("before: PC %04o L %o AC %04o\n", divergence->before.pc, divergence->before.link, divergence->before.ac);
+      PDP8_PrintStateDiff(stdout, &divergence->a, &divergence->b);
+      result = 1;
+    }
+  }
+
+  free(a);
+  free(b);
+  free(divergence);
+  return result;
+}
+
+static int diff_traces(const char *file_a, const char *file_b) {
+  struct PDP8_TraceDivergence divergence;
+  int status = PDP8_TraceDiff(file_a, file_b, &divergence);
+  if (status != PDP8_OK) {
+    fprintf(stderr, "%s, %s: %s\n", file_a, file_b, PDP8_StatusString(status));
+    return 2;
+  }
+
+  if (!divergence.found) {
+    printf("no divergence\n");
+    return 0;
+  }
+
+  printf("diverged at record %llu (%llu chunks skipped)\n",
+         (unsigned long long)divergence.record, (unsigned long long)divergence.chunks_skipped);
+  if (divergence.a_valid) PDP8_PrintTraceRecord(stdout, "a:", &divergence.a);
+  else printf("a: end of trace\n");
+  if (divergence.b_valid) PDP8_PrintTraceRecord(stdout, "b:", &divergence.b);
+  else printf("b: end of trace\n");
+  return 1;
+}
+
+int main(int argc, char **argv) {
+  const char *files[2] = { NULL, NULL };
+  uint file_count = 0;
+  bool live = false;
+  uint switches = 0;
+  uint64_t budget = DEFAULT_BUDGET;
+  uint64_t interval = DEFAULT_INTERVAL;
+
+  for (int i = 1; i < argc; ++i) {
+    const char *arg = argv[i];
+    if (arg[0] != '-') {
+      if (file_count == 2) return usage(argv[0]);
+      files[file_count++] = arg;
+    } else if (!strcmp(arg, "-l")) {
+      live = true;
+    } else if (i + 1 >= argc) {
+      return usage(argv[0]);
+    } else if (!strcmp(arg, "-s")) {
+      if (!PDP8_ParseOctal(argv[++i], &switches)) return usage(argv[0]);
+    } else if (!strcmp(arg, "-n")) {
+      budget = strtoull(argv[++i], NULL, 10);
+    } else if (!strcmp(arg, "-i")) {
+      interval = strtoull(argv[++i], NULL, 10);
+    } else {
+      return usage(argv[0]);
+    }
+  }
+  if (file_count != 2) return usage(argv[0]);
+
+  return live ? diff_live(files[0], files[1], switches, budget, interval) : diff_traces(files[0], files[1]);
+}
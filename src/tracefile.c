@@ -0,0 +1,519 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+
+#include "tracefile.h"
+#include "loader.h"
+
+// Compressed trace file:
+//   "PDP8TRZ1"
+//   chunk data, each chunk deflated independently
+//   struct PDP8_TraceChunk index[chunk_count]
+//   struct footer
+//
+// Before deflate every chunk is a token stream that starts from an empty
+// model, so any chunk can be decoded on its own:
+//   0fffffff        literal record, f says which fields differ from the
+//                   prediction and follow: PC (zigzag delta from PC + 1),
+//                   IR (2 bytes, predicted from the last IR at this PC),
+//                   LAC (xor with the last LAC), EA (2 bytes) and cycles
+//                   (1 byte), all predicted per PC
+//   1ddddddd n      the next n records repeat those d + 1 records back,
+//                   which covers wait loops and counting loops
+// Multi-byte numbers are little endian; n and the deltas are LEB128.
+
+#define RAW_MAGIC        "PDP8TRC1"
+#define COMPRESSED_MAGIC "PDP8TRZ1"
+#define FOOTER_MAGIC     "PDP8TRZE"
+#define MAGIC_LENGTH     8
+
+#define TAG_REPEAT       0x80
+#define MAX_DISTANCE     0x80
+#define MIN_REPEAT       2
+
+#define FIELD_PC         0x01
+#define FIELD_IR         0x02
+#define FIELD_LAC        0x04
+#define FIELD_EA         0x08
+#define FIELD_CYCLES     0x10
+
+#define MAX_LITERAL_SIZE 13
+
+struct footer {
+  uint64_t index_offset;
+  uint64_t chunk_count;
+  uint64_t record_count;
+  char magic[MAGIC_LENGTH];
+};
+
+struct model {
+  struct PDP8_TraceRecord last;
+  uint16_t ir[PDP8_MEMORY_SIZE];
+  uint16_t ea[PDP8_MEMORY_SIZE];
+  uint8_t cycles[PDP8_MEMORY_SIZE];
+  int32_t seen[PDP8_MEMORY_SIZE];      // encoder only: last record index per PC
+};
+
+static void model_reset(struct model *model) {
+  memset(model, 0, sizeof(*model));
+  model->last.pc = PDP8_WORD_MASK;
+}
+
+static void model_update(struct model *model, const struct PDP8_TraceRecord *record) {
+  uint pc = record->pc & PDP8_WORD_MASK;
+  model->ir[pc] = record->ir;
+  model->ea[pc] = record->ea;
+  model->cycles[pc] = record->cycles;
+  model->last = *record;
+}
+
+static uint32_t hash_records(const struct PDP8_TraceRecord *records, size_t count) {
+  const unsigned char *bytes = (const unsigned char *)records;
+  uint32_t h = 2166136261u;
+  for (size_t i = 0; i < count * sizeof(struct PDP8_TraceRecord); ++i) {
+    h = (h ^ bytes[i]) * 16777619u;
+  }
+  return h;
+}
+
+static bool same_record(const struct PDP8_TraceRecord *a, const struct PDP8_TraceRecord *b) {
+  return a->pc == b->pc && a->ir == b->ir && a->lac == b->lac && a->ea == b->ea && a->cycles == b->cycles;
+}
+
+static unsigned char *put_varint(unsigned char *out, uint64_t value) {
+  while (value >= 0x80) {
+    *out++ = (value & 0x7F) | 0x80;
+    value >>= 7;
+  }
+  *out++ = value;
+  return out;
+}
+
+static unsigned char *put_word(unsigned char *out, uint value) {
+  out[0] = value & 0xFF;
+  out[1] = value >> 8;
+  return out + 2;
+}
+
+// Worst case output size is MAX_LITERAL_SIZE bytes per record.
+static size_t encode_chunk(struct model *model, const struct PDP8_TraceRecord *records, size_t count, unsigned char *out) {
+  unsigned char *start = out;
+  int32_t *seen = model->seen;
+  model_reset(model);
+  memset(seen, 0xFF, sizeof(model->seen));
+
+  size_t i = 0;
+  while (i < count) {
+    // a loop comes back to the same PC, so the last visit is the candidate
+    const struct PDP8_TraceRecord *record = &records[i];
+    uint pc = record->pc & PDP8_WORD_MASK;
+    size_t best_length = 0, best_distance = i - seen[pc];
+    if (seen[pc] >= 0 && best_distance <= MAX_DISTANCE) {
+      while (i + best_length < count && same_record(&records[i + best_length], &records[i + best_length - best_distance])) {
+        best_length++;
+      }
+    }
+
+    if (best_length >= MIN_REPEAT) {
+      *out++ = TAG_REPEAT | (best_distance - 1);
+      out = put_varint(out, best_length);
+      for (size_t k = 0; k < best_length; ++k, ++i) {
+        model_update(model, &records[i]);
+        seen[records[i].pc & PDP8_WORD_MASK] = i;
+      }
+      continue;
+    }
+
+    uint predicted_pc = (model->last.pc + 1) & PDP8_WORD_MASK;
+
+    unsigned char *flags = out++;
+    *flags = 0;
+    if (pc != predicted_pc) {
+      int delta = (int)((pc - predicted_pc) & PDP8_WORD_MASK);
+      if (delta >= (int)PDP8_WORD_SIGN) delta -= PDP8_MEMORY_SIZE;
+      *flags |= FIELD_PC;
+      out = put_varint(out, (uint)((delta << 1) ^ (delta >> 31)));
+    }
+    if (record->ir != model->ir[pc]) {
+      *flags |= FIELD_IR;
+      out = put_word(out, record->ir);
+    }
+    if (record->lac != model->last.lac) {
+      *flags |= FIELD_LAC;
+      out = put_varint(out, record->lac ^ model->last.lac);
+    }
+    if (record->ea != model->ea[pc]) {
+      *flags |= FIELD_EA;
+      out = put_word(out, record->ea);
+    }
+    if (record->cycles != model->cycles[pc]) {
+      *flags |= FIELD_CYCLES;
+      *out++ = record->cycles;
+    }
+
+    model_update(model, record);
+    seen[pc] = i++;
+  }
+
+  return out - start;
+}
+
+static bool get_varint(const unsigned char **in, const unsigned char *end, uint64_t *value) {
+  *value = 0;
+  for (uint shift = 0; *in < end && shift < 64; shift += 7) {
+    unsigned char byte = *(*in)++;
+    *value |= (uint64_t)(byte & 0x7F) << shift;
+    if (!(byte & 0x80)) return true;
+  }
+  return false;
+}
+
+static int decode_chunk(struct model *model, const unsigned char *in, size_t length,
+                        struct PDP8_TraceRecord *records, size_t count) {
+  const unsigned char *end = in + length;
+  model_reset(model);
+
+  size_t i = 0;
+  while (i < count) {
+    if (in >= end) return PDP8_ERROR_FORMAT;
+    unsigned char tag = *in++;
+
+    if (tag & TAG_REPEAT) {
+      size_t distance = (tag & ~TAG_REPEAT) + 1;
+      uint64_t n;
+      if (!get_varint(&in, end, &n) || distance > i || n > count - i) return PDP8_ERROR_FORMAT;
+      for (uint64_t k = 0; k < n; ++k, ++i) {
+        records[i] = records[i - distance];
+        model_update(model, &records[i]);
+      }
+      continue;
+    }
+
+    struct PDP8_TraceRecord *record = &records[i++];
+    uint pc = (model->last.pc + 1) & PDP8_WORD_MASK;
+    uint64_t value;
+
+    if (tag & FIELD_PC) {
+      if (!get_varint(&in, end, &value)) return PDP8_ERROR_FORMAT;
+      int delta = (int)(value >> 1) ^ -(int)(value & 1);
+      pc = (pc + delta) & PDP8_WORD_MASK;
+    }
+    record->pc = pc;
+    record->ir = model->ir[pc];
+    record->lac = model->last.lac;
+    record->ea = model->ea[pc];
+    record->cycles = model->cycles[pc];
+
+    if (tag & FIELD_IR) {
+      if (end - in < 2) return PDP8_ERROR_FORMAT;
+      record->ir = in[0] | (in[1] << 8);
+      in += 2;
+    }
+    if (tag & FIELD_LAC) {
+      if (!get_varint(&in, end, &value)) return PDP8_ERROR_FORMAT;
+      record->lac ^= value;
+    }
+    if (tag & FIELD_EA) {
+      if (end - in < 2) return PDP8_ERROR_FORMAT;
+      record->ea = in[0] | (in[1] << 8);
+      in += 2;
+    }
+    if (tag & FIELD_CYCLES) {
+      if (in >= end) return PDP8_ERROR_FORMAT;
+      record->cycles = *in++;
+    }
+
+    model_update(model, record);
+  }
+
+  return PDP8_OK;
+}
+
+struct compressed_sink {
+  FILE *file;
+  uint64_t offset;
+  uint64_t records;
+  int status;
+
+  struct PDP8_TraceRecord *chunk;
+  uint32_t count;
+  unsigned char *encoded;
+  unsigned char *compressed;
+  uLong compressed_capacity;
+
+  struct PDP8_TraceChunk *index;
+  uint64_t index_count;
+  uint64_t index_capacity;
+
+  struct model model;
+};
+
+static int flush_chunk(struct compressed_sink *sink) {
+  if (sink->count == 0) return PDP8_OK;
+
+  size_t encoded = encode_chunk(&sink->model, sink->chunk, sink->count, sink->encoded);
+  uLongf compressed = sink->compressed_capacity;
+  if (compress2(sink->compressed, &compressed, sink->encoded, encoded, Z_DEFAULT_COMPRESSION) != Z_OK) {
+    return PDP8_ERROR_MEMORY;
+  }
+  if (fwrite(sink->compressed, 1, compressed, sink->file) != compressed) {
+    return PDP8_ERROR_WRITE;
+  }
+
+  if (sink->index_count == sink->index_capacity) {
+    uint64_t capacity = sink->index_capacity ? sink->index_capacity * 2 : 64;
+    void *index = realloc(sink->index, capacity * sizeof(struct PDP8_TraceChunk));
+    if (!index) return PDP8_ERROR_MEMORY;
+    sink->index = (struct PDP8_TraceChunk *)index;
+    sink->index_capacity = capacity;
+  }
+
+  struct PDP8_TraceChunk *entry = &sink->index[sink->index_count++];
+  entry->offset = sink->offset;
+  entry->first = sink->records;
+  entry->count = sink->count;
+  entry->compressed_size = compressed;
+  entry->encoded_size = encoded;
+  entry->hash = hash_records(sink->chunk, sink->count);
+
+  sink->offset += compressed;
+  sink->records += sink->count;
+  sink->count = 0;
+
+  return PDP8_OK;
+}
+
+static int compressed_write(void *context, const struct PDP8_TraceRecord *records, size_t count) {
+  struct compressed_sink *sink = (struct compressed_sink *)context;
+
+  while (count > 0) {
+    size_t n = PDP8_TRACE_CHUNK_RECORDS - sink->count;
+    if (n > count) n = count;
+    memcpy(&sink->chunk[sink->count], records, n * sizeof(struct PDP8_TraceRecord));
+    sink->count += n;
+    records += n;
+    count -= n;
+
+    if (sink->count == PDP8_TRACE_CHUNK_RECORDS) {
+      int status = flush_chunk(sink);
+      if (status != PDP8_OK) return status;
+    }
+  }
+
+  return PDP8_OK;
+}
+
+static void free_sink(struct compressed_sink *sink) {
+  free(sink->chunk);
+  free(sink->encoded);
+  free(sink->compressed);
+  free(sink->index);
+  free(sink);
+}
+
+static int compressed_close(void *context) {
+  struct compressed_sink *sink = (struct compressed_sink *)context;
+
+  int status = flush_chunk(sink);
+  if (status == PDP8_OK) {
+    struct footer footer;
+    footer.index_offset = sink->offset;
+    footer.chunk_count = sink->index_count;
+    footer.record_count = sink->records;
+    memcpy(footer.magic, FOOTER_MAGIC, MAGIC_LENGTH);
+
+    size_t index_size = sink->index_count * sizeof(struct PDP8_TraceChunk);
+    if ((index_size && fwrite(sink->index, 1, index_size, sink->file) != index_size) ||
+        fwrite(&footer, sizeof(footer), 1, sink->file) != 1) {
+      status = PDP8_ERROR_WRITE;
+    }
+  }
+
+  if (fclose(sink->file) != 0 && status == PDP8_OK) {
+    status = PDP8_ERROR_WRITE;
+  }
+  free_sink(sink);
+
+  return status;
+}
+
+int PDP8_TraceOpenCompressed(struct PDP8_Trace *trace, const char *file_name) {
+  struct compressed_sink *sink = (struct compressed_sink *)calloc(1, sizeof(struct compressed_sink));
+  if (!sink) return PDP8_ERROR_MEMORY;
+
+  sink->compressed_capacity = compressBound(PDP8_TRACE_CHUNK_RECORDS * MAX_LITERAL_SIZE);
+  sink->chunk = (struct PDP8_TraceRecord *)malloc(PDP8_TRACE_CHUNK_RECORDS * sizeof(struct PDP8_TraceRecord));
+  sink->encoded = (unsigned char *)malloc(PDP8_TRACE_CHUNK_RECORDS * MAX_LITERAL_SIZE);
+  sink->compressed = (unsigned char *)malloc(sink->compressed_capacity);
+  if (!sink->chunk || !sink->encoded || !sink->compressed) {
+    free_sink(sink);
+    return PDP8_ERROR_MEMORY;
+  }
+
+  sink->file = fopen(file_name, "wb");
+  if (!sink->file) {
+    free_sink(sink);
+    return PDP8_ERROR_OPEN;
+  }
+  if (fwrite(COMPRESSED_MAGIC, 1, MAGIC_LENGTH, sink->file) != MAGIC_LENGTH) {
+    fclose(sink->file);
+    free_sink(sink);
+    return PDP8_ERROR_WRITE;
+  }
+  sink->offset = MAGIC_LENGTH;
+
+  struct PDP8_TraceSink trace_sink;
+  trace_sink.context = sink;
+  trace_sink.write = compressed_write;
+  trace_sink.close = compressed_close;
+
+  return PDP8_TraceOpen(trace, 20, trace_sink);
+}
+
+int PDP8_TraceReaderOpen(struct PDP8_TraceReader *reader, const char *file_name) {
+  memset(reader, 0, sizeof(*reader));
+
+  reader->file = fopen(file_name, "rb");
+  if (!reader->file) return PDP8_ERROR_OPEN;
+
+  char magic[MAGIC_LENGTH];
+  long size = -1;
+  if (fread(magic, 1, MAGIC_LENGTH, reader->file) != MAGIC_LENGTH ||
+      fseek(reader->file, 0, SEEK_END) != 0 || (size = ftell(reader->file)) < 0) {
+    PDP8_TraceReaderClose(reader);
+    return PDP8_ERROR_FORMAT;
+  }
+
+  if (!memcmp(magic, RAW_MAGIC, MAGIC_LENGTH)) {
+    reader->record_count = (size - MAGIC_LENGTH) / sizeof(struct PDP8_TraceRecord);
+    return PDP8_OK;
+  }
+
+  struct footer footer;
+  if (memcmp(magic, COMPRESSED_MAGIC, MAGIC_LENGTH) || size < (long)(MAGIC_LENGTH + sizeof(footer)) ||
+      fseek(reader->file, size - sizeof(footer), SEEK_SET) != 0 ||
+      fread(&footer, sizeof(footer), 1, reader->file) != 1 ||
+      memcmp(footer.magic, FOOTER_MAGIC, MAGIC_LENGTH) ||
+      footer.index_offset + footer.chunk_count * sizeof(struct PDP8_TraceChunk) + sizeof(footer) != (uint64_t)size) {
+    PDP8_TraceReaderClose(reader);
+    return PDP8_ERROR_FORMAT;
+  }
+
+  reader->compressed = true;
+  reader->record_count = footer.record_count;
+  reader->chunk_count = footer.chunk_count;
+  reader->loaded = footer.chunk_count;
+  reader->chunks = (struct PDP8_TraceChunk *)malloc(footer.chunk_count * sizeof(struct PDP8_TraceChunk) + 1);
+  reader->records = (struct PDP8_TraceRecord *)malloc(PDP8_TRACE_CHUNK_RECORDS * sizeof(struct PDP8_TraceRecord));
+  if (!reader->chunks || !reader->records) {
+    PDP8_TraceReaderClose(reader);
+    return PDP8_ERROR_MEMORY;
+  }
+
+  if (fseek(reader->file, footer.index_offset, SEEK_SET) != 0 ||
+      fread(reader->chunks, sizeof(struct PDP8_TraceChunk), footer.chunk_count, reader->file) != footer.chunk_count) {
+    PDP8_TraceReaderClose(reader);
+    return PDP8_ERROR_READ;
+  }
+
+  return PDP8_OK;
+}
+
+void PDP8_TraceReaderClose(struct PDP8_TraceReader *reader) {
+  if (reader->file) fclose(reader->file);
+  free(reader->chunks);
+  free(reader->records);
+  memset(reader, 0, sizeof(*reader));
+}
+
+int PDP8_TraceReaderSeek(struct PDP8_TraceReader *reader, uint64_t position) {
+  if (position > reader->record_count) return PDP8_ERROR_FORMAT;
+  reader->position = position;
+  return PDP8_OK;
+}
+
+static uint64_t find_chunk(const struct PDP8_TraceReader *reader, uint64_t position) {
+  uint64_t low = 0, high = reader->chunk_count;
+  while (high - low > 1) {
+    uint64_t middle = low + (high - low) / 2;
+    if (reader->chunks[middle].first <= position) low = middle;
+    else                                          high = middle;
+  }
+  return low;
+}
+
+static int load_chunk(struct PDP8_TraceReader *reader, uint64_t index) {
+  const struct PDP8_TraceChunk *chunk = &reader->chunks[index];
+  if (chunk->count > PDP8_TRACE_CHUNK_RECORDS || chunk->encoded_size > PDP8_TRACE_CHUNK_RECORDS * MAX_LITERAL_SIZE) {
+    return PDP8_ERROR_FORMAT;
+  }
+
+  unsigned char *compressed = (unsigned char *)malloc(chunk->compressed_size + chunk->encoded_size + 1);
+  struct model *model = (struct model *)malloc(sizeof(struct model));
+  int status = (compressed && model) ? PDP8_OK : PDP8_ERROR_MEMORY;
+
+  unsigned char *encoded = compressed + chunk->compressed_size;
+  if (status == PDP8_OK) {
+    if (fseek(reader->file, chunk->offset, SEEK_SET) != 0 ||
+        fread(compressed, 1, chunk->compressed_size, reader->file) != chunk->compressed_size) {
+      status = PDP8_ERROR_READ;
+    }
+  }
+  if (status == PDP8_OK) {
+    uLongf length = chunk->encoded_size;
+    if (uncompress(encoded, &length, compressed, chunk->compressed_size) != Z_OK || length != chunk->encoded_size) {
+      status = PDP8_ERROR_FORMAT;
+    }
+  }
+  if (status == PDP8_OK) {
+    status = decode_chunk(model, encoded, chunk->encoded_size, reader->records, chunk->count);
+  }
+  if (status == PDP8_OK && hash_records(reader->records, chunk->count) != chunk->hash) {
+    status = PDP8_ERROR_CHECKSUM;
+  }
+
+  free(compressed);
+  free(model);
+
+  reader->loaded = status == PDP8_OK ? index : reader->chunk_count;
+  return status;
+}
+
+int PDP8_TraceReaderRead(struct PDP8_TraceReader *reader, struct PDP8_TraceRecord *records,
+                         size_t max, size_t *count) {
+  *count = 0;
+
+  if (!reader->compressed) {
+    uint64_t available = reader->record_count - reader->position;
+    size_t n = available < max ? available : max;
+    if (fseek(reader->file, MAGIC_LENGTH + reader->position * sizeof(struct PDP8_TraceRecord), SEEK_SET) != 0 ||
+        fread(records, sizeof(struct PDP8_TraceRecord), n, reader->file) != n) {
+      return PDP8_ERROR_READ;
+    }
+    reader->position += n;
+    *count = n;
+    return PDP8_OK;
+  }
+
+  while (*count < max && reader->position < reader->record_count) {
+    uint64_t index = find_chunk(reader, reader->position);
+    if (index != reader->loaded) {
+      int status = load_chunk(reader, index);
+      if (status != PDP8_OK) return status;
+    }
+
+    const struct PDP8_TraceChunk *chunk = &reader->chunks[index];
+    uint64_t offset = reader->position - chunk->first;
+    size_t n = chunk->count - offset;
+    if (n > max - *count) n = max - *count;
+
+    memcpy(&records[*count], &reader->records[offset], n * sizeof(struct PDP8_TraceRecord));
+    *count += n;
+    reader->position += n;
+  }
+
+  return PDP8_OK;
+}
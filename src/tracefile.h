@@ -0,0 +1,52 @@
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+#ifndef PDP8_TRACEFILE_H
+#define PDP8_TRACEFILE_H
+
+#include <stdio.h>
+
+#include "trace.h"
+
+  enum PDP8_TraceFileConstants {
+    PDP8_TRACE_CHUNK_RECORDS = 65536,  // records per independently compressed chunk
+  };
+
+  // Index entry for one chunk; the index sits at the end of the file.
+  struct PDP8_TraceChunk {
+    uint64_t offset;                   //  file offset of the compressed data
+    uint64_t first;                    //  number of the first record
+    uint32_t count;                    //  records in the chunk
+    uint32_t compressed_size;
+    uint32_t encoded_size;             //  size before deflate
+    uint32_t hash;                     //  FNV-1a of the raw records
+  };
+
+  // Reads compressed (PDP8TRZ1) and raw (PDP8TRC1) trace files.
+  struct PDP8_TraceReader {
+    FILE *file;
+    bool compressed;
+    uint64_t record_count;
+
+    struct PDP8_TraceChunk *chunks;
+    uint64_t chunk_count;
+
+    struct PDP8_TraceRecord *records; //  decoded current chunk
+    uint64_t loaded;                   //  index of the loaded chunk, or chunk_count
+    uint64_t position;                 //  next record to read
+  };
+
+  extern int PDP8_TraceOpenCompressed(struct PDP8_Trace *trace, const char *file_name);
+
+  extern int  PDP8_TraceReaderOpen(struct PDP8_TraceReader *reader, const char *file_name);
+  extern void PDP8_TraceReaderClose(struct PDP8_TraceReader *reader);
+  extern int  PDP8_TraceReaderSeek(struct PDP8_TraceReader *reader, uint64_t position);
+  extern int  PDP8_TraceReaderRead(struct PDP8_TraceReader *reader, struct PDP8_TraceRecord *records,
+                                   size_t max, size_t *count);
+
+#endif //PDP8_TRACEFILE_H
+
+#if defined (__cplusplus)
+}
+#endif
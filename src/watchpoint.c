@@ -0,0 +1,32 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "watchpoint.h"
+
+void PDP8_WatchpointsInit(struct PDP8_Watchpoints *watchpoints) {
+  memset(watchpoints, 0, sizeof(*watchpoints));
+}
+
+static void change(struct PDP8_Watchpoints *watchpoints, uint address, uint access) {
+  uint8_t *watch = &watchpoints->watch[address & PDP8_WORD_MASK];
+  if (*watch && !access) watchpoints->count--;
+  if (!*watch && access) watchpoints->count++;
+  *watch = access;
+}
+
+void PDP8_WatchpointSet(struct PDP8_Watchpoints *watchpoints, uint address, uint access) {
+  change(watchpoints, address, watchpoints->watch[address & PDP8_WORD_MASK] | (access & PDP8_WATCH_ACCESS));
+}
+
+void PDP8_WatchpointClear(struct PDP8_Watchpoints *watchpoints, uint address, uint access) {
+  change(watchpoints, address, watchpoints->watch[address & PDP8_WORD_MASK] & ~access);
+}
+
+void PDP8_WatchpointsAttach(struct PDP8 *pdp8, struct PDP8_Watchpoints *watchpoints) {
+  pdp8->watchpoints = watchpoints;
+  pdp8->watch_pages = 0;
+  for (uint address = 0; watchpoints && address < PDP8_MEMORY_SIZE; ++address) {
+    if (watchpoints->watch[address]) pdp8->watch_pages |= 1u << (address / PDP8_WATCH_PAGE_SIZE);
+  }
+}
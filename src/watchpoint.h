@@ -0,0 +1,49 @@
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+#ifndef PDP8_WATCHPOINT_H
+#define PDP8_WATCHPOINT_H
+
+#include "pdp8.h"
+
+#define PDP8_WATCH_PAGE_SIZE 0200      // one bit of pdp8->watch_pages
+
+  enum PDP8_WatchAccess {
+    PDP8_WATCH_READ   = 1,
+    PDP8_WATCH_WRITE  = 2,
+    PDP8_WATCH_ACCESS = PDP8_WATCH_READ | PDP8_WATCH_WRITE,
+  };
+
+  // Data watchpoints. Accesses to pages without one cost a test of
+  // pdp8->watch_pages; only those to watched pages look at the table.
+  // Operand, indirect and auto-index accesses, the interrupt's store of PC
+  // and data breaks through PDP8_MemoryRead/Write are all watched;
+  // instruction fetches are not, breakpoints cover those.
+  struct PDP8_Watchpoints {
+    uint8_t watch[PDP8_MEMORY_SIZE];   //  PDP8_WatchAccess bits per address
+    uint count;                        //  addresses watched
+    uint64_t hits;
+
+    // first hit since the flag was last cleared
+    bool hit;
+    uint address;
+    uint access;                       //  PDP8_WATCH_READ or PDP8_WATCH_WRITE
+    uint old_value;                    //  memory before the access
+    uint value;                        //  read or written
+    uint pc;                           //  instruction that made it
+  };
+
+  extern void PDP8_WatchpointsInit(struct PDP8_Watchpoints *watchpoints);
+  extern void PDP8_WatchpointSet(struct PDP8_Watchpoints *watchpoints, uint address, uint access);
+  extern void PDP8_WatchpointClear(struct PDP8_Watchpoints *watchpoints, uint address, uint access);
+
+  // Also recomputes pdp8->watch_pages: attach again after changing the
+  // table. PDP8_Reset detaches it.
+  extern void PDP8_WatchpointsAttach(struct PDP8 *pdp8, struct PDP8_Watchpoints *watchpoints);
+
+#endif //PDP8_WATCHPOINT_H
+
+#if defined (__cplusplus)
+}
+#endif
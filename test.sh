@@ -0,0 +1,10 @@
+#!/bin/bash
+
+# Runs the checks in test/ that build.sh built, from build/ like the tools.
+cd build || exit 1
+
+status=0
+for test in ./test-*; do
+  "$test" || status=1
+done
+exit $status
@@ -0,0 +1,126 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pdp8.h"
+#include "loader.h"
+#include "symbols.h"
+#include "assembler.h"
+#include "check.h"
+
+#define CORPUS "../program"
+
+// Literals, links to off-page routines, radix changes, TEXT and `.`.
+static const char source[] =
+  "/assembler check\n"
+  "A=5\n"
+  "*200\n"
+  "START,  CLA CLL\n"
+  "        TAD (1234)\n"
+  "        TAD [7]\n"
+  "        JMS SUB\n"
+  "        DECIMAL\n"
+  "        10\n"
+  "        OCTAL\n"
+  "        10\n"
+  "        TEXT /AB/\n"
+  "        JMP FAR\n"
+  "PTR,    A\n"
+  "        JMP .-1\n"
+  "*400\n"
+  "FAR,    HLT\n"
+  "SUB,    0\n"
+  "$START\n";
+
+static const struct PDP8_Deposit expected[] = {
+  { 00200, 07300 }, { 00201, 01377 }, { 00202, 01177 }, { 00203, 04776 },  // CLA CLL, TAD (, TAD [, JMS I link
+  { 00204, 00012 }, { 00205, 00010 }, { 00206, 00102 }, { 00207, 00000 },  // 10 decimal and octal, TEXT /AB/
+  { 00210, 05775 }, { 00211, 00005 }, { 00212, 05211 },                    // JMP I link, A, JMP .-1
+  { 00177, 00007 }, { 00375, 00400 }, { 00376, 00401 }, { 00377, 01234 },  // literal pools, links last in
+  { 00400, 07402 }, { 00401, 00000 },
+};
+
+static void load(struct PDP8 *pdp8, const char *name) {
+  char path[4096];
+  snprintf(path, sizeof(path), "%s/%s", CORPUS, name);
+
+  struct PDP8_Image image;
+  int status = PDP8_ImageFromFile(&image, path);
+  CHECK(status == PDP8_OK);
+  PDP8_Reset(pdp8);
+  PDP8_MemoryReset(pdp8);
+  if (status != PDP8_OK) return;
+  PDP8_LoadImage(pdp8, &image);
+  PDP8_ImageFree(&image);
+}
+
+static void check_source(void) {
+  struct PDP8_Image image;
+  struct PDP8_Symbols symbols;
+  struct PDP8_AssemblerError error;
+  PDP8_SymbolsInit(&symbols);
+  CHECK(PDP8_Assemble(&image, &symbols, source, strlen(source), &error) == PDP8_OK);
+  CHECK(image.start == 00200);
+
+  static struct PDP8 pdp8;
+  PDP8_MemoryReset(&pdp8);
+  PDP8_LoadImage(&pdp8, &image);
+  uint words = 0;
+  for (uint i = 0; i < PDP8_MEMORY_SIZE; ++i) words += pdp8.memory[i] != 0;
+  for (uint i = 0; i < sizeof(expected) / sizeof(expected[0]); ++i) {
+    CHECK(pdp8.memory[expected[i].address] == expected[i].value);
+    words -= expected[i].value != 0;
+  }
+  CHECK(words == 0);
+
+  struct PDP8_Symbol *symbol = PDP8_SymbolsLookup(&symbols, "SUB", 3);
+  CHECK(symbol && symbol->value == 00401 && symbol->type == PDP8_SYMBOL_LABEL);
+  symbol = PDP8_SymbolsLookup(&symbols, "A", 1);
+  CHECK(symbol && symbol->value == 5 && symbol->type == PDP8_SYMBOL_EQUATE);
+  PDP8_SymbolsFree(&symbols);
+  PDP8_ImageFree(&image);
+
+  static const char undefined[] = "*200\nCLA\nTAD NOPE\n";
+  CHECK(PDP8_Assemble(&image, NULL, undefined, strlen(undefined), &error) == PDP8_ERROR_ASSEMBLY);
+  CHECK(error.line == 3);
+}
+
+// The sources assemble to exactly the words of the tapes made from them.
+static void check_tapes(void) {
+  static struct PDP8 a, b;
+  load(&a, "hello_world.pal");
+  load(&b, "hello_world.bin");
+  CHECK(!memcmp(a.memory, b.memory, sizeof(a.memory)));
+  load(&b, "hello_world.rim");
+  CHECK(!memcmp(a.memory, b.memory, sizeof(a.memory)));
+  load(&a, "compare.pal");
+  load(&b, "compare.rim");
+  CHECK(!memcmp(a.memory, b.memory, sizeof(a.memory)));
+}
+
+// The labels a listing's symbol table gives match the assembler's own.
+static void check_listing(void) {
+  struct PDP8_Image image;
+  struct PDP8_Symbols assembled, listed;
+  PDP8_SymbolsInit(&assembled);
+  PDP8_SymbolsInit(&listed);
+  CHECK(PDP8_AssembleFile(&image, &assembled, CORPUS "/hello_world.pal", NULL) == PDP8_OK);
+  CHECK(PDP8_SymbolsFromListing(&listed, CORPUS "/hello_world.lst") == PDP8_OK);
+
+  static const char *const names[] = { "HELLO", "STPTR", "STRNG" };
+  for (uint i = 0; i < 3; ++i) {
+    struct PDP8_Symbol *a = PDP8_SymbolsLookup(&assembled, names[i], strlen(names[i]));
+    struct PDP8_Symbol *b = PDP8_SymbolsLookup(&listed, names[i], strlen(names[i]));
+    CHECK(a && b && a->value == b->value);
+  }
+  PDP8_SymbolsFree(&assembled);
+  PDP8_SymbolsFree(&listed);
+  PDP8_ImageFree(&image);
+}
+
+int main(void) {
+  check_source();
+  check_tapes();
+  check_listing();
+  return check_result("assembler");
+}
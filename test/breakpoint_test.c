@@ -0,0 +1,150 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pdp8.h"
+#include "breakpoint.h"
+#include "check.h"
+
+// CLA CLL, then ten passes of TAD ONE at 0201, ISZ and JMP, then HLT.
+static void start(struct PDP8 *pdp8, uint one) {
+  static const uint code[] = { 07300, 01220, 02221, 05201, 07402 };
+  PDP8_Reset(pdp8);
+  PDP8_MemoryReset(pdp8);
+  memcpy(&pdp8->memory[00200], code, sizeof(code));
+  pdp8->memory[00220] = one;
+  pdp8->memory[00221] = 07766;       // -10
+  pdp8->pc = 00200;
+  pdp8->run = true;
+}
+
+static struct PDP8 pdp8;
+static struct PDP8_Breakpoints breakpoints;
+
+// An unconditional breakpoint stops before each pass, even at the first
+// fetch of a run; a resuming run passes over it once.
+static void check_unconditional(void) {
+  struct PDP8_Breakpoint breakpoint;
+  PDP8_BreakpointsInit(&breakpoints);
+  PDP8_BreakpointInit(&breakpoint, 00201);
+  uint id = PDP8_BreakpointSet(&breakpoints, &breakpoint);
+  CHECK(id != 0 && PDP8_BreakpointFind(&breakpoints, 00201) == id);
+  CHECK(PDP8_BreakpointFind(&breakpoints, 00202) == 0);
+
+  start(&pdp8, 1);
+  uint64_t executed;
+  uint hit;
+  CHECK(PDP8_BreakpointRun(&pdp8, &breakpoints, 1000, false, &executed, &hit) == PDP8_STOP_BREAKPOINT);
+  CHECK(hit == id && executed == 1 && pdp8.pc == 00201);
+  CHECK(PDP8_BreakpointRun(&pdp8, &breakpoints, 1000, false, &executed, &hit) == PDP8_STOP_BREAKPOINT);
+  CHECK(hit == id && executed == 0 && pdp8.pc == 00201);
+  CHECK(PDP8_BreakpointRun(&pdp8, &breakpoints, 1000, true, &executed, &hit) == PDP8_STOP_BREAKPOINT);
+  CHECK(hit == id && executed == 3 && pdp8.ac == 1);
+  CHECK(breakpoints.breakpoints[id - 1].hits == 3);
+
+  // cleared, it lets the program run to its HLT
+  CHECK(PDP8_BreakpointClear(&breakpoints, id));
+  CHECK(!PDP8_BreakpointClear(&breakpoints, id) && !PDP8_BreakpointClear(&breakpoints, 0));
+  CHECK(PDP8_BreakpointRun(&pdp8, &breakpoints, 1000, true, &executed, &hit) == PDP8_STOP_HALT);
+  CHECK(hit == 0 && pdp8.ac == 10 && breakpoints.count == 0);
+
+  // the budget still applies
+  start(&pdp8, 1);
+  CHECK(PDP8_BreakpointRun(&pdp8, &breakpoints, 5, false, &executed, &hit) == PDP8_STOP_BUDGET);
+  CHECK(executed == 5);
+}
+
+// AC under a mask, the link and an ignore count each hold a breakpoint
+// back; hits count every time the conditions held.
+static void check_conditions(void) {
+  struct PDP8_Breakpoint breakpoint;
+  uint64_t executed;
+  uint hit;
+
+  PDP8_BreakpointsInit(&breakpoints);
+  PDP8_BreakpointInit(&breakpoint, 00202);
+  breakpoint.ac_mask = 07777;
+  breakpoint.ac_value = 5;
+  uint ac = PDP8_BreakpointSet(&breakpoints, &breakpoint);
+  start(&pdp8, 1);
+  CHECK(PDP8_BreakpointRun(&pdp8, &breakpoints, 1000, false, &executed, &hit) == PDP8_STOP_BREAKPOINT);
+  CHECK(hit == ac && pdp8.pc == 00202 && pdp8.ac == 5);
+  CHECK(breakpoints.breakpoints[ac - 1].hits == 1);
+
+  // only the low bit: every odd AC
+  PDP8_BreakpointsInit(&breakpoints);
+  breakpoint.ac_mask = 1;
+  breakpoint.ac_value = 1;
+  breakpoint.ignore = 3;
+  uint odd = PDP8_BreakpointSet(&breakpoints, &breakpoint);
+  start(&pdp8, 1);
+  CHECK(PDP8_BreakpointRun(&pdp8, &breakpoints, 1000, false, &executed, &hit) == PDP8_STOP_BREAKPOINT);
+  CHECK(hit == odd && pdp8.ac == 7);
+  CHECK(breakpoints.breakpoints[odd - 1].hits == 4);
+
+  // counting up never sets the link; adding 7777 to 1 carries into it
+  PDP8_BreakpointsInit(&breakpoints);
+  PDP8_BreakpointInit(&breakpoint, 00202);
+  breakpoint.link = 1;
+  uint link = PDP8_BreakpointSet(&breakpoints, &breakpoint);
+  start(&pdp8, 1);
+  CHECK(PDP8_BreakpointRun(&pdp8, &breakpoints, 1000, false, &executed, &hit) == PDP8_STOP_HALT);
+  CHECK(breakpoints.breakpoints[link - 1].hits == 0);
+  start(&pdp8, 07777);
+  pdp8.memory[00221] = 07777;          // one pass
+  pdp8.ac = 1;
+  pdp8.pc = 00201;
+  CHECK(PDP8_BreakpointRun(&pdp8, &breakpoints, 1000, false, &executed, &hit) == PDP8_STOP_BREAKPOINT);
+  CHECK(hit == link && pdp8.link == 1 && pdp8.ac == 0);
+}
+
+// Breakpoints at one address are checked in the order set; each that
+// holds counts a hit, and the first to stop is reported.
+static void check_chain(void) {
+  struct PDP8_Breakpoint breakpoint;
+  uint64_t executed;
+  uint hit;
+
+  PDP8_BreakpointsInit(&breakpoints);
+  PDP8_BreakpointInit(&breakpoint, 00202);
+  breakpoint.ignore = 100;
+  uint first = PDP8_BreakpointSet(&breakpoints, &breakpoint);
+  breakpoint.ignore = 0;
+  breakpoint.link = 1;
+  uint second = PDP8_BreakpointSet(&breakpoints, &breakpoint);
+  breakpoint.link = -1;
+  breakpoint.ac_mask = 07777;
+  breakpoint.ac_value = 3;
+  uint third = PDP8_BreakpointSet(&breakpoints, &breakpoint);
+  CHECK(PDP8_BreakpointFind(&breakpoints, 00202) == first && breakpoints.count == 3);
+
+  start(&pdp8, 1);
+  CHECK(PDP8_BreakpointRun(&pdp8, &breakpoints, 1000, false, &executed, &hit) == PDP8_STOP_BREAKPOINT);
+  CHECK(hit == third && pdp8.ac == 3);
+  CHECK(breakpoints.breakpoints[first - 1].hits == 3);
+  CHECK(breakpoints.breakpoints[second - 1].hits == 0);
+
+  // unlinked from the middle, the rest of the chain still works
+  CHECK(PDP8_BreakpointClear(&breakpoints, second));
+  CHECK(PDP8_BreakpointClear(&breakpoints, first));
+  CHECK(PDP8_BreakpointFind(&breakpoints, 00202) == third);
+  start(&pdp8, 1);
+  CHECK(PDP8_BreakpointRun(&pdp8, &breakpoints, 1000, false, &executed, &hit) == PDP8_STOP_BREAKPOINT);
+  CHECK(hit == third && pdp8.ac == 3);
+
+  // a full table refuses more, and a freed id is reused
+  PDP8_BreakpointsInit(&breakpoints);
+  PDP8_BreakpointInit(&breakpoint, 00300);
+  uint last = 0;
+  for (uint i = 0; i < PDP8_MAX_BREAKPOINTS; ++i) last = PDP8_BreakpointSet(&breakpoints, &breakpoint);
+  CHECK(last == PDP8_MAX_BREAKPOINTS && PDP8_BreakpointSet(&breakpoints, &breakpoint) == 0);
+  CHECK(PDP8_BreakpointClear(&breakpoints, 17));
+  CHECK(PDP8_BreakpointSet(&breakpoints, &breakpoint) == 17);
+}
+
+int main(void) {
+  check_unconditional();
+  check_conditions();
+  check_chain();
+  return check_result("breakpoint");
+}
@@ -0,0 +1,24 @@
+#ifndef PDP8_CHECK_H
+#define PDP8_CHECK_H
+
+#include <stdio.h>
+
+// Checks for the test programs in test/, run from build/ by test.sh: a
+// failed CHECK prints its location and condition, and main returns
+// check_result, which is 1 if any failed.
+static int check_failures;
+
+#define CHECK(condition) \
+  ((condition) ? (void)0 \
+               : (void)(check_failures++, fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition)))
+
+static int check_result(const char *name) {
+  if (check_failures) {
+    printf("%s: %d checks failed\n", name, check_failures);
+    return 1;
+  }
+  printf("%s: ok\n", name);
+  return 0;
+}
+
+#endif //PDP8_CHECK_H
@@ -0,0 +1,72 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pdp8.h"
+#include "loader.h"
+#include "assembler.h"
+#include "check.h"
+
+#define CORPUS "../program"
+#define BUDGET 10000000
+
+struct printed {
+  uint characters;
+  uint other;
+};
+
+static void print(void *context, uint c) {
+  struct printed *printed = (struct printed *)context;
+  if (c == 0301) printed->characters++;
+  else printed->other++;
+}
+
+// Assembles a corpus program and runs it from its start to the HLT;
+// returns the instructions executed.
+static uint64_t run(struct PDP8 *pdp8, const char *name, struct printed *printed) {
+  char path[256];
+  snprintf(path, sizeof(path), "%s/%s", CORPUS, name);
+  struct PDP8_Image image;
+  CHECK(PDP8_AssembleFile(&image, NULL, path, NULL) == PDP8_OK);
+  PDP8_Reset(pdp8);
+  PDP8_MemoryReset(pdp8);
+  PDP8_LoadImage(pdp8, &image);
+  PDP8_StartImage(pdp8, &image);
+  PDP8_ImageFree(&image);
+  pdp8->print = print;
+  pdp8->print_context = printed;
+  uint64_t executed;
+  CHECK(PDP8_RunFor(pdp8, BUDGET, &executed) == PDP8_STOP_HALT);
+  return executed;
+}
+
+// Each workload halts with the result its header describes.
+static void check_workloads(void) {
+  static struct PDP8 pdp8;
+  struct printed printed = { 0, 0 };
+
+  run(&pdp8, "sieve.pal", &printed);
+  CHECK(pdp8.ac == 0254);
+
+  uint sum = 0;
+  for (uint count = 07000; count < 010000; ++count) sum += count * (count + 0123);
+  run(&pdp8, "multiply.pal", &printed);
+  CHECK(pdp8.ac == (sum & PDP8_WORD_MASK));
+
+  run(&pdp8, "memcpy.pal", &printed);
+  for (uint i = 0; i < 02000; ++i) {
+    CHECK(pdp8.memory[02000 + i] == 06000 + i && pdp8.memory[04000 + i] == 06000 + i);
+  }
+  CHECK(printed.characters == 0 && printed.other == 0);
+
+  // a NUL to start, then an A from each interrupt but the last; the main
+  // loop's eight spins run before each of the 4096 interrupts
+  CHECK(run(&pdp8, "interrupt.pal", &printed) == 114687);
+  CHECK(printed.other == 1 && printed.characters == 4095);
+  CHECK(!pdp8.interrupt_enable);
+}
+
+int main(void) {
+  check_workloads();
+  return check_result("corpus");
+}
@@ -0,0 +1,99 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "pdp8.h"
+#include "disassembler.h"
+#include "check.h"
+
+struct line {
+  uint word;
+  uint address;
+  const char *text;
+};
+
+static const struct line lines[] = {
+  // memory reference: page zero, current page, indirect
+  { 01070, 00200, "TAD 0070" },
+  { 01377, 00200, "TAD 0377" },
+  { 05777, 00400, "JMP I 0577" },
+  { 03410, 07600, "DCA I 0010" },
+  { 04200, 07777, "JMS 7600" },
+
+  // IOTs by name, SKON over the generic IOT, unknown ones in octal
+  { 06000, 0, "SKON" },
+  { 06001, 0, "ION" },
+  { 06031, 0, "KSF" },
+  { 06046, 0, "TLS" },
+  { 06771, 0, "6771" },
+
+  // group 1 and its combined mnemonics
+  { 07000, 0, "NOP" },
+  { 07300, 0, "CLA CLL" },
+  { 07041, 0, "CIA" },
+  { 07240, 0, "STA" },
+  { 07120, 0, "STL" },
+  { 07241, 0, "STA IAC" },
+  { 07110, 0, "CLL RAR" },
+  { 07006, 0, "RTL" },
+  { 07012, 0, "RTR" },
+  { 07002, 0, "BSW" },
+
+  // group 2: OR group, AND group, SKP, LAS
+  { 07402, 0, "HLT" },
+  { 07500, 0, "SMA" },
+  { 07540, 0, "SMA SZA" },
+  { 07560, 0, "SMA SZA SNL" },
+  { 07410, 0, "SKP" },
+  { 07550, 0, "SPA SNA" },
+  { 07430, 0, "SZL" },
+  { 07640, 0, "SZA CLA" },
+  { 07604, 0, "LAS" },
+  { 07406, 0, "OSR HLT" },
+  { 07400, 0, "NOP" },
+
+  // group 3: MQ transfers, the combinations with CLA, EAE in octal
+  { 07401, 0, "NOP" },
+  { 07601, 0, "CLA" },
+  { 07421, 0, "MQL" },
+  { 07501, 0, "MQA" },
+  { 07521, 0, "SWP" },
+  { 07621, 0, "CAM" },
+  { 07701, 0, "ACL" },
+  { 07721, 0, "CLA SWP" },
+  { 07405, 0, "7405" },
+};
+
+static void check_lines(void) {
+  char text[PDP8_DISASSEMBLY_LENGTH];
+  for (uint i = 0; i < sizeof(lines) / sizeof(lines[0]); ++i) {
+    uint length = PDP8_Disassemble(lines[i].word, lines[i].address, NULL, text);
+    if (strcmp(text, lines[i].text)) fprintf(stderr, "%04o: \"%s\", expected \"%s\"\n", lines[i].word, text, lines[i].text);
+    CHECK(!strcmp(text, lines[i].text));
+    CHECK(length == strlen(text));
+  }
+  CHECK(!strcmp(PDP8_MnemonicText(01000), "TAD "));
+  CHECK(!strcmp(PDP8_MnemonicText(05400), "JMP I "));
+}
+
+// Named targets print symbolically, across a range of memory.
+static void check_range(void) {
+  static uint memory[PDP8_MEMORY_SIZE];
+  static const char *names[PDP8_MEMORY_SIZE];
+  names[00205] = "LOOP";
+  names[00020] = "COUNT";
+  memory[00206] = 02020;
+  memory[00207] = 05205;
+  memory[00210] = 07402;
+
+  char range[3][PDP8_DISASSEMBLY_LENGTH];
+  PDP8_DisassembleRange(memory, 00206, 3, names, range);
+  CHECK(!strcmp(range[0], "ISZ COUNT"));
+  CHECK(!strcmp(range[1], "JMP LOOP"));
+  CHECK(!strcmp(range[2], "HLT"));
+}
+
+int main(void) {
+  check_lines();
+  check_range();
+  return check_result("disassembler");
+}
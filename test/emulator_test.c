@@ -0,0 +1,181 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "pdp8.h"
+#include "loader.h"
+#include "assembler.h"
+#include "emulator.h"
+#include "check.h"
+
+// Ten passes of IAC, ISZ and JMP, then HLT with AC 10: 31 instructions.
+static const char source[] =
+  "*20\n"
+  "CNT,    7766\n"
+  "*200\n"
+  "START,  CLA\n"
+  "LOOP,   IAC\n"
+  "        ISZ CNT\n"
+  "        JMP LOOP\n"
+  "        HLT\n"
+  "$START\n";
+
+#define LOOP 00201
+
+enum { INSTRUCTIONS, RUNNING, HALTED, BREAKPOINTS };
+
+// Reads the view until what it shows of item is value, for up to five
+// seconds.
+static bool wait_for(struct PDP8_Emulator *emulator, struct PDP8_EmulatorView *view, uint item, uint64_t value) {
+  for (uint i = 0; i < 5000; ++i) {
+    PDP8_EmulatorRead(emulator, view);
+    uint64_t shown = 0;
+    switch (item) {
+      case INSTRUCTIONS: shown = view->instructions; break;
+      case RUNNING: shown = view->running; break;
+      case HALTED: shown = !view->pdp8.run; break;
+      case BREAKPOINTS: shown = view->breakpoints; break;
+    }
+    if (shown == value) return true;
+    struct timespec pause = { 0, 1000000 };
+    nanosleep(&pause, NULL);
+  }
+  return false;
+}
+
+// Commands sent from this thread are carried out in order on the
+// emulator's, and each shows in the view.
+static void check_commands(const struct PDP8_Image *image) {
+  static struct PDP8_Emulator emulator;
+  struct PDP8_EmulatorView view;
+  PDP8_EmulatorInit(&emulator, image, 01234);
+  CHECK(PDP8_EmulatorStart(&emulator) == PDP8_OK);
+  PDP8_EmulatorRead(&emulator, &view);
+  CHECK(view.instructions == 0 && view.pdp8.pc == 00200 && view.pdp8.switches == 01234 && !view.running);
+
+  CHECK(PDP8_EmulatorCommand(&emulator, PDP8_COMMAND_STEP, 0));
+  CHECK(PDP8_EmulatorCommand(&emulator, PDP8_COMMAND_STEP, 0));
+  CHECK(wait_for(&emulator, &view, INSTRUCTIONS, 2) && view.pdp8.pc == 00202 && view.pdp8.ac == 1);
+  CHECK(PDP8_EmulatorCommand(&emulator, PDP8_COMMAND_BACK, 0));
+  CHECK(wait_for(&emulator, &view, INSTRUCTIONS, 1) && view.pdp8.pc == LOOP && view.pdp8.ac == 0);
+
+  // a run resumes past the breakpoint at PC and stops there next pass
+  CHECK(PDP8_EmulatorCommand(&emulator, PDP8_COMMAND_BREAKPOINT, 0));
+  CHECK(wait_for(&emulator, &view, BREAKPOINTS, 1));
+  CHECK(PDP8_EmulatorCommand(&emulator, PDP8_COMMAND_RUN, 0));
+  CHECK(wait_for(&emulator, &view, INSTRUCTIONS, 4) && !view.running);
+  CHECK(view.pdp8.pc == LOOP && view.pdp8.ac == 1);
+
+  // reverse goes back to the pass before
+  CHECK(PDP8_EmulatorCommand(&emulator, PDP8_COMMAND_REVERSE, 0));
+  CHECK(wait_for(&emulator, &view, INSTRUCTIONS, 1) && view.pdp8.pc == LOOP);
+
+  CHECK(PDP8_EmulatorCommand(&emulator, PDP8_COMMAND_BREAKPOINT, 0));
+  CHECK(wait_for(&emulator, &view, BREAKPOINTS, 0));
+  CHECK(PDP8_EmulatorCommand(&emulator, PDP8_COMMAND_RUN, 0));
+  CHECK(wait_for(&emulator, &view, HALTED, 1) && !view.running);
+  CHECK(view.instructions == 31 && view.pdp8.ac == 10);
+
+  CHECK(PDP8_EmulatorCommand(&emulator, PDP8_COMMAND_RESET, 0));
+  CHECK(wait_for(&emulator, &view, HALTED, 0));
+  CHECK(view.instructions == 0 && view.pdp8.pc == 00200 && view.pdp8.ac == 0);
+  PDP8_EmulatorStop(&emulator);
+}
+
+static void pause_ms(uint ms) {
+  struct timespec pause = { ms / 1000, (long)(ms % 1000) * 1000000 };
+  nanosleep(&pause, NULL);
+}
+
+// Runs from a stop for ms and returns the view, stopped again.
+static void run_for(struct PDP8_Emulator *emulator, struct PDP8_EmulatorView *view, uint ms) {
+  PDP8_EmulatorRead(emulator, view);
+  uint64_t from = view->instructions;
+  CHECK(PDP8_EmulatorCommand(emulator, PDP8_COMMAND_RUN, 0));
+  pause_ms(ms);
+  PDP8_EmulatorRead(emulator, view);
+  CHECK(view->running);
+  CHECK(PDP8_EmulatorCommand(emulator, PDP8_COMMAND_STOP, 0));
+  CHECK(wait_for(emulator, view, RUNNING, 0));
+  view->instructions -= from;
+}
+
+// A throttled run keeps to its rate, in instructions or in memory cycles,
+// and an unthrottled one goes as fast as it can; loose bounds leave room
+// for a busy host.
+static void check_speed(void) {
+  static const char forever[] = "*200\nSTART,  JMP START\n$START\n";
+  struct PDP8_Image image;
+  struct PDP8_AssemblerError error;
+  CHECK(PDP8_Assemble(&image, NULL, forever, strlen(forever), &error) == PDP8_OK);
+
+  static struct PDP8_Emulator emulator;
+  struct PDP8_EmulatorView view;
+  PDP8_EmulatorInit(&emulator, &image, 0);
+  CHECK(PDP8_EmulatorStart(&emulator) == PDP8_OK);
+
+  CHECK(PDP8_EmulatorCommand(&emulator, PDP8_COMMAND_SPEED, 20000));
+  run_for(&emulator, &view, 500);
+  CHECK(view.throttle == PDP8_THROTTLE_INSTRUCTIONS && view.rate == 20000);
+  CHECK(view.instructions > 2500 && view.instructions < 15000);
+  CHECK(view.mips == 0);
+
+  // JMP takes one cycle
+  uint64_t cycles = view.pdp8.cycles;
+  CHECK(PDP8_EmulatorCommand(&emulator, PDP8_COMMAND_REAL_TIME, 0));
+  run_for(&emulator, &view, 300);
+  CHECK(view.throttle == PDP8_THROTTLE_CYCLES && view.rate == 1000000000 / PDP8_EMULATOR_CYCLE_NS);
+  cycles = view.pdp8.cycles - cycles;
+  CHECK(cycles > 25000 && cycles < 300000 && view.instructions == cycles);
+
+  CHECK(PDP8_EmulatorCommand(&emulator, PDP8_COMMAND_SPEED, 0));
+  CHECK(PDP8_EmulatorCommand(&emulator, PDP8_COMMAND_RUN, 0));
+  pause_ms(600);
+  PDP8_EmulatorRead(&emulator, &view);
+  CHECK(view.throttle == PDP8_THROTTLE_NONE && view.running && view.mips > 1);
+  CHECK(PDP8_EmulatorCommand(&emulator, PDP8_COMMAND_STOP, 0));
+  CHECK(wait_for(&emulator, &view, RUNNING, 0) && view.mips == 0);
+
+  PDP8_EmulatorStop(&emulator);
+  PDP8_ImageFree(&image);
+}
+
+// Wait returns once the view shows every command sent; a seek moves both
+// ways through the history.
+static void check_seek(const struct PDP8_Image *image) {
+  static struct PDP8_Emulator emulator;
+  struct PDP8_EmulatorView view;
+  PDP8_EmulatorInit(&emulator, image, 0);
+  CHECK(PDP8_EmulatorStart(&emulator) == PDP8_OK);
+
+  CHECK(PDP8_EmulatorCommand(&emulator, PDP8_COMMAND_SEEK, 31));
+  PDP8_EmulatorWait(&emulator, &view);
+  CHECK(view.commands == 1 && view.instructions == 31 && !view.pdp8.run && view.pdp8.ac == 10);
+  CHECK(PDP8_EmulatorCommand(&emulator, PDP8_COMMAND_SEEK, 2));
+  CHECK(PDP8_EmulatorCommand(&emulator, PDP8_COMMAND_STEP, 0));
+  PDP8_EmulatorWait(&emulator, &view);
+  CHECK(view.commands == 3 && view.instructions == 3 && view.pdp8.pc == 00203 && view.pdp8.ac == 1);
+
+  PDP8_EmulatorStop(&emulator);
+}
+
+// A full queue drops the command.
+static void check_queue(const struct PDP8_Image *image) {
+  static struct PDP8_Emulator emulator;
+  PDP8_EmulatorInit(&emulator, image, 0);
+  for (uint i = 0; i < PDP8_EMULATOR_COMMANDS; ++i) CHECK(PDP8_EmulatorCommand(&emulator, PDP8_COMMAND_STEP, 0));
+  CHECK(!PDP8_EmulatorCommand(&emulator, PDP8_COMMAND_STEP, 0));
+}
+
+int main(void) {
+  struct PDP8_Image image;
+  struct PDP8_AssemblerError error;
+  CHECK(PDP8_Assemble(&image, NULL, source, strlen(source), &error) == PDP8_OK);
+  check_commands(&image);
+  check_seek(&image);
+  check_queue(&image);
+  check_speed();
+  PDP8_ImageFree(&image);
+  return check_result("emulator");
+}
@@ -0,0 +1,195 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "pdp8.h"
+#include "gdbstub.h"
+#include "check.h"
+
+static struct PDP8 pdp8;
+static struct PDP8_GdbStub stub;
+
+// IAC, DCA 0300, JMP 0200: counts into 0300 forever.
+static void start(void) {
+  static const uint code[] = { 07001, 03300, 05200 };
+  PDP8_Reset(&pdp8);
+  PDP8_MemoryReset(&pdp8);
+  memcpy(&pdp8.memory[00200], code, sizeof(code));
+  pdp8.pc = 00200;
+  PDP8_GdbInit(&stub, &pdp8);
+}
+
+struct Session {
+  pthread_t thread;
+  int fd;                              //  the debugger's end
+  int stub_fd;
+  int end;
+};
+
+static void *serve(void *context) {
+  struct Session *session = (struct Session *)context;
+  session->end = PDP8_GdbServe(&stub, session->stub_fd);
+  return NULL;
+}
+
+static void connect_stub(struct Session *session) {
+  int fds[2];
+  CHECK(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+  session->fd = fds[0];
+  session->stub_fd = fds[1];
+  pthread_create(&session->thread, NULL, serve, session);
+}
+
+static int disconnect(struct Session *session) {
+  pthread_join(session->thread, NULL);
+  close(session->fd);
+  return session->end;
+}
+
+static void send_text(int fd, const char *text) {
+  CHECK(write(fd, text, strlen(text)) == (ssize_t)strlen(text));
+}
+
+static void send_packet(int fd, const char *payload) {
+  uint8_t sum = 0;
+  for (const char *p = payload; *p; ++p) sum += *p;
+  char packet[256];
+  snprintf(packet, sizeof(packet), "$%s#%02x", payload, sum);
+  send_text(fd, packet);
+}
+
+static char next(int fd) {
+  char c = 0;
+  CHECK(read(fd, &c, 1) == 1);
+  return c;
+}
+
+// Reads one reply, checking its checksum, into payload.
+static void receive(int fd, char *payload, size_t size) {
+  while (next(fd) != '$') {}
+  size_t length = 0;
+  uint8_t sum = 0;
+  for (char c; (c = next(fd)) != '#';) {
+    sum += c;
+    if (length + 1 < size) payload[length++] = c;
+  }
+  payload[length] = '\0';
+  char checksum[3] = { next(fd), next(fd), 0 };
+  CHECK(strtoul(checksum, NULL, 16) == sum);
+}
+
+// Sends a packet, expects it acknowledged and returns the reply.
+static const char *command(int fd, const char *payload) {
+  static char reply[1024];
+  send_packet(fd, payload);
+  CHECK(next(fd) == '+');
+  receive(fd, reply, sizeof(reply));
+  return reply;
+}
+
+// Registers, memory, breakpoints, watchpoints, stepping and an interrupt,
+// all over one connection, then a detach.
+static void check_session(void) {
+  struct Session session;
+  start();
+  connect_stub(&session);
+  int fd = session.fd;
+
+  CHECK(!strncmp(command(fd, "qSupported:swbreak+"), "PacketSize=8000;", 16));
+  CHECK(!strcmp(command(fd, "?"), "S05"));
+  CHECK(!strncmp(command(fd, "g"), "800000000000", 12));    // PC 0200, AC 0, L 0
+  CHECK(!strcmp(command(fd, "p1"), "0000"));
+  CHECK(!strcmp(command(fd, "pa"), "E01"));
+
+  // word 0200 is at byte 0x100, little endian: IAC is 0e01
+  CHECK(!strcmp(command(fd, "m100,6"), "010ec006800a"));
+  CHECK(!strcmp(command(fd, "m101,2"), "E01"));
+  CHECK(!strcmp(command(fd, "M182,4:34120100"), "OK"));
+  CHECK(pdp8.memory[00301] == 01064 && pdp8.memory[00302] == 1);
+  CHECK(!strcmp(command(fd, "P1=2307"), "OK") && pdp8.ac == 03443);
+  CHECK(!strcmp(command(fd, "P1=0000"), "OK"));
+
+  // a breakpoint at JMP stops there with AC stored
+  CHECK(!strcmp(command(fd, "Z0,104,2"), "OK"));
+  CHECK(!strcmp(command(fd, "c"), "T05swbreak:;"));
+  CHECK(pdp8.pc == 00202 && pdp8.memory[00300] == 1);
+  CHECK(!strcmp(command(fd, "s"), "T05") && pdp8.pc == 00200);
+  CHECK(!strcmp(command(fd, "z0,104,2"), "OK"));
+  CHECK(!strcmp(command(fd, "z0,104,2"), "E01"));
+
+  // a write watchpoint stops after the DCA that stores 2
+  CHECK(!strcmp(command(fd, "Z2,180,2"), "OK"));
+  CHECK(!strcmp(command(fd, "P1=0100"), "OK"));
+  CHECK(!strcmp(command(fd, "c"), "T05watch:180;"));
+  CHECK(pdp8.pc == 00202 && !strcmp(command(fd, "m180,2"), "0200"));
+  CHECK(!strcmp(command(fd, "z2,180,2"), "OK"));
+
+  // a breakpoint set at PC stops before anything runs, and the next
+  // continue passes over it once
+  CHECK(!strcmp(command(fd, "Z0,104,2"), "OK"));
+  CHECK(!strcmp(command(fd, "c"), "T05swbreak:;"));
+  CHECK(pdp8.pc == 00202 && pdp8.memory[00300] == 2);
+  CHECK(!strcmp(command(fd, "c"), "T05swbreak:;"));
+  CHECK(pdp8.pc == 00202 && pdp8.memory[00300] == 1);
+  CHECK(!strcmp(command(fd, "z0,104,2"), "OK"));
+
+  // with nothing set it runs until interrupted
+  send_packet(fd, "c");
+  CHECK(next(fd) == '+');
+  send_text(fd, "\x03");
+  static char reply[64];
+  receive(fd, reply, sizeof(reply));
+  CHECK(!strcmp(reply, "T02"));
+
+  // a bad checksum is refused, and a NAK resends the last reply
+  send_text(fd, "$g#00");
+  CHECK(next(fd) == '-');
+  CHECK(!strcmp(command(fd, "pa"), "E01"));
+  send_text(fd, "-");
+  receive(fd, reply, sizeof(reply));
+  CHECK(!strcmp(reply, "E01"));
+
+  // a run of NAKs after the longest reply has each answered in full
+  static char dump[PDP8_GDB_PACKET_SIZE];
+  send_packet(fd, "m0,2000");
+  CHECK(next(fd) == '+');
+  receive(fd, dump, sizeof(dump));
+  size_t length = strlen(dump);
+  CHECK(length > 4 * 1024 && length < PDP8_GDB_PACKET_SIZE);
+  send_text(fd, "------------");
+  for (uint i = 0; i < 12; ++i) {
+    receive(fd, dump, sizeof(dump));
+    CHECK(strlen(dump) == length);
+  }
+
+  CHECK(!strcmp(command(fd, "D"), "OK"));
+  CHECK(disconnect(&session) == PDP8_GDB_DETACHED);
+}
+
+// No-ack mode drops the acknowledgements; k ends the emulator, and a
+// hang-up counts as a detach.
+static void check_endings(void) {
+  struct Session session;
+  start();
+  connect_stub(&session);
+  CHECK(!strcmp(command(session.fd, "QStartNoAckMode"), "OK"));
+  static char reply[64];
+  send_packet(session.fd, "?");
+  receive(session.fd, reply, sizeof(reply));
+  CHECK(!strcmp(reply, "S05"));
+  send_packet(session.fd, "k");
+  CHECK(disconnect(&session) == PDP8_GDB_KILLED);
+
+  connect_stub(&session);
+  shutdown(session.fd, SHUT_WR);
+  CHECK(disconnect(&session) == PDP8_GDB_DETACHED);
+}
+
+int main(void) {
+  check_session();
+  check_endings();
+  return check_result("gdbstub");
+}
@@ -0,0 +1,132 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pdp8.h"
+#include "loader.h"
+#include "assembler.h"
+#include "replay.h"
+#include "history.h"
+#include "check.h"
+
+// Long enough for the archive to thin out.
+#define INSTRUCTIONS 10000000
+
+// Counts forever, storing each character that arrives.
+static const char source[] =
+  "*20\n"
+  "CNT,    0\n"
+  "CHAR,   0\n"
+  "*200\n"
+  "START,  KSF\n"
+  "        JMP TICK\n"
+  "READ,   KRB\n"
+  "        DCA CHAR\n"
+  "TICK,   ISZ CNT\n"
+  "        JMP START\n"
+  "        JMP START\n"
+  "$START\n";
+
+#define READ 00202
+
+// Characters typed after that many instructions.
+static const struct {
+  uint64_t instructions;
+  uint c;
+} typed[] = {
+  { 5000, 'A' }, { 1000000, 'B' }, { 4500000, 'C' },
+};
+
+#define TYPED (sizeof(typed) / sizeof(typed[0]))
+
+// Positions checked, with the reference machine's state hash there, taken
+// before any character typed at that point.
+static struct {
+  uint64_t instructions;
+  uint64_t hash;
+} positions[] = {
+  { 0 }, { 1 }, { 4999 }, { 5000 }, { 5003 }, { 65536 }, { 1048579 },
+  { 4194304 }, { 4500001 }, { 8388613 }, { INSTRUCTIONS - 1 }, { INSTRUCTIONS },
+};
+
+#define POSITIONS (sizeof(positions) / sizeof(positions[0]))
+
+// Where the reference machine was about to execute each KRB.
+static uint64_t reads[TYPED];
+
+static void start(struct PDP8 *pdp8, const struct PDP8_Image *image) {
+  PDP8_Reset(pdp8);
+  PDP8_MemoryReset(pdp8);
+  PDP8_LoadImage(pdp8, image);
+  PDP8_StartImage(pdp8, image);
+}
+
+// Runs the reference machine one instruction at a time.
+static void expect(const struct PDP8_Image *image) {
+  static struct PDP8 pdp8;
+  start(&pdp8, image);
+  uint t = 0, p = 0, r = 0;
+  for (uint64_t i = 0; i <= INSTRUCTIONS; ++i) {
+    if (p < POSITIONS && positions[p].instructions == i) positions[p++].hash = PDP8_StateHash(&pdp8);
+    if (t < TYPED && typed[t].instructions == i) PDP8_KeyboardInput(&pdp8, typed[t++].c);
+    if (pdp8.pc == READ) reads[r++] = i;
+    PDP8_Step(&pdp8);
+  }
+  CHECK(t == TYPED && p == POSITIONS && r == TYPED);
+}
+
+// Records the run with the same input at the same points.
+static void record(struct PDP8_History *history, struct PDP8 *pdp8) {
+  uint64_t at = 0, executed;
+  for (uint t = 0; t < TYPED; ++t) {
+    PDP8_HistoryRun(history, pdp8, typed[t].instructions - at, &executed);
+    at += executed;
+    CHECK(PDP8_HistoryInput(history, pdp8, PDP8_INPUT_KEYBOARD, typed[t].c) == PDP8_OK);
+  }
+  PDP8_HistoryRun(history, pdp8, INSTRUCTIONS - at, &executed);
+  CHECK(at + executed == INSTRUCTIONS && history->instructions == INSTRUCTIONS);
+}
+
+static bool at_read(const struct PDP8 *pdp8, void *context) {
+  (void)context;
+  return pdp8->pc == READ;
+}
+
+int main(void) {
+  struct PDP8_Image image;
+  struct PDP8_AssemblerError error;
+  CHECK(PDP8_Assemble(&image, NULL, source, strlen(source), &error) == PDP8_OK);
+  expect(&image);
+
+  static struct PDP8 pdp8;
+  static struct PDP8_History history;
+  start(&pdp8, &image);
+  CHECK(PDP8_HistoryInit(&history, &pdp8) == PDP8_OK);
+  record(&history, &pdp8);
+  CHECK(history.archive_count <= PDP8_HISTORY_ARCHIVE && history.archive_interval > PDP8_HISTORY_INTERVAL);
+
+  // seeking back re-executes from a snapshot and replays the input;
+  // seeking forward again replays the rest
+  for (uint i = POSITIONS; i-- > 0;) {
+    CHECK(PDP8_HistorySeek(&history, &pdp8, positions[i].instructions) == positions[i].instructions);
+    CHECK(PDP8_StateHash(&pdp8) == positions[i].hash);
+  }
+  for (uint i = 0; i < POSITIONS; ++i) {
+    CHECK(PDP8_HistorySeek(&history, &pdp8, positions[i].instructions) == positions[i].instructions);
+    CHECK(PDP8_StateHash(&pdp8) == positions[i].hash);
+  }
+  CHECK(PDP8_HistoryBack(&history, &pdp8, 1) == INSTRUCTIONS - 1);
+  CHECK(PDP8_StateHash(&pdp8) == positions[POSITIONS - 2].hash);
+
+  // reverse continue stops before each KRB in turn, newest first, then at 0
+  for (uint r = TYPED; r-- > 0;) {
+    CHECK(PDP8_HistoryReverse(&history, &pdp8, at_read, NULL));
+    CHECK(history.instructions == reads[r] && pdp8.pc == READ);
+  }
+  CHECK(!PDP8_HistoryReverse(&history, &pdp8, at_read, NULL));
+  CHECK(history.instructions == 0 && PDP8_StateHash(&pdp8) == positions[0].hash);
+
+  PDP8_HistoryFree(&history);
+  PDP8_ImageFree(&image);
+  return check_result("history");
+}
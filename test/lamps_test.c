@@ -0,0 +1,95 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pdp8.h"
+#include "loader.h"
+#include "assembler.h"
+#include "lamps.h"
+#include "corpus.h"
+#include "check.h"
+
+#define INSTRUCTIONS 5000              // not a whole number of batches
+
+static uint64_t state = 0x9E3779B97F4A7C15;
+
+static uint64_t random_word(void) {
+  state ^= state << 13;
+  state ^= state >> 7;
+  state ^= state << 17;
+  return state;
+}
+
+// The adder tree counts each bit position as a loop over the words would,
+// whatever the bits and however many blocks.
+static void check_count_bits(void) {
+  static uint64_t words[PDP8_LAMP_BATCH];
+  static const uint counts[] = { 16, 32, 1008, PDP8_LAMP_BATCH };
+  for (uint c = 0; c < 4; ++c) {
+    for (uint pattern = 0; pattern < 3; ++pattern) {
+      for (uint i = 0; i < counts[c]; ++i) {
+        words[i] = pattern == 0 ? random_word() : pattern == 1 ? ~0ull : random_word() & random_word();
+      }
+      uint64_t totals[64] = { 0 }, expected[64] = { 0 };
+      PDP8_LampsCountBits(totals, words, counts[c]);
+      for (uint i = 0; i < counts[c]; ++i) {
+        for (uint b = 0; b < 64; ++b) expected[b] += (words[i] >> b) & 1;
+      }
+      CHECK(!memcmp(totals, expected, sizeof(totals)));
+    }
+  }
+}
+
+static void count_register(uint64_t *totals, uint lamp, uint value, uint bits) {
+  for (uint b = 0; b < bits; ++b) totals[lamp + b] += (value >> b) & 1;
+}
+
+// Lamps attached to a running machine total what each instruction left
+// in the registers, the partly filled last batch included.
+static void check_run(void) {
+  char path[256];
+  snprintf(path, sizeof(path), "%s/%s", PDP8_CORPUS_DIRECTORY, "sieve.pal");
+  struct PDP8_Image image;
+  CHECK(PDP8_AssembleFile(&image, NULL, path, NULL) == PDP8_OK);
+
+  static struct PDP8 pdp8;
+  static struct PDP8_Lamps lamps;
+  PDP8_Reset(&pdp8);
+  PDP8_MemoryReset(&pdp8);
+  PDP8_LoadImage(&pdp8, &image);
+  PDP8_StartImage(&pdp8, &image);
+  PDP8_ImageFree(&image);
+  PDP8_LampsReset(&lamps);
+  PDP8_LampsAttach(&pdp8, &lamps);
+
+  uint64_t expected[PDP8_LAMP_COUNT] = { 0 };
+  for (uint i = 0; i < INSTRUCTIONS; ++i) {
+    PDP8_Step(&pdp8);
+    uint opcode = pdp8.ir >> 9;
+    count_register(expected, PDP8_LAMP_MA, pdp8.ma, 12);
+    count_register(expected, PDP8_LAMP_MB, pdp8.mb, 12);
+    count_register(expected, PDP8_LAMP_AC, pdp8.ac, 12);
+    count_register(expected, PDP8_LAMP_MQ, pdp8.mq, 12);
+    count_register(expected, PDP8_LAMP_PC, pdp8.pc, 12);
+    expected[PDP8_LAMP_LINK] += pdp8.link;
+    expected[PDP8_LAMP_ION] += pdp8.interrupt_enable;
+    expected[PDP8_LAMP_IR + opcode]++;
+    expected[PDP8_LAMP_FETCH]++;
+    expected[PDP8_LAMP_DEFER] += opcode < 6 && (pdp8.ir & 0400);
+    expected[PDP8_LAMP_EXECUTE] += opcode < 5;
+  }
+  CHECK(pdp8.run && lamps.pending == INSTRUCTIONS % PDP8_LAMP_BATCH);
+  PDP8_LampsFlush(&lamps);
+  CHECK(lamps.instructions == INSTRUCTIONS && lamps.pending == 0);
+  CHECK(!memcmp(lamps.totals, expected, sizeof(expected)));
+  CHECK(lamps.totals[PDP8_LAMP_DEFER] > 0 && lamps.totals[PDP8_LAMP_EXECUTE] < INSTRUCTIONS);
+
+  PDP8_Reset(&pdp8);
+  CHECK(pdp8.lamps == NULL);
+}
+
+int main(void) {
+  check_count_bits();
+  check_run();
+  return check_result("lamps");
+}
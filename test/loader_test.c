@@ -0,0 +1,191 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "pdp8.h"
+#include "loader.h"
+#include "symbols.h"
+#include "check.h"
+
+#define CORPUS "../program"
+
+// Writes bytes to a new temporary file and returns its name in file_name.
+static void write_file(char *file_name, const void *bytes, size_t length) {
+  strcpy(file_name, "/tmp/pdp8-loader-XXXXXX");
+  int fd = mkstemp(file_name);
+  CHECK(fd >= 0 && write(fd, bytes, length) == (ssize_t)length);
+  close(fd);
+}
+
+// Loads an image over memory filled with 07777, so untouched words show.
+static void load(struct PDP8 *pdp8, const struct PDP8_Image *image) {
+  for (uint i = 0; i < PDP8_MEMORY_SIZE; ++i) pdp8->memory[i] = 07777;
+  PDP8_LoadImage(pdp8, image);
+}
+
+// A BIN tape of two segments between leader and trailer, with a field
+// frame that is left out of the checksum.
+static const unsigned char tape[] = {
+  0200, 0200,
+  0102, 0000, 0000, 0001, 0000, 0002,  // *200 0001 0002
+  0300,                                // field 0
+  0104, 0000, 0077, 0076,              // *400 7776
+  0004, 0006,                          // checksum 0406
+  0200, 0200,
+};
+
+static void check_binary(void) {
+  char file_name[64];
+  write_file(file_name, tape, sizeof(tape));
+
+  struct PDP8_Image image;
+  CHECK(PDP8_ImageFromBinary(&image, file_name) == PDP8_OK);
+  CHECK(image.segment_count == 2 && image.start == PDP8_NO_START);
+  CHECK(image.segments[0].origin == 00200 && image.segments[0].length == 2);
+  CHECK(image.segments[1].origin == 00400 && image.segments[1].length == 1);
+
+  // only the populated ranges are written
+  static struct PDP8 a, b;
+  load(&a, &image);
+  CHECK(a.memory[00177] == 07777 && a.memory[00200] == 1 && a.memory[00201] == 2 && a.memory[00202] == 07777);
+  CHECK(a.memory[00400] == 07776 && a.memory[00401] == 07777);
+  for (uint i = 0; i < PDP8_MEMORY_SIZE; ++i) b.memory[i] = 07777;
+  CHECK(PDP8_LoadBinary(&b, file_name) == PDP8_OK);
+  CHECK(!memcmp(a.memory, b.memory, sizeof(a.memory)));
+  PDP8_ImageFree(&image);
+  CHECK(image.segments == NULL && image.code == NULL);
+
+  // a flipped data bit fails the checksum, a missing checksum the format
+  unsigned char bad[sizeof(tape)];
+  memcpy(bad, tape, sizeof(tape));
+  bad[5] ^= 1;
+  write_file(file_name, bad, sizeof(bad));
+  CHECK(PDP8_ImageFromBinary(&image, file_name) == PDP8_ERROR_CHECKSUM);
+  CHECK(PDP8_ImageFromBinary(&image, "/nonexistent/image.bin") == PDP8_ERROR_OPEN);
+  static const unsigned char leader[] = { 0200, 0200, 0200 };
+  write_file(file_name, leader, sizeof(leader));
+  CHECK(PDP8_ImageFromBinary(&image, file_name) == PDP8_ERROR_FORMAT);
+  unlink(file_name);
+}
+
+static void check_rim(void) {
+  static const unsigned char rim[] = { 0200, 0102, 0000, 0073, 0000, 0102, 0001, 0000, 0001, 0200 };
+  char file_name[64];
+  write_file(file_name, rim, sizeof(rim));
+
+  struct PDP8_Image image;
+  static struct PDP8 pdp8;
+  CHECK(PDP8_ImageFromRim(&image, file_name) == PDP8_OK);
+  load(&pdp8, &image);
+  CHECK(pdp8.memory[00200] == 07300 && pdp8.memory[00201] == 00001 && pdp8.memory[00202] == 07777);
+  PDP8_ImageFree(&image);
+
+  // a data word where an address belongs
+  static const unsigned char bad[] = { 0200, 0002, 0000, 0073, 0000, 0200 };
+  write_file(file_name, bad, sizeof(bad));
+  CHECK(PDP8_ImageFromRim(&image, file_name) == PDP8_ERROR_FORMAT);
+  unlink(file_name);
+}
+
+static void check_text(void) {
+  static const char text[] = "/compare\n*200 7300 1070\t/comment\n*70 40\n$200\n";
+  char file_name[64];
+  write_file(file_name, text, strlen(text));
+
+  struct PDP8_Image image;
+  static struct PDP8 pdp8;
+  CHECK(PDP8_ImageFromText(&image, file_name) == PDP8_OK);
+  CHECK(image.segment_count == 2 && image.start == 00200);
+  CHECK(PDP8_ImageDeposit(&image, 00201, 01100) == PDP8_OK);
+  load(&pdp8, &image);
+  CHECK(pdp8.memory[00200] == 07300 && pdp8.memory[00201] == 01100 && pdp8.memory[00070] == 040);
+
+  pdp8.run = false;
+  PDP8_StartImage(&pdp8, &image);
+  CHECK(pdp8.pc == 00200 && pdp8.run);
+  PDP8_ImageFree(&image);
+
+  static const char *const bad[] = { "*200 12a\n", "10000\n", "*\n" };
+  for (uint i = 0; i < 3; ++i) {
+    write_file(file_name, bad[i], strlen(bad[i]));
+    CHECK(PDP8_ImageFromText(&image, file_name) == PDP8_ERROR_FORMAT);
+  }
+  unlink(file_name);
+}
+
+// The corpus tapes load their listings' code; hello_world's two tapes
+// agree, while compare.bin reaches its target through a link at 0377.
+static void check_corpus(void) {
+  struct PDP8_Image image;
+  static struct PDP8 bin, rim;
+  CHECK(PDP8_ImageFromFile(&image, CORPUS "/compare.bin") == PDP8_OK);
+  load(&bin, &image);
+  PDP8_ImageFree(&image);
+  CHECK(PDP8_ImageFromFile(&image, CORPUS "/compare.rim") == PDP8_OK);
+  load(&rim, &image);
+  PDP8_ImageFree(&image);
+
+  static const uint code[] = { 07300, 01070, 07041, 01100, 07430, 05110 };
+  for (uint i = 0; i < 6; ++i) CHECK(rim.memory[00200 + i] == code[i]);
+  CHECK(!memcmp(&bin.memory[00200], code, 5 * sizeof(uint)));
+  CHECK(bin.memory[00205] == 05777 && bin.memory[00377] == 00472);
+
+  CHECK(PDP8_ImageFromFile(&image, CORPUS "/hello_world.bin") == PDP8_OK);
+  load(&bin, &image);
+  PDP8_ImageFree(&image);
+  CHECK(PDP8_ImageFromFile(&image, CORPUS "/hello_world.rim") == PDP8_OK);
+  load(&rim, &image);
+  PDP8_ImageFree(&image);
+  CHECK(!memcmp(bin.memory, rim.memory, sizeof(bin.memory)));
+}
+
+static uint label(const struct PDP8_Symbols *symbols, const char *name) {
+  const struct PDP8_Symbol *symbol = PDP8_SymbolsLookup(symbols, name, strlen(name));
+  return symbol && symbol->type == PDP8_SYMBOL_LABEL ? symbol->value : 010000;
+}
+
+// Symbols come from a source's labels, from the listing next to a tape,
+// or from the listing given; a sibling listing without a symbol table is
+// passed over.
+static void check_symbols(void) {
+  struct PDP8_Image image;
+  struct PDP8_Symbols symbols;
+  static const char *const images[] = { CORPUS "/hello_world.pal", CORPUS "/hello_world.bin" };
+  for (uint i = 0; i < 2; ++i) {
+    PDP8_SymbolsInit(&symbols);
+    CHECK(PDP8_ImageFromFileWithSymbols(&image, &symbols, images[i], NULL) == PDP8_OK);
+    CHECK(label(&symbols, "HELLO") == 00200 && label(&symbols, "STPTR") == 00010);
+    CHECK(image.segment_count > 0);
+    PDP8_ImageFree(&image);
+    PDP8_SymbolsFree(&symbols);
+  }
+
+  PDP8_SymbolsInit(&symbols);
+  CHECK(PDP8_ImageFromFileWithSymbols(&image, &symbols, CORPUS "/compare.rim", NULL) == PDP8_OK);
+  CHECK(label(&symbols, "HELLO") == 010000);
+  PDP8_ImageFree(&image);
+  CHECK(PDP8_ImageFromFileWithSymbols(&image, &symbols, CORPUS "/compare.rim", CORPUS "/hello_world.lst") ==
+        PDP8_OK);
+  CHECK(label(&symbols, "STRNG") == 00210);
+  PDP8_ImageFree(&image);
+  PDP8_SymbolsFree(&symbols);
+}
+
+static void check_parse(void) {
+  uint address, value;
+  CHECK(PDP8_ParseOctal("7777", &value) && value == 07777);
+  CHECK(!PDP8_ParseOctal("10000", &value) && !PDP8_ParseOctal("8", &value) && !PDP8_ParseOctal("", &value));
+  CHECK(PDP8_ParseDeposit("70=40", &address, &value) && address == 070 && value == 040);
+  CHECK(!PDP8_ParseDeposit("70", &address, &value) && !PDP8_ParseDeposit("70=", &address, &value));
+}
+
+int main(void) {
+  check_binary();
+  check_rim();
+  check_text();
+  check_corpus();
+  check_symbols();
+  check_parse();
+  return check_result("loader");
+}
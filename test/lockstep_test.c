@@ -0,0 +1,104 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pdp8.h"
+#include "loader.h"
+#include "assembler.h"
+#include "engine.h"
+#include "lockstep.h"
+#include "corpus.h"
+#include "check.h"
+
+#define BUDGET 1000000
+
+// Counts AC up by one; the 4096th TAD carries into the link.
+static const char source[] =
+  "*200\n"
+  "START,  TAD ONE\n"
+  "        JMP START\n"
+  "ONE,    1\n"
+  "$START\n";
+
+static void start(struct PDP8 *pdp8, const struct PDP8_Image *image) {
+  PDP8_Reset(pdp8);
+  PDP8_MemoryReset(pdp8);
+  PDP8_LoadImage(pdp8, image);
+  PDP8_StartImage(pdp8, image);
+}
+
+// faulty-tad is caught at the first carry, instruction 8190, in
+// lockstep and with blocks that straddle it.  Every other carry puts its
+// link right again, so a block must end before the second one.
+static void check_faulty(const struct PDP8_Image *image) {
+  static struct PDP8 initial, expected;
+  static struct PDP8_LockstepResult result;
+  const struct PDP8_Engine *faulty = PDP8_FindEngine("faulty-tad");
+  CHECK(faulty != NULL && faulty->faulty);
+  if (!faulty) return;
+  start(&initial, image);
+  expected = initial;
+  PDP8_RunFor(&expected, 8190, NULL);
+
+  static const uint64_t blocks[] = { 1, 1000, 10000 };
+  for (uint i = 0; i < 3; ++i) {
+    CHECK(PDP8_Lockstep(&initial, faulty, BUDGET, blocks[i], &result) == PDP8_OK);
+    CHECK(result.mismatch && result.executed == 8190);
+    CHECK(PDP8_StateEqual(&result.before, &expected));
+    CHECK(result.reference.link == 1 && result.candidate.link == 0);
+    CHECK(result.reference.ac == 0 && result.candidate.ac == 0);
+  }
+
+  // the report gives the instruction and the link diff
+  char *report;
+  size_t length;
+  FILE *out = open_memstream(&report, &length);
+  PDP8_PrintLockstepResult(out, faulty->name, &result);
+  fclose(out);
+  CHECK(strstr(report, "faulty-tad differs from the reference at instruction 8190\n") != NULL);
+  CHECK(strstr(report, "\n  L ") != NULL);
+  free(report);
+
+  // before the carry the engines agree
+  CHECK(PDP8_Lockstep(&initial, faulty, 8190, 1, &result) == PDP8_OK);
+  CHECK(!result.mismatch && result.executed == 8190);
+}
+
+// Every registered engine not broken on purpose agrees with the
+// reference over the corpus.
+static void check_engines(void) {
+  static struct PDP8 initial;
+  static struct PDP8_LockstepResult result;
+  for (uint i = 0; i < PDP8_CORPUS_COUNT; ++i) {
+    char path[256];
+    snprintf(path, sizeof(path), "%s/%s", PDP8_CORPUS_DIRECTORY, PDP8_Corpus[i]);
+    struct PDP8_Image image;
+    CHECK(PDP8_AssembleFile(&image, NULL, path, NULL) == PDP8_OK);
+    start(&initial, &image);
+    PDP8_ImageFree(&image);
+
+    for (uint e = 0; e < PDP8_EngineCount; ++e) {
+      if (PDP8_Engines[e].faulty) continue;
+      CHECK(PDP8_Lockstep(&initial, &PDP8_Engines[e], BUDGET, 1000, &result) == PDP8_OK);
+      CHECK(!result.mismatch && result.executed > 0);
+    }
+  }
+  CHECK(PDP8_FindEngine("step") != NULL && PDP8_FindEngine("none") == NULL);
+}
+
+// pdp8-lockstep's own self-test passes.
+static void check_self_test(void) {
+  CHECK(system("./pdp8-lockstep -t > /dev/null") == 0);
+}
+
+int main(void) {
+  struct PDP8_Image image;
+  struct PDP8_AssemblerError error;
+  CHECK(PDP8_Assemble(&image, NULL, source, strlen(source), &error) == PDP8_OK);
+  check_faulty(&image);
+  PDP8_ImageFree(&image);
+
+  check_engines();
+  check_self_test();
+  return check_result("lockstep");
+}
@@ -0,0 +1,242 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "pdp8.h"
+#include "instruction.h"
+#include "check.h"
+
+// A cleared machine about to run from 0200.
+static void start(struct PDP8 *pdp8) {
+  PDP8_Reset(pdp8);
+  PDP8_MemoryReset(pdp8);
+  pdp8->pc = 00200;
+  pdp8->run = true;
+}
+
+// Executes one instruction placed at the current PC.
+static void execute(struct PDP8 *pdp8, uint word) {
+  pdp8->memory[pdp8->pc] = word;
+  PDP8_Step(pdp8);
+}
+
+// TAD I through every page zero word: only 0010-0017 are incremented
+// before use, and an auto-index register wraps from 7777 to 0000.
+static void check_auto_index(void) {
+  static struct PDP8 pdp8;
+  for (uint address = 0; address < 040; ++address) {
+    start(&pdp8);
+    pdp8.memory[address] = 00100;
+    pdp8.memory[00100] = 3;
+    pdp8.memory[00101] = 5;
+    execute(&pdp8, 01400 | address);
+    bool auto_index = address >= 010 && address <= 017;
+    CHECK(pdp8.memory[address] == (auto_index ? 00101u : 00100u));
+    CHECK(pdp8.ac == (auto_index ? 5u : 3u));
+  }
+
+  start(&pdp8);
+  pdp8.memory[00017] = 07777;
+  pdp8.memory[00000] = 042;
+  execute(&pdp8, 01417);
+  CHECK(pdp8.memory[00017] == 0 && pdp8.ac == 042);
+
+  // the rule the engine and the tracer share
+  for (uint address = 0; address < PDP8_MEMORY_SIZE; ++address) {
+    bool auto_index = address >= 010 && address <= 017;
+    CHECK(PDP8_AutoIndex(address) == auto_index);
+    CHECK(PDP8_IndirectAddress(address, 07777) == (auto_index ? 0u : 07777u));
+  }
+}
+
+struct skip {
+  uint word;
+  uint lac;
+  bool taken;
+};
+
+// Group 2 skips on minus, zero and non-zero link are or'ed; with IS their
+// inverses are and'ed, and IS alone always skips.
+static const struct skip skips[] = {
+  { 07500, 004000, true  }, { 07500, 003777, false },   // SMA
+  { 07440, 000000, true  }, { 07440, 000001, false },   // SZA
+  { 07420, 010000, true  }, { 07420, 007777, false },   // SNL
+  { 07510, 003777, true  }, { 07510, 004000, false },   // SPA
+  { 07450, 000001, true  }, { 07450, 000000, false },   // SNA
+  { 07430, 007777, true  }, { 07430, 010000, false },   // SZL
+  { 07410, 000000, true  }, { 07410, 017777, true  },   // SKP
+  { 07400, 000000, false },                             // NOP
+  { 07540, 000000, true  }, { 07540, 004000, true  },   // SMA SZA
+  { 07540, 000001, false },
+  { 07560, 010001, true  }, { 07560, 000001, false },   // SMA SZA SNL
+  { 07550, 000001, true  }, { 07550, 000000, false },   // SPA SNA
+  { 07550, 004000, false },
+  { 07570, 000001, true  }, { 07570, 010001, false },   // SPA SNA SZL
+};
+
+static void check_skips(void) {
+  static struct PDP8 pdp8;
+  for (uint i = 0; i < sizeof(skips) / sizeof(skips[0]); ++i) {
+    start(&pdp8);
+    pdp8.lac = skips[i].lac;
+    execute(&pdp8, skips[i].word);
+    uint pc = skips[i].taken ? 00202 : 00201;
+    if (pdp8.pc != pc) fprintf(stderr, "%04o with LAC %05o: PC %04o, expected %04o\n", skips[i].word, skips[i].lac, pdp8.pc, pc);
+    CHECK(pdp8.pc == pc);
+  }
+}
+
+// IOP1 is the low bit of an IOT and is pulsed first: KSF 6031 is IOP1,
+// KCC 6032 IOP2, KRS 6034 IOP4 and TLS 6046 IOP2 and IOP4.
+static void check_pulses(void) {
+  CHECK(IO_PULSE_P1 == 1 && IO_PULSE_P2 == 2 && IO_PULSE_P4 == 4);
+  CHECK((06031 & IO_CONTROL) == IO_PULSE_P1);
+  CHECK((06032 & IO_CONTROL) == IO_PULSE_P2);
+  CHECK((06034 & IO_CONTROL) == IO_PULSE_P4);
+  CHECK((06046 & IO_CONTROL) == (IO_PULSE_P2 | IO_PULSE_P4));
+}
+
+// ION lets one more instruction run before an interrupt, which stores
+// the PC in 0000, continues at 0001 and turns the interrupt system off.
+static void check_interrupts(void) {
+  static struct PDP8 pdp8;
+  start(&pdp8);
+  pdp8.interrupt_request = true;
+  execute(&pdp8, 06001);
+  CHECK(pdp8.interrupt_enable && pdp8.pc == 00201);
+  execute(&pdp8, 07000);
+  CHECK(pdp8.pc == 00001 && pdp8.memory[0] == 00202);
+  CHECK(!pdp8.interrupt_enable && !pdp8.restart);
+  execute(&pdp8, 07000);
+  CHECK(pdp8.pc == 00002 && pdp8.memory[0] == 00202);
+
+  // without a request the interrupt system just stays on
+  start(&pdp8);
+  execute(&pdp8, 06001);
+  execute(&pdp8, 07000);
+  execute(&pdp8, 07000);
+  CHECK(pdp8.interrupt_enable && pdp8.pc == 00203);
+
+  // SKON skips if the system was on and turns it off; IOF turns it off
+  start(&pdp8);
+  pdp8.interrupt_enable = true;
+  execute(&pdp8, 06000);
+  CHECK(pdp8.pc == 00202 && !pdp8.interrupt_enable);
+  execute(&pdp8, 06000);
+  CHECK(pdp8.pc == 00203);
+  pdp8.interrupt_enable = true;
+  execute(&pdp8, 06002);
+  CHECK(pdp8.pc == 00204 && !pdp8.interrupt_enable);
+
+  // SRQ skips on a request whether or not the system is on
+  execute(&pdp8, 06003);
+  CHECK(pdp8.pc == 00205);
+  pdp8.interrupt_request = true;
+  execute(&pdp8, 06003);
+  CHECK(pdp8.pc == 00207);
+}
+
+struct printed {
+  char text[16];
+  uint length;
+};
+
+static void print(void *context, uint c) {
+  struct printed *printed = (struct printed *)context;
+  if (printed->length < sizeof(printed->text) - 1) printed->text[printed->length++] = (char)c;
+}
+
+// The keyboard (03) and printer (04) flags skip, clear and interrupt.
+static void check_teletype(void) {
+  static struct PDP8 pdp8;
+  start(&pdp8);
+  execute(&pdp8, 06031);
+  CHECK(pdp8.pc == 00201);
+  PDP8_KeyboardInput(&pdp8, 'A');
+  execute(&pdp8, 06031);
+  CHECK(pdp8.pc == 00203);
+  pdp8.ac = 07000;
+  execute(&pdp8, 06036);                 // KRB: clear AC and the flag, read
+  CHECK(pdp8.ac == 'A' && !pdp8.keyboard_flag);
+
+  // the printer finishes at once, so its flag is up after TLS
+  struct printed printed = { { 0 }, 0 };
+  pdp8.print = print;
+  pdp8.print_context = &printed;
+  execute(&pdp8, 06046);
+  CHECK(printed.length == 1 && printed.text[0] == 'A');
+  CHECK(pdp8.printer_flag && pdp8.printer_buffer == 'A');
+  uint pc = pdp8.pc;
+  execute(&pdp8, 06041);
+  CHECK(pdp8.pc == pc + 2);
+  execute(&pdp8, 06042);
+  CHECK(!pdp8.printer_flag);
+
+  // either flag requests an interrupt
+  execute(&pdp8, 06001);
+  execute(&pdp8, 07000);
+  CHECK(pdp8.interrupt_enable && pdp8.memory[0] == 0);
+  PDP8_KeyboardInput(&pdp8, 'B');
+  pc = pdp8.pc;
+  execute(&pdp8, 07000);
+  CHECK(pdp8.pc == 00001 && pdp8.memory[0] == pc + 1 && !pdp8.interrupt_enable);
+  execute(&pdp8, 06003);
+  CHECK(pdp8.pc == 00003);
+
+  PDP8_Reset(&pdp8);
+  CHECK(!pdp8.keyboard_flag && !pdp8.printer_flag && pdp8.print == NULL);
+}
+
+struct group3 {
+  uint word;
+  uint ac, mq;                           // before
+  uint expected_ac, expected_mq;
+};
+
+// Group 3 clears AC first, then MQL and MQA act on the cleared AC: both
+// together swap AC and MQ.
+static const struct group3 group3[] = {
+  { 07401, 01234, 05670, 01234, 05670 },   // NOP
+  { 07601, 01234, 05670, 00000, 05670 },   // CLA
+  { 07421, 01234, 05670, 00000, 01234 },   // MQL
+  { 07501, 01234, 05670, 05674, 05670 },   // MQA
+  { 07521, 01234, 05670, 05670, 01234 },   // SWP
+  { 07621, 01234, 05670, 00000, 00000 },   // CAM
+  { 07701, 01234, 05670, 05670, 05670 },   // ACL
+  { 07721, 01234, 05670, 05670, 00000 },   // CLA SWP
+};
+
+static void check_group3(void) {
+  static struct PDP8 pdp8;
+  for (uint i = 0; i < sizeof(group3) / sizeof(group3[0]); ++i) {
+    start(&pdp8);
+    pdp8.ac = group3[i].ac;
+    pdp8.mq = group3[i].mq;
+    pdp8.link = 1;
+    execute(&pdp8, group3[i].word);
+    if (pdp8.ac != group3[i].expected_ac || pdp8.mq != group3[i].expected_mq) {
+      fprintf(stderr, "%04o: AC %04o MQ %04o, expected %04o %04o\n", group3[i].word,
+              pdp8.ac, pdp8.mq, group3[i].expected_ac, group3[i].expected_mq);
+    }
+    CHECK(pdp8.ac == group3[i].expected_ac && pdp8.mq == group3[i].expected_mq);
+    CHECK(pdp8.link == 1 && pdp8.pc == 00201);
+  }
+
+  // MQ is part of the state
+  static struct PDP8 other;
+  start(&pdp8);
+  other = pdp8;
+  other.mq = 1;
+  CHECK(PDP8_StateHash(&pdp8) != PDP8_StateHash(&other));
+  PDP8_Reset(&other);
+  CHECK(other.mq == 0);
+}
+
+int main(void) {
+  check_auto_index();
+  check_skips();
+  check_pulses();
+  check_interrupts();
+  check_teletype();
+  check_group3();
+  return check_result("pdp8");
+}
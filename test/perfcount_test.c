@@ -0,0 +1,60 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "pdp8.h"
+#include "perfcount.h"
+#include "check.h"
+
+// Runs a small program long enough for the counters to see it.
+static void work(void) {
+  static struct PDP8 pdp8;
+  PDP8_Reset(&pdp8);
+  PDP8_MemoryReset(&pdp8);
+  pdp8.memory[00200] = 02020;          // ISZ 20
+  pdp8.memory[00201] = 05200;          // JMP 200
+  pdp8.pc = 00200;
+  pdp8.run = true;
+  PDP8_RunFor(&pdp8, 100000, NULL);
+}
+
+// Counters that open count the work between Start and Stop, and add up
+// over trials; without any (no PMU, or perf_event_paranoid) every counter
+// stays closed and reads zero, and the failure is kept.
+static void check_counters(void) {
+  struct PDP8_PerfCounters counters;
+  bool any = PDP8_PerfOpen(&counters);
+  PDP8_PerfReset(&counters);
+  PDP8_PerfStart(&counters);
+  work();
+  PDP8_PerfStop(&counters);
+
+  uint64_t first[PDP8_PERF_COUNT];
+  memcpy(first, counters.values, sizeof(first));
+  PDP8_PerfStart(&counters);
+  work();
+  PDP8_PerfStop(&counters);
+
+  bool available = false;
+  for (uint i = 0; i < PDP8_PERF_COUNT; ++i) {
+    CHECK(PDP8_PerfCounterNames[i] != NULL);
+    if (!PDP8_PerfAvailable(&counters, i)) {
+      CHECK(counters.values[i] == 0);
+      continue;
+    }
+    available = true;
+    CHECK(counters.values[i] >= first[i]);
+  }
+  CHECK(available == any);
+  if (!any) CHECK(counters.error != 0);
+  if (PDP8_PerfAvailable(&counters, PDP8_PERF_INSTRUCTIONS)) {
+    CHECK(first[PDP8_PERF_INSTRUCTIONS] > 100000);
+  }
+
+  PDP8_PerfClose(&counters);
+  for (uint i = 0; i < PDP8_PERF_COUNT; ++i) CHECK(!PDP8_PerfAvailable(&counters, i));
+}
+
+int main(void) {
+  check_counters();
+  return check_result("perfcount");
+}
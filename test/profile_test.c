@@ -0,0 +1,124 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pdp8.h"
+#include "loader.h"
+#include "assembler.h"
+#include "profile.h"
+#include "check.h"
+
+// Sums a three word list through an auto-index register, then calls a
+// subroutine on another page through a pointer.
+static const char source[] =
+  "*20\n"
+  "CNT,    7775            /-3\n"
+  "*200\n"
+  "START,  CLA CLL\n"
+  "LOOP,   TAD I X\n"
+  "        ISZ CNT\n"
+  "        JMP LOOP\n"
+  "        DCA SUM\n"
+  "        JMS I SUBP\n"
+  "        HLT\n"
+  "SUBP,   SUB\n"
+  "SUM,    0\n"
+  "LIST,   1\n"
+  "        2\n"
+  "        3\n"
+  "*400\n"
+  "SUB,    0\n"
+  "        JMP I SUB\n"
+  "*11\n"
+  "X,      LIST-1\n"
+  "$START\n";
+
+// Worked out by hand from the source: fetches count as executions only,
+// and cycles are charged to the instruction.
+struct count {
+  uint address;
+  uint64_t executions, reads, writes, cycles;
+};
+
+static const struct count expected[] = {
+  { 00011, 0, 3, 3, 0 },               // X, read and incremented by each TAD I X
+  { 00020, 0, 3, 3, 0 },               // CNT
+  { 00200, 1, 0, 0, 1 },               // CLA CLL
+  { 00201, 3, 0, 0, 9 },               // TAD I X, 3 cycles
+  { 00202, 3, 0, 0, 6 },               // ISZ CNT, 2 cycles, skips the third time
+  { 00203, 2, 0, 0, 2 },               // JMP LOOP, 1 cycle
+  { 00204, 1, 0, 0, 2 },               // DCA SUM
+  { 00205, 1, 0, 0, 3 },               // JMS I SUBP
+  { 00206, 1, 0, 0, 1 },               // HLT
+  { 00207, 0, 1, 0, 0 },               // SUBP
+  { 00210, 0, 0, 1, 0 },               // SUM
+  { 00211, 0, 1, 0, 0 },               // LIST
+  { 00212, 0, 1, 0, 0 },
+  { 00213, 0, 1, 0, 0 },
+  { 00400, 0, 1, 1, 0 },               // SUB, written by JMS and read by JMP I SUB
+  { 00401, 1, 0, 0, 2 },               // JMP I SUB
+};
+
+// PDP8_ProfileReport with top 1.
+static const char report_expected[] =
+  "13 instructions, 26 cycles\n"
+  "\n"
+  "address  symbol            executions       cycles      %      reads     writes  instruction\n"
+  "0201                                3            9  34.62          0          0  TAD I 0011\n"
+  "\n"
+  "address  symbol            executions       cycles      %      reads     writes  instruction\n"
+  "0011                                0            0   0.00          3          3  \n"
+  "\n"
+  "page     range             executions       cycles      %      reads     writes\n"
+  "1        0200-0377                 12           24  92.31          4          1\n"
+  "2        0400-0577                  1            2   7.69          1          1\n"
+  "0        0000-0177                  0            0   0.00          6          6\n";
+
+int main(void) {
+  struct PDP8_Image image;
+  struct PDP8_AssemblerError error;
+  CHECK(PDP8_Assemble(&image, NULL, source, strlen(source), &error) == PDP8_OK);
+
+  static struct PDP8 pdp8;
+  static struct PDP8_Profile profile;
+  PDP8_Reset(&pdp8);
+  PDP8_MemoryReset(&pdp8);
+  PDP8_LoadImage(&pdp8, &image);
+  PDP8_StartImage(&pdp8, &image);
+  PDP8_ProfileReset(&profile);
+  PDP8_ProfileAttach(&pdp8, &profile);
+
+  uint64_t executed;
+  CHECK(PDP8_RunFor(&pdp8, 1000, &executed) == PDP8_STOP_HALT);
+  CHECK(executed == 13);
+  CHECK(pdp8.cycles == 26);
+  CHECK(pdp8.memory[00210] == 6);
+
+  // every address not listed stays zero
+  static struct PDP8_Profile listed;
+  for (uint i = 0; i < sizeof(expected) / sizeof(expected[0]); ++i) {
+    uint address = expected[i].address;
+    CHECK(profile.executions[address] == expected[i].executions);
+    CHECK(profile.reads[address] == expected[i].reads);
+    CHECK(profile.writes[address] == expected[i].writes);
+    CHECK(profile.cycles[address] == expected[i].cycles);
+    listed.executions[address] = profile.executions[address];
+    listed.reads[address] = profile.reads[address];
+    listed.writes[address] = profile.writes[address];
+    listed.cycles[address] = profile.cycles[address];
+  }
+  CHECK(!memcmp(&listed, &profile, sizeof(profile)));
+
+  // the report ranks TAD I X first by cycles, X first by accesses and
+  // lists the pages used
+  char *report;
+  size_t length;
+  FILE *out = open_memstream(&report, &length);
+  PDP8_ProfileReport(out, &profile, pdp8.memory, NULL, 1);
+  fclose(out);
+  CHECK(!strcmp(report, report_expected));
+  free(report);
+
+  PDP8_ImageFree(&image);
+  return check_result("profile");
+}
@@ -0,0 +1,151 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "pdp8.h"
+#include "loader.h"
+#include "assembler.h"
+#include "replay.h"
+#include "check.h"
+
+// Echoes eight characters ORed with the switches and folds them into a
+// checksum, so the result depends on what arrived and when.
+static const char source[] =
+  "*20\n"
+  "CNT,    7770            /-8\n"
+  "SUM,    0\n"
+  "*200\n"
+  "START,  CLA CLL\n"
+  "WAIT,   KSF\n"
+  "        JMP WAIT\n"
+  "        KRB\n"
+  "        OSR\n"
+  "        TLS\n"
+  "        TAD SUM\n"
+  "        RAL\n"
+  "        DCA SUM\n"
+  "        ISZ CNT\n"
+  "        JMP WAIT\n"
+  "        HLT\n"
+  "$START\n";
+
+struct output {
+  char text[64];
+  uint length;
+};
+
+static void print(void *context, uint c) {
+  struct output *output = (struct output *)context;
+  if (output->length < sizeof(output->text) - 1) output->text[output->length++] = (char)c;
+}
+
+static void start(struct PDP8 *pdp8, const struct PDP8_Image *image, struct output *output) {
+  PDP8_Reset(pdp8);
+  PDP8_MemoryReset(pdp8);
+  PDP8_LoadImage(pdp8, image);
+  PDP8_StartImage(pdp8, image);
+  memset(output, 0, sizeof(*output));
+  pdp8->print = print;
+  pdp8->print_context = output;
+}
+
+// Types a character after runs of uneven length, and flips the switches
+// once along the way.
+static void record(struct PDP8 *pdp8, struct PDP8_InputLog *log) {
+  PDP8_InputLogInit(log, pdp8);
+  for (uint i = 0; pdp8->run; ++i) {
+    PDP8_RunFor(pdp8, 5 + i * 37 % 101, NULL);
+    if (i == 4) CHECK(PDP8_Input(pdp8, log, PDP8_INPUT_SWITCHES, 040) == PDP8_OK);
+    CHECK(PDP8_Input(pdp8, log, PDP8_INPUT_KEYBOARD, 'A' + i) == PDP8_OK);
+  }
+  CHECK(PDP8_InputLogEnd(log, pdp8, PDP8_STOP_HALT) == PDP8_OK);
+}
+
+static uint64_t replay(struct PDP8 *pdp8, const struct PDP8_InputLog *log) {
+  struct PDP8_Replay replay;
+  PDP8_ReplayInit(&replay, log);
+  CHECK(PDP8_ReplayRun(pdp8, &replay, 1000000, NULL) == PDP8_STOP_END);
+  CHECK(PDP8_ReplayStop(&replay) == PDP8_STOP_HALT);
+  return PDP8_StateHash(pdp8);
+}
+
+// Saves a log of one event, optionally followed by the end, and loads it.
+static int round_trip(uint kind, uint value, bool end) {
+  static struct PDP8 pdp8;
+  PDP8_Reset(&pdp8);
+  struct PDP8_InputLog log, loaded;
+  PDP8_InputLogInit(&log, &pdp8);
+  if (kind == PDP8_INPUT_END) PDP8_InputLogEnd(&log, &pdp8, value);
+  else PDP8_Input(&pdp8, &log, kind, value);
+  if (end) PDP8_InputLogEnd(&log, &pdp8, PDP8_STOP_HALT);
+
+  char file_name[] = "/tmp/pdp8-replay-XXXXXX";
+  int fd = mkstemp(file_name);
+  close(fd);
+  PDP8_InputLogSave(&log, file_name);
+  int status = PDP8_InputLogLoad(&loaded, file_name);
+  unlink(file_name);
+  if (status == PDP8_OK) PDP8_InputLogFree(&loaded);
+  PDP8_InputLogFree(&log);
+  return status;
+}
+
+// Values a run cannot have recorded are refused, so a stop reason read
+// back can index pdp8-run's tables.
+static void check_ranges(void) {
+  CHECK(round_trip(PDP8_INPUT_KEYBOARD, 0377, true) == PDP8_OK);
+  CHECK(round_trip(PDP8_INPUT_KEYBOARD, 0400, true) == PDP8_ERROR_FORMAT);
+  CHECK(round_trip(PDP8_INPUT_SWITCHES, 07777, true) == PDP8_OK);
+  CHECK(round_trip(PDP8_INPUT_SWITCHES, 010000, true) == PDP8_ERROR_FORMAT);
+  CHECK(round_trip(PDP8_INPUT_INTERRUPT, 1, true) == PDP8_OK);
+  CHECK(round_trip(PDP8_INPUT_INTERRUPT, 2, true) == PDP8_ERROR_FORMAT);
+  CHECK(round_trip(PDP8_INPUT_END, PDP8_STOP_WATCHPOINT, false) == PDP8_OK);
+  CHECK(round_trip(PDP8_INPUT_END, 0143, false) == PDP8_ERROR_FORMAT);
+  CHECK(round_trip(PDP8_INPUT_END, PDP8_STOP_HALT, true) == PDP8_ERROR_FORMAT);
+}
+
+int main(void) {
+  struct PDP8_Image image;
+  struct PDP8_AssemblerError error;
+  CHECK(PDP8_Assemble(&image, NULL, source, strlen(source), &error) == PDP8_OK);
+
+  static struct PDP8 recorded, replayed;
+  struct output recorded_output, replayed_output;
+  struct PDP8_InputLog log, loaded;
+  start(&recorded, &image, &recorded_output);
+  record(&recorded, &log);
+  CHECK(log.final_hash == PDP8_StateHash(&recorded));
+  CHECK(log.final_hash != log.initial_hash);
+
+  // the log survives a round trip through its file
+  char file_name[] = "/tmp/pdp8-replay-XXXXXX";
+  int fd = mkstemp(file_name);
+  CHECK(fd >= 0);
+  close(fd);
+  CHECK(PDP8_InputLogSave(&log, file_name) == PDP8_OK);
+  CHECK(PDP8_InputLogLoad(&loaded, file_name) == PDP8_OK);
+  unlink(file_name);
+  CHECK(loaded.initial_hash == log.initial_hash && loaded.final_hash == log.final_hash);
+  CHECK(loaded.count == log.count && !memcmp(loaded.events, log.events, log.count * sizeof(*log.events)));
+
+  // replayed at full speed, it ends in the same state with the same output
+  start(&replayed, &image, &replayed_output);
+  CHECK(PDP8_StateHash(&replayed) == loaded.initial_hash);
+  CHECK(replay(&replayed, &loaded) == loaded.final_hash);
+  CHECK(replayed.cycles == recorded.cycles);
+  CHECK(!memcmp(replayed.memory, recorded.memory, sizeof(recorded.memory)));
+  CHECK(replayed_output.length == 8 && !strcmp(replayed_output.text, recorded_output.text));
+
+  // another character gives another run
+  loaded.events[3].value ^= 1;
+  start(&replayed, &image, &replayed_output);
+  replay(&replayed, &loaded);
+  CHECK(PDP8_StateHash(&replayed) != loaded.final_hash);
+
+  PDP8_InputLogFree(&log);
+  PDP8_InputLogFree(&loaded);
+  PDP8_ImageFree(&image);
+  check_ranges();
+  return check_result("replay");
+}
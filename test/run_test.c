@@ -0,0 +1,115 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "pdp8.h"
+#include "check.h"
+
+#define CORPUS "../program"
+#define RUN    "./pdp8-run "
+
+// Runs pdp8-run with arguments and returns its exit code and output.
+static int run(const char *arguments, char *output, size_t size) {
+  char command[512];
+  snprintf(command, sizeof(command), RUN "%s 2>&1", arguments);
+  FILE *pipe = popen(command, "r");
+  CHECK(pipe != NULL);
+  if (!pipe) return -1;
+  size_t length = fread(output, 1, size - 1, pipe);
+  output[length] = '\0';
+  int status = pclose(pipe);
+  return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+// Writes text to a new temporary file ending in suffix.
+static void write_file(char *file_name, const char *suffix, const char *text) {
+  sprintf(file_name, "/tmp/pdp8-run-XXXXXX%s", suffix);
+  int fd = mkstemps(file_name, strlen(suffix));
+  CHECK(fd >= 0 && write(fd, text, strlen(text)) == (ssize_t)strlen(text));
+  close(fd);
+}
+
+// Halts, budgets and stop addresses each have their exit code, and the
+// final state and memory ranges are printed.
+static void check_stops(void) {
+  static char output[4096];
+  CHECK(run(CORPUS "/sieve.pal", output, sizeof(output)) == 0);
+  CHECK(strstr(output, "halted after ") && strstr(output, "AC 0254"));
+
+  CHECK(run(CORPUS "/sieve.pal -n 100", output, sizeof(output)) == 2);
+  CHECK(strstr(output, "budget exhausted after 100 instructions"));
+  CHECK(run(CORPUS "/sieve.pal -c 1000", output, sizeof(output)) == 2);
+
+  CHECK(run(CORPUS "/sieve.pal -a 206", output, sizeof(output)) == 3);
+  CHECK(strstr(output, "PC 0206"));
+  CHECK(run(CORPUS "/sieve.pal -a 200", output, sizeof(output)) == 3);
+  CHECK(strstr(output, "breakpoint after 0 instructions") && strstr(output, "PC 0200"));
+
+  CHECK(run(CORPUS "/sieve.pal -q -m 20-24", output, sizeof(output)) == 0);
+  CHECK(!strncmp(output, "0020: 2000 3777 0000 0254 6000     ", 35));
+
+  CHECK(run("/nonexistent/image.bin", output, sizeof(output)) == 1);
+  CHECK(run("", output, sizeof(output)) == 1);
+
+  // a replay checks neither breakpoints nor watchpoints
+  CHECK(run(CORPUS "/sieve.pal -p /dev/null -a 200", output, sizeof(output)) == 1);
+  CHECK(run(CORPUS "/sieve.pal -p /dev/null -W 20", output, sizeof(output)) == 1);
+  CHECK(strstr(output, "without -a or -W"));
+
+  // a log whose end holds no stop reason is refused; the value is the
+  // file's last byte
+  char log[64], arguments[256];
+  write_file(log, "", "");
+  snprintf(arguments, sizeof(arguments), CORPUS "/sieve.pal -q -r %s", log);
+  CHECK(run(arguments, output, sizeof(output)) == 0);
+  snprintf(arguments, sizeof(arguments), CORPUS "/sieve.pal -p %s", log);
+  CHECK(run(arguments, output, sizeof(output)) == 0 && strstr(output, "halted after "));
+  FILE *file = fopen(log, "r+b");
+  CHECK(file && fseek(file, -1, SEEK_END) == 0 && fputc(0143, file) == 0143);
+  if (file) fclose(file);
+  CHECK(run(arguments, output, sizeof(output)) == 1);
+  unlink(log);
+}
+
+// hello_world prints to the output file; an echo loop copies its input
+// and stops once it waits for more.
+static void check_devices(void) {
+  static char output[4096];
+  char printed[64], arguments[256];
+  write_file(printed, "", "");
+  snprintf(arguments, sizeof(arguments), CORPUS "/hello_world.pal -q -o %s", printed);
+  CHECK(run(arguments, output, sizeof(output)) == 0);
+  FILE *file = fopen(printed, "rb");
+  size_t length = file ? fread(output, 1, sizeof(output) - 1, file) : 0;
+  if (file) fclose(file);
+  output[length] = '\0';
+  CHECK(!strcmp(output, "Hello, world!"));
+
+  // KSF, JMP .-1, KRB, TLS, JMP 200
+  char echo[64], input[64];
+  write_file(echo, ".txt", "*200 6031 5200 6036 6046 5200\n$200\n");
+  write_file(input, "", "echo");
+  snprintf(arguments, sizeof(arguments), "%s -q -w -i %s -o -", echo, input);
+  CHECK(run(arguments, output, sizeof(output)) == 4);
+  CHECK(!strcmp(output, "echo"));
+
+  // LAS, JMP .-1 halts on the deposited HLT with the switches in AC
+  char las[64];
+  write_file(las, ".txt", "*200 7604 5200\n$200\n");
+  snprintf(arguments, sizeof(arguments), "%s -s 1234 -d 201=7402", las);
+  CHECK(run(arguments, output, sizeof(output)) == 0);
+  CHECK(strstr(output, "AC 1234") && strstr(output, "SR 1234"));
+
+  unlink(printed);
+  unlink(echo);
+  unlink(input);
+  unlink(las);
+}
+
+int main(void) {
+  check_stops();
+  check_devices();
+  return check_result("run");
+}
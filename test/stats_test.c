@@ -0,0 +1,113 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pdp8.h"
+#include "loader.h"
+#include "assembler.h"
+#include "stats.h"
+#include "check.h"
+
+// Every opcode, both kinds of address and page, auto-indexing, skips
+// taken and not, and IOTs on two devices.
+static const char source[] =
+  "*20\n"
+  "CNT,    7776            /-2\n"
+  "MASK,   0017\n"
+  "*200\n"
+  "START,  CLA CLL\n"
+  "        TLS\n"
+  "LOOP,   TAD I AUTO\n"
+  "        AND MASK\n"
+  "        SNA\n"
+  "        HLT\n"
+  "        ISZ CNT\n"
+  "        JMP LOOP\n"
+  "        DCA SAVE\n"
+  "        KSF\n"
+  "        SNL\n"
+  "        JMS I SUBP\n"
+  "        HLT\n"
+  "SUBP,   SUB\n"
+  "SAVE,   0\n"
+  "LIST,   1\n"
+  "        2\n"
+  "*400\n"
+  "SUB,    0\n"
+  "        JMP I SUB\n"
+  "*10\n"
+  "AUTO,   LIST-1\n"
+  "$START\n";
+
+// Counted by hand: the loop runs twice, SNA skips both times, ISZ skips
+// the second time and SNL never does; KSF is an IOT, not a counted skip.
+static struct PDP8_Stats expected(void) {
+  struct PDP8_Stats stats;
+  PDP8_StatsReset(&stats);
+  const uint64_t opcodes[8] = { 2, 2, 2, 1, 1, 2, 2, 5 };
+  memcpy(stats.opcodes, opcodes, sizeof(opcodes));
+  stats.direct = 6;                    // AND MASK, ISZ CNT, JMP LOOP, DCA SAVE
+  stats.indirect = 4;                  // TAD I AUTO, JMS I SUBP, JMP I SUB
+  stats.page_zero = 6;                 // AUTO, MASK, CNT
+  stats.current_page = 4;
+  stats.auto_index = 2;
+  stats.skips_taken = 3;
+  stats.skips_not_taken = 2;
+  stats.iots[003] = 1;                 // KSF
+  stats.iots[004] = 1;                 // TLS
+  return stats;
+}
+
+// PDP8_StatsPrint of those counts; devices are named after their first IOT.
+static const char printed[] =
+  "17 instructions\n"
+  "  AND                       2  11.76%\n"
+  "  TAD                       2  11.76%\n"
+  "  ISZ                       2  11.76%\n"
+  "  DCA                       1   5.88%\n"
+  "  JMS                       1   5.88%\n"
+  "  JMP                       2  11.76%\n"
+  "  IOT                       2  11.76%\n"
+  "  OPR                       5  29.41%\n"
+  "  direct                    6  60.00%   indirect                  4  40.00%\n"
+  "  page zero                 6  60.00%   current page              4  40.00%\n"
+  "  auto-index                2  50.00% of indirect\n"
+  "  skip taken                3  60.00%   not taken                 2  40.00%\n"
+  "  IOT 03 KSF                1  50.00%\n"
+  "  IOT 04 TSF                1  50.00%\n";
+
+int main(void) {
+  struct PDP8_Image image;
+  struct PDP8_AssemblerError error;
+  CHECK(PDP8_Assemble(&image, NULL, source, strlen(source), &error) == PDP8_OK);
+
+  static struct PDP8 pdp8;
+  PDP8_Reset(&pdp8);
+  PDP8_MemoryReset(&pdp8);
+  PDP8_LoadImage(&pdp8, &image);
+  PDP8_StartImage(&pdp8, &image);
+
+  // flushed into the total every 5 instructions
+  struct PDP8_StatsTotal total;
+  PDP8_StatsTotalInit(&total);
+  uint64_t executed;
+  CHECK(PDP8_StatsRun(&pdp8, &total, NULL, 1000, 5, &executed) == PDP8_STOP_HALT);
+  CHECK(executed == 17);
+  CHECK(pdp8.stats == NULL);
+
+  struct PDP8_Stats stats = expected();
+  CHECK(PDP8_StatsInstructions(&total.stats) == 17);
+  CHECK(!memcmp(&total.stats, &stats, sizeof(stats)));
+
+  char *text;
+  size_t length;
+  FILE *out = open_memstream(&text, &length);
+  PDP8_StatsPrint(out, &total.stats);
+  fclose(out);
+  CHECK(!strcmp(text, printed));
+  free(text);
+
+  PDP8_StatsTotalFree(&total);
+  PDP8_ImageFree(&image);
+  return check_result("stats");
+}
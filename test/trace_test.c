@@ -0,0 +1,191 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "pdp8.h"
+#include "loader.h"
+#include "assembler.h"
+#include "trace.h"
+#include "check.h"
+
+#define INSTRUCTIONS 2000
+
+// Memory reference instructions of every kind around a counting loop.
+static const char source[] =
+  "*20\n"
+  "CNT,    0\n"
+  "PTR,    LIST\n"
+  "*200\n"
+  "START,  CLA CLL\n"
+  "LOOP,   TAD I PTR\n"
+  "        DCA SUM\n"
+  "        JMS SUB\n"
+  "        ISZ CNT\n"
+  "        JMP LOOP\n"
+  "        HLT\n"
+  "SUM,    0\n"
+  "LIST,   1\n"
+  "SUB,    0\n"
+  "        JMP I SUB\n"
+  "$START\n";
+
+// Keeps every record it is handed; slow enough that a small ring fills.
+struct collected {
+  struct PDP8_TraceRecord records[INSTRUCTIONS];
+  size_t count;
+  uint writes;
+  uint closes;
+  bool slow;
+  int status;
+};
+
+static int collect_write(void *context, const struct PDP8_TraceRecord *records, size_t count) {
+  struct collected *collected = (struct collected *)context;
+  if (collected->slow) {
+    struct timespec pause = { 0, 200000 };
+    nanosleep(&pause, NULL);
+  }
+  if (collected->count + count > INSTRUCTIONS) return PDP8_ERROR_WRITE;
+  memcpy(&collected->records[collected->count], records, count * sizeof(*records));
+  collected->count += count;
+  collected->writes++;
+  return collected->status;
+}
+
+static int collect_close(void *context) {
+  ((struct collected *)context)->closes++;
+  return PDP8_OK;
+}
+
+static void start(struct PDP8 *pdp8, const struct PDP8_Image *image) {
+  PDP8_Reset(pdp8);
+  PDP8_MemoryReset(pdp8);
+  PDP8_LoadImage(pdp8, image);
+  PDP8_StartImage(pdp8, image);
+}
+
+// The records an untraced machine gives for the same run; without
+// interrupts MA after a memory reference instruction is its effective
+// address.
+static void expect(const struct PDP8_Image *image, struct PDP8_TraceRecord *records) {
+  static struct PDP8 pdp8;
+  start(&pdp8, image);
+  for (uint i = 0; i < INSTRUCTIONS; ++i) {
+    uint64_t cycles = pdp8.cycles;
+    PDP8_Step(&pdp8);
+    records[i].pc = pdp8.last_pc;
+    records[i].ir = pdp8.ir;
+    records[i].lac = pdp8.lac;
+    records[i].ea = (pdp8.ir >> 9) < 6 ? pdp8.ma : 0;
+    records[i].cycles = pdp8.cycles - cycles;
+  }
+}
+
+// A ring of 16 records behind a slow sink: the producer waits for room
+// instead of dropping records, and every record arrives in order.
+static void check_ring(const struct PDP8_Image *image, const struct PDP8_TraceRecord *expected) {
+  static struct collected collected;
+  collected.slow = true;
+  collected.status = PDP8_OK;
+  struct PDP8_TraceSink sink = { &collected, collect_write, collect_close };
+
+  static struct PDP8 pdp8;
+  start(&pdp8, image);
+  struct PDP8_Trace trace;
+  CHECK(PDP8_TraceOpen(&trace, 4, sink) == PDP8_OK);
+  uint64_t executed;
+  CHECK(PDP8_TraceRun(&trace, &pdp8, INSTRUCTIONS, &executed) == PDP8_STOP_BUDGET);
+  CHECK(executed == INSTRUCTIONS);
+  CHECK(PDP8_TraceClose(&trace) == PDP8_OK);
+
+  CHECK(collected.count == INSTRUCTIONS && collected.closes == 1);
+  CHECK(collected.writes >= INSTRUCTIONS / 16);
+  CHECK(!memcmp(collected.records, expected, sizeof(collected.records)));
+  CHECK(expected[0].pc == 00200 && expected[0].ir == 07300 && expected[0].cycles == 1);
+}
+
+// The first sink error is kept and returned by the close.
+static void check_error(const struct PDP8_Image *image) {
+  static struct collected collected;
+  collected.status = PDP8_ERROR_WRITE;
+  struct PDP8_TraceSink sink = { &collected, collect_write, collect_close };
+
+  static struct PDP8 pdp8;
+  start(&pdp8, image);
+  struct PDP8_Trace trace;
+  CHECK(PDP8_TraceOpen(&trace, 4, sink) == PDP8_OK);
+  PDP8_TraceRun(&trace, &pdp8, 100, NULL);
+  CHECK(PDP8_TraceClose(&trace) == PDP8_ERROR_WRITE);
+  CHECK(collected.writes == 1 && collected.closes == 1);
+}
+
+// The raw file is the magic followed by the records as they are.
+static void check_file(const struct PDP8_Image *image, const struct PDP8_TraceRecord *expected) {
+  char file_name[] = "/tmp/pdp8-trace-XXXXXX";
+  int fd = mkstemp(file_name);
+  CHECK(fd >= 0);
+  close(fd);
+
+  static struct PDP8 pdp8;
+  start(&pdp8, image);
+  struct PDP8_Trace trace;
+  CHECK(PDP8_TraceOpenFile(&trace, file_name) == PDP8_OK);
+  PDP8_TraceRun(&trace, &pdp8, INSTRUCTIONS, NULL);
+  CHECK(PDP8_TraceClose(&trace) == PDP8_OK);
+
+  static char bytes[8 + INSTRUCTIONS * sizeof(struct PDP8_TraceRecord) + 1];
+  FILE *file = fopen(file_name, "rb");
+  size_t length = file ? fread(bytes, 1, sizeof(bytes), file) : 0;
+  if (file) fclose(file);
+  unlink(file_name);
+  CHECK(length == sizeof(bytes) - 1);
+  CHECK(!memcmp(bytes, "PDP8TRC1", 8));
+  CHECK(!memcmp(bytes + 8, expected, INSTRUCTIONS * sizeof(struct PDP8_TraceRecord)));
+}
+
+// An interrupt taken after an instruction leaves MA at 0, but its record
+// keeps the address it referenced, here through an auto-index register.
+static void check_interrupt(void) {
+  static struct collected collected;
+  collected.slow = false;
+  collected.status = PDP8_OK;
+  collected.count = 0;
+  struct PDP8_TraceSink sink = { &collected, collect_write, collect_close };
+
+  static const uint code[] = { 06001, 01410, 07402 };   // ION, TAD I 10
+  static struct PDP8 pdp8;
+  PDP8_Reset(&pdp8);
+  PDP8_MemoryReset(&pdp8);
+  memcpy(&pdp8.memory[00200], code, sizeof(code));
+  pdp8.memory[00010] = 00277;
+  pdp8.memory[00300] = 042;
+  pdp8.pc = 00200;
+  pdp8.run = true;
+  pdp8.interrupt_request = true;
+
+  struct PDP8_Trace trace;
+  CHECK(PDP8_TraceOpen(&trace, 4, sink) == PDP8_OK);
+  PDP8_TraceRun(&trace, &pdp8, 2, NULL);
+  CHECK(PDP8_TraceClose(&trace) == PDP8_OK);
+  CHECK(pdp8.pc == 00001 && pdp8.ma == 0 && pdp8.ac == 042);
+  CHECK(collected.count == 2 && collected.records[0].ea == 0);
+  CHECK(collected.records[1].ir == 01410 && collected.records[1].ea == 00300);
+}
+
+int main(void) {
+  struct PDP8_Image image;
+  struct PDP8_AssemblerError error;
+  CHECK(PDP8_Assemble(&image, NULL, source, strlen(source), &error) == PDP8_OK);
+
+  static struct PDP8_TraceRecord expected[INSTRUCTIONS];
+  expect(&image, expected);
+  check_ring(&image, expected);
+  check_error(&image);
+  check_file(&image, expected);
+  check_interrupt();
+
+  PDP8_ImageFree(&image);
+  return check_result("trace");
+}
@@ -0,0 +1,168 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "pdp8.h"
+#include "loader.h"
+#include "assembler.h"
+#include "trace.h"
+#include "tracefile.h"
+#include "tracediff.h"
+#include "check.h"
+
+// The faulty engine's cycle, and the traced instruction whose AC is
+// flipped: past two trace chunks, so whole chunks can be skipped.
+#define FAULT_CYCLE  150000
+#define FAULT        150000
+#define INSTRUCTIONS 200000
+
+// A loop that never halts and keeps its running sum in AC.
+static const char source[] =
+  "*20\n"
+  "PTR,    0\n"
+  "*200\n"
+  "START,  TAD I PTR\n"
+  "        RAL\n"
+  "        ISZ PTR\n"
+  "        JMP START\n"
+  "$START\n";
+
+// Steps like the reference, but flips a bit of memory in the instruction
+// that passes FAULT_CYCLE; a flipped AC could wash out of the running sum.
+// It keys on the machine's own state, as the binary search re-executes
+// from checkpoints.
+static bool faulty_step(struct PDP8 *pdp8, void *context) {
+  uint64_t cycles = pdp8->cycles;
+  bool run = PDP8_Step(pdp8);
+  if (cycles < FAULT_CYCLE && pdp8->cycles >= FAULT_CYCLE) pdp8->memory[07000] ^= 1;
+  return run;
+}
+
+static void start(struct PDP8 *pdp8, const struct PDP8_Image *image) {
+  PDP8_Reset(pdp8);
+  PDP8_MemoryReset(pdp8);
+  PDP8_LoadImage(pdp8, image);
+  PDP8_StartImage(pdp8, image);
+}
+
+// The binary search lands on the faulty instruction whatever the interval.
+static void check_divergence(const struct PDP8_Image *image) {
+  static const uint64_t intervals[] = { 1, 1000, 65536 };
+  static struct PDP8 a, b, expected;
+  static struct PDP8_Divergence divergence;
+
+  // the reference machine up to the faulty instruction
+  uint64_t instruction = 0;
+  start(&expected, image);
+  for (;;) {
+    static struct PDP8 next;
+    next = expected;
+    PDP8_Step(&next);
+    if (next.cycles >= FAULT_CYCLE) break;
+    expected = next;
+    instruction++;
+  }
+
+  for (uint i = 0; i < 3; ++i) {
+    start(&a, image);
+    start(&b, image);
+    CHECK(PDP8_FindDivergence(&a, PDP8_ReferenceStep, NULL, &b, faulty_step, NULL,
+                              INSTRUCTIONS, intervals[i], &divergence) == PDP8_OK);
+    CHECK(divergence.found && divergence.instruction == instruction);
+    CHECK(PDP8_StateHash(&divergence.before) == PDP8_StateHash(&expected));
+    CHECK(divergence.a.memory[07000] == (divergence.b.memory[07000] ^ 1));
+    divergence.b.memory[07000] ^= 1;
+    CHECK(PDP8_StateHash(&divergence.a) == PDP8_StateHash(&divergence.b));
+  }
+
+  // the same engine on both sides never diverges, and a halt ends the search
+  start(&a, image);
+  start(&b, image);
+  CHECK(PDP8_FindDivergence(&a, PDP8_ReferenceStep, NULL, &b, PDP8_ReferenceStep, NULL,
+                            10000, 1000, &divergence) == PDP8_OK);
+  CHECK(!divergence.found);
+  a.run = b.run = false;
+  CHECK(PDP8_FindDivergence(&a, PDP8_ReferenceStep, NULL, &b, PDP8_ReferenceStep, NULL,
+                            10000, 1000, &divergence) == PDP8_OK);
+  CHECK(!divergence.found);
+
+  // machines that differ from the start diverge before the first instruction
+  start(&a, image);
+  start(&b, image);
+  b.switches = 1;
+  CHECK(PDP8_FindDivergence(&a, PDP8_ReferenceStep, NULL, &b, PDP8_ReferenceStep, NULL,
+                            10000, 1000, &divergence) == PDP8_OK);
+  CHECK(divergence.found && divergence.instruction == 0);
+}
+
+// Traces count instructions, flipping AC after instruction fault unless
+// it is past the end.
+static void trace(const struct PDP8_Image *image, const char *file_name, bool compressed,
+                  uint64_t fault, uint64_t count) {
+  static struct PDP8 pdp8;
+  start(&pdp8, image);
+  struct PDP8_Trace trace;
+  CHECK((compressed ? PDP8_TraceOpenCompressed(&trace, file_name) : PDP8_TraceOpenFile(&trace, file_name)) == PDP8_OK);
+  if (fault < count) {
+    PDP8_TraceRun(&trace, &pdp8, fault + 1, NULL);
+    pdp8.ac ^= 1;
+    PDP8_TraceRun(&trace, &pdp8, count - fault - 1, NULL);
+  } else {
+    PDP8_TraceRun(&trace, &pdp8, count, NULL);
+  }
+  CHECK(PDP8_TraceClose(&trace) == PDP8_OK);
+}
+
+static void temporary(char *file_name) {
+  strcpy(file_name, "/tmp/pdp8-tracediff-XXXXXX");
+  int fd = mkstemp(file_name);
+  CHECK(fd >= 0);
+  close(fd);
+}
+
+static void check_traces(const struct PDP8_Image *image) {
+  char a[64], b[64], raw[64];
+  temporary(a);
+  temporary(b);
+  temporary(raw);
+  trace(image, a, true, INSTRUCTIONS, INSTRUCTIONS);
+  trace(image, raw, false, INSTRUCTIONS, INSTRUCTIONS);
+  trace(image, b, true, FAULT, INSTRUCTIONS);
+
+  // the flipped AC shows in the next instruction's record; the equal
+  // chunks before it are skipped by their hashes
+  struct PDP8_TraceDivergence divergence;
+  CHECK(PDP8_TraceDiff(a, b, &divergence) == PDP8_OK);
+  CHECK(divergence.found && divergence.record == FAULT + 1);
+  CHECK(divergence.a_valid && divergence.b_valid);
+  CHECK(divergence.a.pc == divergence.b.pc && divergence.a.lac != divergence.b.lac);
+  CHECK(divergence.chunks_skipped == FAULT / PDP8_TRACE_CHUNK_RECORDS);
+
+  // raw and compressed traces of one run are equal
+  CHECK(PDP8_TraceDiff(a, raw, &divergence) == PDP8_OK);
+  CHECK(!divergence.found);
+
+  // a trace that stops early differs where it ends
+  trace(image, b, true, INSTRUCTIONS, 1000);
+  CHECK(PDP8_TraceDiff(a, b, &divergence) == PDP8_OK);
+  CHECK(divergence.found && divergence.record == 1000);
+  CHECK(divergence.a_valid && !divergence.b_valid);
+
+  CHECK(PDP8_TraceDiff(a, "/nonexistent/trace", &divergence) == PDP8_ERROR_OPEN);
+  unlink(a);
+  unlink(b);
+  unlink(raw);
+}
+
+int main(void) {
+  struct PDP8_Image image;
+  struct PDP8_AssemblerError error;
+  CHECK(PDP8_Assemble(&image, NULL, source, strlen(source), &error) == PDP8_OK);
+
+  check_divergence(&image);
+  check_traces(&image);
+
+  PDP8_ImageFree(&image);
+  return check_result("tracediff");
+}
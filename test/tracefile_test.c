@@ -0,0 +1,131 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "pdp8.h"
+#include "loader.h"
+#include "trace.h"
+#include "tracefile.h"
+#include "assembler.h"
+#include "check.h"
+
+// Sums and shifts a table in a loop that never halts, so the records
+// vary from one pass to the next.
+static const char source[] =
+  "*20\n"
+  "PTR,    0\n"
+  "SUM,    0\n"
+  "*200\n"
+  "START,  TAD I PTR\n"
+  "        TAD SUM\n"
+  "        RAL\n"
+  "        DCA SUM\n"
+  "        ISZ PTR\n"
+  "        JMS SUB\n"
+  "        JMP START\n"
+  "SUB,    0\n"
+  "        TAD SUM\n"
+  "        SZA CLA\n"
+  "        JMP I SUB\n"
+  "        JMP I SUB\n"
+  "$START\n";
+
+// More than two chunks, so the last one is partial.
+#define INSTRUCTIONS (2 * PDP8_TRACE_CHUNK_RECORDS + 12345)
+
+// Collects the records in memory, as the ring hands them over.
+struct collected {
+  struct PDP8_TraceRecord *records;
+  size_t count;
+};
+
+static int collect_write(void *context, const struct PDP8_TraceRecord *records, size_t count) {
+  struct collected *collected = (struct collected *)context;
+  if (collected->count + count > INSTRUCTIONS) return PDP8_ERROR_WRITE;
+  memcpy(&collected->records[collected->count], records, count * sizeof(*records));
+  collected->count += count;
+  return PDP8_OK;
+}
+
+static int collect_close(void *context) {
+  (void)context;
+  return PDP8_OK;
+}
+
+// Traces INSTRUCTIONS instructions from the start; every run is the same,
+// so each trace gets the same records.
+static void run(struct PDP8_Trace *trace, const struct PDP8_Image *image) {
+  static struct PDP8 pdp8;
+  PDP8_Reset(&pdp8);
+  PDP8_MemoryReset(&pdp8);
+  PDP8_LoadImage(&pdp8, image);
+  PDP8_StartImage(&pdp8, image);
+  uint64_t executed;
+  CHECK(PDP8_TraceRun(trace, &pdp8, INSTRUCTIONS, &executed) == PDP8_STOP_BUDGET);
+  CHECK(executed == INSTRUCTIONS);
+  CHECK(PDP8_TraceClose(trace) == PDP8_OK);
+}
+
+static void check_file(const char *file_name, const struct collected *expected, bool compressed) {
+  struct PDP8_TraceReader reader;
+  CHECK(PDP8_TraceReaderOpen(&reader, file_name) == PDP8_OK);
+  CHECK(reader.compressed == compressed);
+  CHECK(reader.record_count == INSTRUCTIONS);
+
+  // all of it, in reads that straddle the chunks
+  struct PDP8_TraceRecord *records = (struct PDP8_TraceRecord *)malloc(INSTRUCTIONS * sizeof(*records));
+  size_t total = 0, count;
+  do {
+    CHECK(PDP8_TraceReaderRead(&reader, &records[total], 40000, &count) == PDP8_OK);
+    total += count;
+  } while (count && total < INSTRUCTIONS);
+  CHECK(total == INSTRUCTIONS);
+  CHECK(!memcmp(records, expected->records, INSTRUCTIONS * sizeof(*records)));
+
+  // back into the middle of the first chunk, then across into the second
+  uint64_t position = PDP8_TRACE_CHUNK_RECORDS - 10;
+  CHECK(PDP8_TraceReaderSeek(&reader, position) == PDP8_OK);
+  CHECK(PDP8_TraceReaderRead(&reader, records, 20, &count) == PDP8_OK && count == 20);
+  CHECK(!memcmp(records, &expected->records[position], 20 * sizeof(*records)));
+
+  // the end reads nothing and seeking past it fails
+  CHECK(PDP8_TraceReaderSeek(&reader, INSTRUCTIONS) == PDP8_OK);
+  CHECK(PDP8_TraceReaderRead(&reader, records, 20, &count) == PDP8_OK && count == 0);
+  CHECK(PDP8_TraceReaderSeek(&reader, INSTRUCTIONS + 1) == PDP8_ERROR_FORMAT);
+
+  free(records);
+  PDP8_TraceReaderClose(&reader);
+}
+
+int main(void) {
+  struct PDP8_Image image;
+  struct PDP8_AssemblerError error;
+  CHECK(PDP8_Assemble(&image, NULL, source, strlen(source), &error) == PDP8_OK);
+
+  struct collected expected = { (struct PDP8_TraceRecord *)malloc(INSTRUCTIONS * sizeof(struct PDP8_TraceRecord)), 0 };
+  struct PDP8_TraceSink sink = { &expected, collect_write, collect_close };
+  struct PDP8_Trace trace;
+  CHECK(PDP8_TraceOpen(&trace, 12, sink) == PDP8_OK);
+  run(&trace, &image);
+  CHECK(expected.count == INSTRUCTIONS);
+  CHECK(expected.records[0].pc == image.start);
+
+  char file_name[] = "/tmp/pdp8-trace-XXXXXX";
+  int fd = mkstemp(file_name);
+  CHECK(fd >= 0);
+  close(fd);
+
+  CHECK(PDP8_TraceOpenCompressed(&trace, file_name) == PDP8_OK);
+  run(&trace, &image);
+  check_file(file_name, &expected, true);
+
+  CHECK(PDP8_TraceOpenFile(&trace, file_name) == PDP8_OK);
+  run(&trace, &image);
+  check_file(file_name, &expected, false);
+
+  unlink(file_name);
+  free(expected.records);
+  PDP8_ImageFree(&image);
+  return check_result("tracefile");
+}
@@ -0,0 +1,132 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pdp8.h"
+#include "breakpoint.h"
+#include "watchpoint.h"
+#include "check.h"
+
+static struct PDP8 pdp8;
+static struct PDP8_Watchpoints watchpoints;
+
+static void start(void) {
+  PDP8_Reset(&pdp8);
+  PDP8_MemoryReset(&pdp8);
+  pdp8.pc = 00200;
+  pdp8.run = true;
+}
+
+// Runs the words from 0200 until a watchpoint, a halt or the budget.
+static int run(const uint *code, uint length, uint64_t *executed) {
+  start();
+  memcpy(&pdp8.memory[00200], code, length * sizeof(uint));
+  PDP8_WatchpointsAttach(&pdp8, &watchpoints);
+  uint hit;
+  return PDP8_BreakpointRun(&pdp8, NULL, 1000, false, executed, &hit);
+}
+
+// Only pages holding a watchpoint have their bit, and the bits follow
+// the table when it is attached again.
+static void check_pages(void) {
+  PDP8_WatchpointsInit(&watchpoints);
+  PDP8_WatchpointSet(&watchpoints, 00300, PDP8_WATCH_WRITE);
+  PDP8_WatchpointSet(&watchpoints, 00000, PDP8_WATCH_READ);
+  PDP8_WatchpointSet(&watchpoints, 07777, PDP8_WATCH_ACCESS);
+  PDP8_WatchpointSet(&watchpoints, 07777, PDP8_WATCH_READ);
+  CHECK(watchpoints.count == 3);
+
+  start();
+  PDP8_WatchpointsAttach(&pdp8, &watchpoints);
+  CHECK(pdp8.watchpoints == &watchpoints);
+  CHECK(pdp8.watch_pages == ((1u << 1) | (1u << 0) | (1u << 31)));
+
+  PDP8_WatchpointClear(&watchpoints, 07777, PDP8_WATCH_READ);
+  CHECK(watchpoints.watch[07777] == PDP8_WATCH_WRITE && watchpoints.count == 3);
+  PDP8_WatchpointClear(&watchpoints, 07777, PDP8_WATCH_ACCESS);
+  PDP8_WatchpointClear(&watchpoints, 00000, PDP8_WATCH_READ);
+  CHECK(watchpoints.count == 1);
+  PDP8_WatchpointsAttach(&pdp8, &watchpoints);
+  CHECK(pdp8.watch_pages == (1u << 1));
+
+  PDP8_Reset(&pdp8);
+  CHECK(pdp8.watchpoints == NULL && pdp8.watch_pages == 0);
+}
+
+// Neighbours on a watched page and words on other pages run through
+// without a hit; the watched word stops the run after the instruction
+// that wrote it, with what it held and what was written.
+static void check_hits(void) {
+  PDP8_WatchpointsInit(&watchpoints);
+  PDP8_WatchpointSet(&watchpoints, 00300, PDP8_WATCH_WRITE);
+
+  static const uint code[] = {
+    07001,                             // IAC
+    03301,                             // DCA 0301, same page, not watched
+    01300,                             // TAD 0300, read only
+    03500,                             // DCA 0500, another page
+    07001,                             // IAC
+    03300,                             // DCA 0300
+    07402,
+  };
+  uint64_t executed;
+  CHECK(run(code, 7, &executed) == PDP8_STOP_WATCHPOINT);
+  CHECK(executed == 6 && pdp8.pc == 00206);
+  CHECK(watchpoints.hit && watchpoints.hits == 1);
+  CHECK(watchpoints.address == 00300 && watchpoints.access == PDP8_WATCH_WRITE);
+  CHECK(watchpoints.old_value == 0 && watchpoints.value == 1 && watchpoints.pc == 00205);
+  CHECK(pdp8.memory[00301] == 1 && pdp8.memory[00300] == 1);
+
+  // the same program with the word unwatched runs to its HLT
+  PDP8_WatchpointClear(&watchpoints, 00300, PDP8_WATCH_WRITE);
+  CHECK(run(code, 7, &executed) == PDP8_STOP_HALT);
+  CHECK(executed == 7 && !watchpoints.hit);
+}
+
+// Reads, indirect pointers, auto-index increments and the interrupt's
+// store of PC are all watched; only the first hit is kept, all counted.
+static void check_accesses(void) {
+  uint64_t executed;
+  PDP8_WatchpointsInit(&watchpoints);
+  PDP8_WatchpointSet(&watchpoints, 00010, PDP8_WATCH_ACCESS);
+  static const uint through[] = { 07000, 01410, 07402 };   // NOP, TAD I 10
+  start();
+  pdp8.memory[00010] = 00277;
+  pdp8.memory[00300] = 042;
+  memcpy(&pdp8.memory[00200], through, sizeof(through));
+  PDP8_WatchpointsAttach(&pdp8, &watchpoints);
+  uint hit;
+  CHECK(PDP8_BreakpointRun(&pdp8, NULL, 1000, false, &executed, &hit) == PDP8_STOP_WATCHPOINT);
+  CHECK(executed == 2 && pdp8.ac == 042);
+  CHECK(watchpoints.hits == 2 && watchpoints.access == PDP8_WATCH_READ);
+  CHECK(watchpoints.old_value == 00277 && watchpoints.value == 00277);
+
+  // a read watchpoint ignores the write of DCA
+  PDP8_WatchpointsInit(&watchpoints);
+  PDP8_WatchpointSet(&watchpoints, 00300, PDP8_WATCH_READ);
+  static const uint store[] = { 03300, 07402 };
+  CHECK(run(store, 2, &executed) == PDP8_STOP_HALT && watchpoints.hits == 0);
+
+  // the interrupt writes PC to 0000
+  PDP8_WatchpointsInit(&watchpoints);
+  PDP8_WatchpointSet(&watchpoints, 00000, PDP8_WATCH_WRITE);
+  static const uint interrupt[] = { 06001, 07000, 07000 };
+  start();
+  memcpy(&pdp8.memory[00200], interrupt, sizeof(interrupt));
+  pdp8.interrupt_request = true;
+  PDP8_WatchpointsAttach(&pdp8, &watchpoints);
+  CHECK(PDP8_BreakpointRun(&pdp8, NULL, 1000, false, &executed, &hit) == PDP8_STOP_WATCHPOINT);
+  CHECK(executed == 2 && pdp8.pc == 00001 && watchpoints.value == 00202);
+
+  // data breaks go through PDP8_MemoryWrite
+  watchpoints.hit = false;
+  PDP8_MemoryWrite(&pdp8, 00000, 01234);
+  CHECK(watchpoints.hit && watchpoints.value == 01234 && watchpoints.old_value == 00202);
+}
+
+int main(void) {
+  check_pages();
+  check_hits();
+  check_accesses();
+  return check_result("watchpoint");
+}